@@ -72,18 +72,18 @@ void log_gl_parameters() {
     if (pair.first == GL_MAX_VIEWPORT_DIMS) {
       int v[2] = {0, 0};
       glGetIntegerv(pair.first, v);
-      g_log << pair.second << " == " << std::to_string(v[0]).c_str() << ", " << std::to_string(v[1]).c_str() << "\n";
+      g_log << pair.second << " == " << v[0] << ", " << v[1] << "\n";
       continue;
     }
     if (pair.first == GL_STEREO) {
       unsigned char v = 0;
       glGetBooleanv(pair.first, &v);
-      g_log << pair.second << " == " << std::to_string(v).c_str() << "\n";
+      g_log << pair.second << " == " << v << "\n";
       continue;
     }
     int v = 0;
     glGetIntegerv(pair.first, &v);
-    g_log << pair.second << " == " << std::to_string(v).c_str() << "\n";
+    g_log << pair.second << " == " << v << "\n";
   }
   g_log << "----------------------------------------\n";
 }
@@ -193,12 +193,12 @@ int main (int argc, char* argv[]) {
   shader_program.bind_attribute_location(1, "vertex_color");
 
   if (!shader_program.link()) {
-    g_log << common::logger::message_type::error << "could not link shader program GL index " << std::to_string(shader_program.id()) << "\n";
+    g_log << common::logger::message_type::error << "could not link shader program GL index " << shader_program.id() << "\n";
     shader_program.dump_info_log(g_log);
   } else {
     shader_program.dump_details(g_log);
     bool is_valid = shader_program.validate();
-    g_log << "program " << std::to_string(shader_program.id()) << " GL_VALIDATE_STATUS = " << std::to_string(is_valid) << "\n";
+    g_log << "program " << shader_program.id() << " GL_VALIDATE_STATUS = " << is_valid << "\n";
     if (!is_valid) {
         shader_program.dump_info_log(g_log);
     }
@@ -231,7 +231,7 @@ int main (int argc, char* argv[]) {
 
     // update matrix
     last_position += elapsed_seconds * speed;
-    auto matrix = math::rotate_z(last_position)
+    math::mat4f matrix = math::rotate_z(last_position)
                 * math::rotate_x(last_position)
                 * math::translate(vector::vec3({last_position, 0, 0}))
                 * math::scale(vector::vec3({last_position, last_position, 1}));
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace math {
+
+static constexpr size_t cache_line_size = 64;
+
+// std::allocator replacement for over-aligned element arrays
+template <typename type, size_t alignment = cache_line_size>
+struct aligned_allocator {
+    using value_type = type;
+
+    template <typename other_type>
+    struct rebind {
+        using other = aligned_allocator<other_type, alignment>;
+    };
+
+    aligned_allocator() = default;
+
+    template <typename other_type>
+    constexpr aligned_allocator(const aligned_allocator<other_type, alignment>&) {}
+
+    type* allocate(const size_t count) {
+        return static_cast<type*>(::operator new(count * sizeof(type), std::align_val_t(alignment)));
+    }
+
+    void deallocate(type* pointer, const size_t) {
+        ::operator delete(pointer, std::align_val_t(alignment));
+    }
+
+    template <typename other_type>
+    constexpr bool operator==(const aligned_allocator<other_type, alignment>&) const {
+        return true;
+    }
+
+    template <typename other_type>
+    constexpr bool operator!=(const aligned_allocator<other_type, alignment>&) const {
+        return false;
+    }
+};
+
+template <typename type, size_t alignment = cache_line_size>
+using aligned_vector = std::vector<type, aligned_allocator<type, alignment>>;
+
+// hands out aligned arrays carved from large blocks; nothing is freed individually,
+// reset() recycles all blocks at once, e.g. per frame or after a mesh is loaded
+template <typename type, size_t alignment = cache_line_size>
+class aligned_arena {
+    static_assert(std::is_trivially_destructible<type>::value, "arena never runs destructors");
+    static_assert(alignment >= alignof(type) && !(alignment & (alignment - 1)), "alignment must be a power of two not below alignof(type)");
+
+public:
+    explicit aligned_arena(const size_t block_elements = 1024):
+        m_block_bytes(block_elements * sizeof(type)), m_block(0), m_offset(0) {}
+
+    aligned_arena(const aligned_arena&) = delete;
+    aligned_arena& operator=(const aligned_arena&) = delete;
+
+    ~aligned_arena() {
+        for (auto& block : m_blocks) {
+            ::operator delete(block.data, std::align_val_t(alignment));
+        }
+    }
+
+    // count value initialized elements starting on an alignment boundary
+    type* allocate(const size_t count) {
+        const size_t bytes = count * sizeof(type);
+        size_t offset = (m_offset + alignment - 1) & ~(alignment - 1);
+        while (m_block < m_blocks.size() && offset + bytes > m_blocks[m_block].size) {
+            m_block++;
+            offset = 0;
+        }
+        if (m_block == m_blocks.size()) {
+            const size_t size = bytes > m_block_bytes ? bytes : m_block_bytes;
+            m_blocks.push_back({static_cast<unsigned char*>(::operator new(size, std::align_val_t(alignment))), size});
+            offset = 0;
+        }
+
+        type* result = reinterpret_cast<type*>(m_blocks[m_block].data + offset);
+        for (size_t i = 0; i < count; i++) {
+            new (result + i) type();
+        }
+        m_offset = offset + bytes;
+        return result;
+    }
+
+    // invalidates every array handed out so far, keeps the memory
+    void reset() {
+        m_block = 0;
+        m_offset = 0;
+    }
+
+    size_t capacity() const {
+        size_t result = 0;
+        for (const auto& block : m_blocks) {
+            result += block.size;
+        }
+        return result;
+    }
+
+private:
+
+    struct block {
+        unsigned char* data;
+        size_t         size;
+    };
+
+    size_t             m_block_bytes;
+    std::vector<block> m_blocks;
+    size_t             m_block;
+    size_t             m_offset;
+};
+
+} // ns math
@@ -0,0 +1,226 @@
+#pragma once
+
+#include "simd.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "vector.hpp"
+
+// transforms of whole vertex arrays by mat4f. Points are row vectors as in
+// vector * matrix, i.e. the result matches what the shaders compute for the same
+// matrix uploaded with GL_FALSE. Outputs may alias inputs. A threads argument
+// above 1 splits large batches into contiguous chunks, run as jobs of the shared
+// job system.
+
+namespace math {
+
+// structure of arrays input and output, each pointer addresses count floats
+struct const_soa_points {
+    const float* x;
+    const float* y;
+    const float* z;
+};
+
+struct soa_points {
+    float* x;
+    float* y;
+    float* z;
+};
+
+namespace detail {
+
+inline void transform_point(const float* m, const float x, const float y, const float z, float* out) {
+    out[0] = (x * m[0] + y * m[4]) + (z * m[8] + m[12]);
+    out[1] = (x * m[1] + y * m[5]) + (z * m[9] + m[13]);
+    out[2] = (x * m[2] + y * m[6]) + (z * m[10] + m[14]);
+}
+
+#if defined(MATH_SIMD_SSE)
+// upper 3x4 block of the matrix broadcast into registers, transforms four points
+// held as x, y and z registers
+struct point_lanes {
+    __m128 m[12];
+
+    explicit point_lanes(const float* matrix) {
+        for (size_t i = 0; i < 12; i++) {
+            m[i] = _mm_set1_ps(matrix[i < 9 ? (i / 3) * 4 + i % 3 : 12 + i - 9]);
+        }
+    }
+
+    void transform(__m128& x, __m128& y, __m128& z) const {
+        const __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[0]), _mm_mul_ps(y, m[3])), _mm_add_ps(_mm_mul_ps(z, m[6]), m[9]));
+        const __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[1]), _mm_mul_ps(y, m[4])), _mm_add_ps(_mm_mul_ps(z, m[7]), m[10]));
+        const __m128 tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m[2]), _mm_mul_ps(y, m[5])), _mm_add_ps(_mm_mul_ps(z, m[8]), m[11]));
+        x = tx;
+        y = ty;
+        z = tz;
+    }
+};
+
+// x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3 into x, y and z registers and back
+inline void deinterleave(const float* in, __m128& x, __m128& y, __m128& z) {
+    const __m128 a = _mm_loadu_ps(in);
+    const __m128 b = _mm_loadu_ps(in + 4);
+    const __m128 c = _mm_loadu_ps(in + 8);
+    x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 2, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 1, 0, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+inline void interleave(const __m128 x, const __m128 y, const __m128 z, float* out) {
+    const __m128 xy_low = _mm_unpacklo_ps(x, y);
+    const __m128 xy_high = _mm_unpackhi_ps(x, y);
+    const __m128 a = _mm_shuffle_ps(xy_low, _mm_shuffle_ps(z, xy_low, _MM_SHUFFLE(0, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+    const __m128 b = _mm_shuffle_ps(_mm_shuffle_ps(xy_low, z, _MM_SHUFFLE(0, 1, 0, 3)), xy_high, _MM_SHUFFLE(1, 0, 2, 0));
+    const __m128 c = _mm_shuffle_ps(_mm_shuffle_ps(z, xy_high, _MM_SHUFFLE(0, 2, 0, 2)), _mm_shuffle_ps(xy_high, z, _MM_SHUFFLE(0, 3, 0, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    _mm_storeu_ps(out, a);
+    _mm_storeu_ps(out + 4, b);
+    _mm_storeu_ps(out + 8, c);
+}
+
+// rows of the matrix in registers, transforms one padded vector per call
+struct row_lanes {
+    __m128 rows[4];
+
+    explicit row_lanes(const float* matrix) {
+        for (size_t row = 0; row < 4; row++) {
+            rows[row] = _mm_loadu_ps(matrix + row * 4);
+        }
+    }
+
+    __m128 transform(const __m128 value, const __m128 w) const {
+        const __m128 xy = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(value, value, 0x00), rows[0]),
+                                     _mm_mul_ps(_mm_shuffle_ps(value, value, 0x55), rows[1]));
+        const __m128 zw = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(value, value, 0xaa), rows[2]),
+                                     _mm_mul_ps(w, rows[3]));
+        return _mm_add_ps(xy, zw);
+    }
+};
+#endif
+
+} // ns detail
+
+// count points packed as x, y, z floats, the layout of GL vertex arrays
+inline void transform_points(const mat4f& matrix, const float* in, float* out, const size_t count, const size_t threads = 1) {
+    const float* m = matrix.container().raw();
+    detail::split(count, threads, [=](const size_t begin, const size_t end) {
+        size_t i = begin;
+#if defined(MATH_SIMD_SSE)
+        const detail::point_lanes lanes(m);
+        for (; i + 4 <= end; i += 4) {
+            __m128 x, y, z;
+            detail::deinterleave(in + i * 3, x, y, z);
+            lanes.transform(x, y, z);
+            detail::interleave(x, y, z, out + i * 3);
+        }
+#endif
+        for (; i < end; i++) {
+            detail::transform_point(m, in[i * 3], in[i * 3 + 1], in[i * 3 + 2], out + i * 3);
+        }
+    });
+}
+
+inline void transform_points(const mat4f& matrix, const const_soa_points& in, const soa_points& out, const size_t count, const size_t threads = 1) {
+    const float* m = matrix.container().raw();
+    detail::split(count, threads, [=](const size_t begin, const size_t end) {
+        size_t i = begin;
+#if defined(MATH_SIMD_AVX)
+        __m256 lanes[12];
+        for (size_t index = 0; index < 12; index++) {
+            lanes[index] = _mm256_set1_ps(m[index < 9 ? (index / 3) * 4 + index % 3 : 12 + index - 9]);
+        }
+        for (; i + 8 <= end; i += 8) {
+            const __m256 x = _mm256_loadu_ps(in.x + i);
+            const __m256 y = _mm256_loadu_ps(in.y + i);
+            const __m256 z = _mm256_loadu_ps(in.z + i);
+            _mm256_storeu_ps(out.x + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, lanes[0]), _mm256_mul_ps(y, lanes[3])),
+                                                      _mm256_add_ps(_mm256_mul_ps(z, lanes[6]), lanes[9])));
+            _mm256_storeu_ps(out.y + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, lanes[1]), _mm256_mul_ps(y, lanes[4])),
+                                                      _mm256_add_ps(_mm256_mul_ps(z, lanes[7]), lanes[10])));
+            _mm256_storeu_ps(out.z + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, lanes[2]), _mm256_mul_ps(y, lanes[5])),
+                                                      _mm256_add_ps(_mm256_mul_ps(z, lanes[8]), lanes[11])));
+        }
+#endif
+#if defined(MATH_SIMD_SSE)
+        const detail::point_lanes lanes4(m);
+        for (; i + 4 <= end; i += 4) {
+            __m128 x = _mm_loadu_ps(in.x + i);
+            __m128 y = _mm_loadu_ps(in.y + i);
+            __m128 z = _mm_loadu_ps(in.z + i);
+            lanes4.transform(x, y, z);
+            _mm_storeu_ps(out.x + i, x);
+            _mm_storeu_ps(out.y + i, y);
+            _mm_storeu_ps(out.z + i, z);
+        }
+#endif
+        for (; i < end; i++) {
+            float result[3];
+            detail::transform_point(m, in.x[i], in.y[i], in.z[i], result);
+            out.x[i] = result[0];
+            out.y[i] = result[1];
+            out.z[i] = result[2];
+        }
+    });
+}
+
+// points with an implicit w == 1, the resulting w is dropped
+inline void transform_points(const mat4f& matrix, const vector::vec3* in, vector::vec3* out, const size_t count, const size_t threads = 1) {
+    const float* m = matrix.container().raw();
+    detail::split(count, threads, [=](const size_t begin, const size_t end) {
+#if defined(MATH_SIMD_SSE)
+        const detail::row_lanes lanes(m);
+        const __m128 one = _mm_set1_ps(1);
+        const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+        for (size_t i = begin; i < end; i++) {
+            const __m128 result = lanes.transform(_mm_load_ps(in[i].data().data()), one);
+            _mm_store_ps(out[i].m_data.data(), _mm_and_ps(result, xyz));
+        }
+#else
+        for (size_t i = begin; i < end; i++) {
+            vector::vec3 result;
+            detail::transform_point(m, in[i][0], in[i][1], in[i][2], result.m_data.data());
+            out[i] = result;
+        }
+#endif
+    });
+}
+
+// directions and normals with an implicit w == 0, translations do not apply
+inline void transform_directions(const mat4f& matrix, const vector::vec3* in, vector::vec3* out, const size_t count, const size_t threads = 1) {
+    mat4f linear = matrix;
+    float* m = linear.container().raw();
+    m[12] = m[13] = m[14] = 0;
+    transform_points(linear, in, out, count, threads);
+}
+
+inline void transform(const mat4f& matrix, const vector::vec4* in, vector::vec4* out, const size_t count, const size_t threads = 1) {
+    detail::split(count, threads, [&matrix, in, out](const size_t begin, const size_t end) {
+#if defined(MATH_SIMD_SSE)
+        const detail::row_lanes lanes(matrix.container().raw());
+        for (size_t i = begin; i < end; i++) {
+            const __m128 value = _mm_load_ps(in[i].data().data());
+            _mm_store_ps(out[i].m_data.data(), lanes.transform(value, _mm_shuffle_ps(value, value, 0xff)));
+        }
+#else
+        for (size_t i = begin; i < end; i++) {
+            out[i] = in[i] * matrix;
+        }
+#endif
+    });
+}
+
+// out[i] = in[i] * matrices[i]
+inline void transform(const mat4f* matrices, const vector::vec4* in, vector::vec4* out, const size_t count, const size_t threads = 1) {
+    detail::split(count, threads, [matrices, in, out](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; i++) {
+#if defined(MATH_SIMD_SSE)
+            const detail::row_lanes lanes(matrices[i].container().raw());
+            const __m128 value = _mm_load_ps(in[i].data().data());
+            _mm_store_ps(out[i].m_data.data(), lanes.transform(value, _mm_shuffle_ps(value, value, 0xff)));
+#else
+            out[i] = in[i] * matrices[i];
+#endif
+        }
+    });
+}
+
+} // ns math
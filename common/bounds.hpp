@@ -0,0 +1,86 @@
+#pragma once
+
+#include <limits>
+#include "vector.hpp"
+
+// bounding volumes and rays. Spheres take 16 and boxes 32 bytes, so arrays of
+// them load straight into SSE registers
+
+namespace math {
+
+// the radius takes the padding lane of the center
+struct alignas(16) sphere {
+    float x, y, z;
+    float radius;
+
+    sphere() = default;
+    sphere(const vector::vec3& center, const float radius):
+        x(center.data()[0]), y(center.data()[1]), z(center.data()[2]), radius(radius) {}
+
+    vector::vec3 center() const {
+        return vector::vec3({x, y, z});
+    }
+};
+
+struct aabb {
+    vector::vec3 min;
+    vector::vec3 max;
+
+    vector::vec3 center() const {
+        return (min + max) * .5f;
+    }
+
+    // half the size along each axis
+    vector::vec3 extent() const {
+        return (max - min) * .5f;
+    }
+
+    // inverted, so extending it by anything gives that thing's bounds
+    static aabb empty() {
+        const float infinity = std::numeric_limits<float>::infinity();
+        return {vector::vec3({infinity, infinity, infinity}), vector::vec3({-infinity, -infinity, -infinity})};
+    }
+
+    void extend(const aabb& other) {
+        min = vector::min(min, other.min);
+        max = vector::max(max, other.max);
+    }
+
+    void extend(const vector::vec3& point) {
+        min = vector::min(min, point);
+        max = vector::max(max, point);
+    }
+
+    // zero for empty boxes
+    float surface_area() const {
+        const vector::vec3 size = vector::max(max - min, vector::vec3({0, 0, 0}));
+        return 2 * (size[0] * size[1] + size[1] * size[2] + size[2] * size[0]);
+    }
+
+    bool intersects(const sphere& bounds) const {
+        const vector::vec3 center = bounds.center();
+        return vector::length_squared(vector::min(vector::max(center, min), max) - center) <= bounds.radius * bounds.radius;
+    }
+
+    bool operator==(const aabb& rhs) const {
+        return min == rhs.min && max == rhs.max;
+    }
+
+    bool operator!=(const aabb& rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+// direction need not be unit length, distances along the ray are in multiples of it
+struct ray {
+    vector::vec3 origin;
+    vector::vec3 direction;
+
+    vector::vec3 at(const float distance) const {
+        return origin + direction * distance;
+    }
+};
+
+static_assert(sizeof(sphere) == 16 && sizeof(aabb) == 32, "bounds must pack into SSE registers");
+
+} // ns math
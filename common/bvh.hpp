@@ -0,0 +1,518 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "aligned_arena.hpp"
+#include "bounds.hpp"
+#include "frustum.hpp"
+#include "vector.hpp"
+
+// bounding volume hierarchy over object boxes, built top down with binned surface
+// area heuristic splits. Moving objects refit the boxes along their path to the
+// root, which keeps the tree valid but slowly degrades it: rebuild once cost()
+// has grown noticeably. Queries report object indices as passed to build()
+
+namespace math {
+
+class bvh {
+
+public:
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    // leaves hold count objects from m_objects[first], inner nodes have count 0
+    // and their children at first and first + 1
+    struct node {
+        aabb     bounds;
+        uint32_t first;
+        uint32_t count;
+
+        bool leaf() const {
+            return count != 0;
+        }
+    };
+
+    static constexpr size_t bin_count = 16;
+    // smaller nodes always become leaves, larger ones only when splitting costs more
+    static constexpr size_t min_leaf_size = 4;
+    static constexpr size_t max_leaf_size = 8;
+    // splits below this depth fall back to object medians, bounding the traversal stack
+    static constexpr size_t max_sah_depth = 64;
+    static constexpr size_t stack_size = 128;
+
+    bvh() = default;
+
+    bvh(const aabb* bounds, const size_t count) {
+        build(bounds, count);
+    }
+
+    void build(const aabb* bounds, const size_t count) {
+        m_nodes.clear();
+        m_parent.clear();
+        m_bounds.assign(bounds, bounds + count);
+        m_objects.resize(count);
+        m_position.resize(count);
+        m_leaf.resize(count);
+        if (!count) {
+            return;
+        }
+        m_nodes.reserve(count);
+        m_parent.reserve(count);
+
+        // m_bounds and m_objects are partitioned in place, leaves end up as contiguous ranges
+        aabb root_bounds = aabb::empty(), root_centers = aabb::empty();
+        for (uint32_t object = 0; object < count; object++) {
+            m_objects[object] = object;
+            root_bounds.extend(bounds[object]);
+            root_centers.extend(center_of(bounds[object]));
+        }
+
+        std::vector<build_task> tasks{{0, 0, uint32_t(count), 0, root_centers}};
+        m_nodes.push_back({root_bounds, 0, 0});
+        m_parent.push_back(none);
+        while (!tasks.empty()) {
+            const build_task current = tasks.back();
+            tasks.pop_back();
+            build_task left{uint32_t(m_nodes.size()), current.begin, 0, current.depth + 1, aabb::empty()};
+            build_task right{left.node + 1, 0, current.end, current.depth + 1, aabb::empty()};
+            aabb left_bounds = aabb::empty(), right_bounds = aabb::empty();
+            if (!split(current, left_bounds, left.centers, right_bounds, right.centers, left.end)) {
+                continue;
+            }
+            right.begin = left.end;
+            m_nodes[current.node].first = left.node;
+            m_nodes.push_back({left_bounds, 0, 0});
+            m_nodes.push_back({right_bounds, 0, 0});
+            m_parent.push_back(current.node);
+            m_parent.push_back(current.node);
+            tasks.push_back(right);
+            tasks.push_back(left);
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            m_position[m_objects[i]] = i;
+        }
+    }
+
+    size_t size() const {
+        return m_bounds.size();
+    }
+
+    const aabb& bounds(const uint32_t object) const {
+        return m_bounds[m_position[object]];
+    }
+
+    const std::vector<node>& nodes() const {
+        return m_nodes;
+    }
+
+    // moves one object, enlarging or shrinking the boxes up to the first ancestor
+    // that stays the same
+    void update(const uint32_t object, const aabb& bounds) {
+        m_bounds[m_position[object]] = bounds;
+        for (uint32_t index = m_leaf[object]; index != none; index = m_parent[index]) {
+            node& current = m_nodes[index];
+            const aabb previous = current.bounds;
+            current.bounds = aabb::empty();
+            if (current.leaf()) {
+                for (uint32_t i = current.first; i < current.first + current.count; i++) {
+                    current.bounds.extend(m_bounds[i]);
+                }
+            } else {
+                current.bounds.extend(m_nodes[current.first].bounds);
+                current.bounds.extend(m_nodes[current.first + 1].bounds);
+            }
+            if (current.bounds == previous) {
+                break;
+            }
+        }
+    }
+
+    // new boxes for all objects, in build() order; cheaper than update() once most
+    // objects have moved
+    void refit(const aabb* bounds) {
+        for (size_t i = 0; i < m_bounds.size(); i++) {
+            m_bounds[i] = bounds[m_objects[i]];
+        }
+        // children always follow their parents
+        for (size_t index = m_nodes.size(); index--;) {
+            node& current = m_nodes[index];
+            current.bounds = aabb::empty();
+            if (current.leaf()) {
+                for (uint32_t i = current.first; i < current.first + current.count; i++) {
+                    current.bounds.extend(m_bounds[i]);
+                }
+            } else {
+                current.bounds.extend(m_nodes[current.first].bounds);
+                current.bounds.extend(m_nodes[current.first + 1].bounds);
+            }
+        }
+    }
+
+    // expected box tests of a random query relative to the root: inner nodes count
+    // their two children, leaves their objects
+    float cost() const {
+        if (m_nodes.empty()) {
+            return 0;
+        }
+        double sum = 0;
+        for (const node& current : m_nodes) {
+            sum += double(current.bounds.surface_area()) * (current.leaf() ? current.count : 2);
+        }
+        return float(sum / std::max(m_nodes[0].bounds.surface_area(), std::numeric_limits<float>::min()));
+    }
+
+    // appends the objects whose boxes intersect the frustum
+    void query(const frustum& view, std::vector<uint32_t>& result) const {
+        if (m_nodes.empty()) {
+            return;
+        }
+        uint32_t stack[stack_size];
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top) {
+            const node& current = m_nodes[stack[--top]];
+            if (!view.intersects(current.bounds)) {
+                continue;
+            }
+            if (current.leaf()) {
+                for (uint32_t i = current.first; i < current.first + current.count; i++) {
+                    if (view.intersects(m_bounds[i])) {
+                        result.push_back(m_objects[i]);
+                    }
+                }
+            } else if (view.contains(current.bounds)) {
+                append_subtree(current, result);
+            } else {
+                stack[top++] = current.first + 1;
+                stack[top++] = current.first;
+            }
+        }
+    }
+
+    // appends the objects whose boxes intersect the sphere
+    void query(const sphere& volume, std::vector<uint32_t>& result) const {
+        if (m_nodes.empty()) {
+            return;
+        }
+        uint32_t stack[stack_size];
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top) {
+            const node& current = m_nodes[stack[--top]];
+            if (!current.bounds.intersects(volume)) {
+                continue;
+            }
+            if (current.leaf()) {
+                for (uint32_t i = current.first; i < current.first + current.count; i++) {
+                    if (m_bounds[i].intersects(volume)) {
+                        result.push_back(m_objects[i]);
+                    }
+                }
+            } else {
+                stack[top++] = current.first + 1;
+                stack[top++] = current.first;
+            }
+        }
+    }
+
+    // nearest object along the ray within distance, or none. distance may be
+    // infinite. hit(object, entry) returns the exact distance for the object, e.g.
+    // from a triangle test, or infinity for a miss; entry is where the ray enters
+    // its box. distance is updated to the hit
+    template <typename hit_type>
+    uint32_t raycast(const ray& line, float& distance, const hit_type& hit) const {
+        if (m_nodes.empty()) {
+            return none;
+        }
+        const slab_ray slabs(line);
+        uint32_t result = none;
+        uint32_t stack[stack_size];
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top) {
+            const node& current = m_nodes[stack[--top]];
+            if (!(slabs.entry(current.bounds, distance) <= distance)) {
+                continue;
+            }
+            if (current.leaf()) {
+                for (uint32_t i = current.first; i < current.first + current.count; i++) {
+                    const float entry = slabs.entry(m_bounds[i], distance);
+                    if (entry <= distance) {
+                        const float exact = hit(m_objects[i], entry);
+                        if (exact <= distance && exact != std::numeric_limits<float>::infinity()) {
+                            distance = exact;
+                            result = m_objects[i];
+                        }
+                    }
+                }
+                continue;
+            }
+            // nearer child on top, so it shrinks distance before the other is tested.
+            // A missed child is NaN and compares false either way, it goes below
+            const float left = slabs.entry(m_nodes[current.first].bounds, distance);
+            const float right = slabs.entry(m_nodes[current.first + 1].bounds, distance);
+            const uint32_t near_child = !std::isnan(left) && !(right < left) ? current.first : current.first + 1;
+            stack[top++] = near_child == current.first ? current.first + 1 : current.first;
+            stack[top++] = near_child;
+        }
+        return result;
+    }
+
+    // boxes only: the hit is where the ray enters the object box
+    uint32_t raycast(const ray& line, float& distance) const {
+        return raycast(line, distance, [](const uint32_t, const float entry) {
+            return entry;
+        });
+    }
+
+private:
+
+    // reciprocal direction, axes the ray runs parallel to become infinite
+    struct slab_ray {
+        vector::vec3 origin;
+        vector::vec3 inverse;
+
+        explicit slab_ray(const ray& line):
+            origin(line.origin) {
+            for (size_t axis = 0; axis < 3; axis++) {
+                inverse.m_data[axis] = 1 / line.direction[axis];
+            }
+            inverse.m_data[3] = 0;
+        }
+
+        // distance along the ray where it enters the box, NaN if it misses the box
+        // within [0, limit]. Unlike infinity a miss then fails `<= limit` even
+        // for an infinite limit
+        float entry(const aabb& bounds, const float limit) const {
+            float near_distance = 0, far_distance = limit;
+            for (size_t axis = 0; axis < 3; axis++) {
+                float first = (bounds.min[axis] - origin[axis]) * inverse[axis];
+                float second = (bounds.max[axis] - origin[axis]) * inverse[axis];
+                if (first > second) {
+                    std::swap(first, second);
+                }
+                // NaN from 0 * infinity leaves the interval unchanged
+                near_distance = first > near_distance ? first : near_distance;
+                far_distance = second < far_distance ? second : far_distance;
+            }
+            return near_distance <= far_distance ? near_distance : std::numeric_limits<float>::quiet_NaN();
+        }
+    };
+
+    void append_subtree(const node& root, std::vector<uint32_t>& result) const {
+        uint32_t stack[stack_size];
+        size_t top = 0;
+        const node* current = &root;
+        while (true) {
+            if (current->leaf()) {
+                for (uint32_t i = current->first; i < current->first + current->count; i++) {
+                    result.push_back(m_objects[i]);
+                }
+                if (!top) {
+                    return;
+                }
+                current = &m_nodes[stack[--top]];
+            } else {
+                stack[top++] = current->first + 1;
+                current = &m_nodes[current->first];
+            }
+        }
+    }
+
+    struct build_task {
+        uint32_t node;
+        uint32_t begin;
+        uint32_t end;
+        uint32_t depth;
+        aabb     centers;
+    };
+
+    struct bin {
+        aabb     bounds;
+        uint32_t count;
+    };
+
+    // doubled, min + max orders the objects the same as their centers
+    static vector::vec3 center_of(const aabb& bounds) {
+        return bounds.min + bounds.max;
+    }
+
+    // surface_area() without the clamp, the sweeps only use it for filled boxes
+    static float sweep_area(const aabb& bounds) {
+        const vector::vec3 size = bounds.max - bounds.min;
+        return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+    }
+
+    // either makes the node a leaf and returns false, or partitions its objects at
+    // middle and returns the bounds of both halves and of their centers
+    bool split(const build_task& task, aabb& left_bounds, aabb& left_centers, aabb& right_bounds, aabb& right_centers, uint32_t& middle) {
+        const uint32_t count = task.end - task.begin;
+        if (count <= min_leaf_size) {
+            return make_leaf(task);
+        }
+
+        // all three axes binned in one pass over the objects, small nodes use fewer bins
+        const size_t bins_used = std::min<size_t>(bin_count, count);
+        const vector::vec3 center_size = task.centers.max - task.centers.min;
+        vector::vec3 scale;
+        bin bins[3][bin_count];
+        for (size_t axis = 0; axis < 3; axis++) {
+            scale[axis] = center_size[axis] > 0 ? bins_used / center_size[axis] : 0;
+            for (size_t index = 0; index < bins_used; index++) {
+                bins[axis][index] = {aabb::empty(), 0};
+            }
+        }
+        if (task.depth < max_sah_depth) {
+            for (uint32_t i = task.begin; i < task.end; i++) {
+                const aabb& bounds = m_bounds[i];
+                const vector::vec3 offset = (center_of(bounds) - task.centers.min) * scale;
+                for (size_t axis = 0; axis < 3; axis++) {
+                    bin& target = bins[axis][std::min(uint32_t(bins_used - 1), uint32_t(offset[axis]))];
+                    target.bounds.extend(bounds);
+                    target.count++;
+                }
+            }
+        }
+
+        // costs in half areas, like the leaf cost below
+        size_t best_axis = 3, best_bin = 0;
+        float best_cost = std::numeric_limits<float>::infinity();
+        for (size_t axis = 0; axis < 3 && task.depth < max_sah_depth; axis++) {
+            if (!scale[axis]) {
+                continue;
+            }
+            // right side costs swept from the top, left side from the bottom
+            float right_cost[bin_count];
+            aabb right = aabb::empty();
+            uint32_t right_count = 0;
+            for (size_t index = bins_used - 1; index > 0; index--) {
+                right.extend(bins[axis][index].bounds);
+                right_count += bins[axis][index].count;
+                right_cost[index] = right_count ? sweep_area(right) * right_count : 0;
+            }
+            aabb left = aabb::empty();
+            uint32_t left_count = 0;
+            for (size_t index = 0; index + 1 < bins_used; index++) {
+                left.extend(bins[axis][index].bounds);
+                left_count += bins[axis][index].count;
+                if (!left_count || left_count == count) {
+                    continue;
+                }
+                const float cost = sweep_area(left) * left_count + right_cost[index + 1];
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = index;
+                }
+            }
+        }
+
+        // a split costs two more box tests than testing every object of a leaf
+        const float area = sweep_area(m_nodes[task.node].bounds);
+        if (best_axis < 3 && (best_cost + 2 * area < area * count || count > max_leaf_size)) {
+            for (size_t index = 0; index < bins_used; index++) {
+                (index <= best_bin ? left_bounds : right_bounds).extend(bins[best_axis][index].bounds);
+            }
+            const float minimum = task.centers.min[best_axis];
+            const float axis_scale = scale[best_axis];
+            middle = partition(task.begin, task.end, [=](const vector::vec3& center) {
+                return bin_of(center[best_axis], minimum, axis_scale, bins_used) <= best_bin;
+            }, left_centers, right_centers);
+            return true;
+        }
+        if (count <= max_leaf_size) {
+            return make_leaf(task);
+        }
+
+        // coincident centers or too deep: halve at the object median of the longest
+        // axis, coincident centers may be halved in any order
+        size_t axis = 0;
+        for (size_t candidate = 1; candidate < 3; candidate++) {
+            if (center_size[candidate] > center_size[axis]) {
+                axis = candidate;
+            }
+        }
+        middle = task.begin + count / 2;
+        if (center_size[axis] > 0) {
+            median_order(task.begin, task.end, middle, axis);
+        }
+        for (uint32_t i = task.begin; i < task.end; i++) {
+            (i < middle ? left_bounds : right_bounds).extend(m_bounds[i]);
+            (i < middle ? left_centers : right_centers).extend(center_of(m_bounds[i]));
+        }
+        return true;
+    }
+
+    // moves the objects for which goes_left(center) holds to the front of
+    // [left, right) and returns where the others start
+    template <typename predicate_type>
+    uint32_t partition(uint32_t left, uint32_t right, const predicate_type& goes_left, aabb& left_centers, aabb& right_centers) {
+        while (true) {
+            for (; left < right; left++) {
+                const vector::vec3 center = center_of(m_bounds[left]);
+                if (!goes_left(center)) {
+                    break;
+                }
+                left_centers.extend(center);
+            }
+            for (; left < right; right--) {
+                const vector::vec3 center = center_of(m_bounds[right - 1]);
+                if (goes_left(center)) {
+                    break;
+                }
+                right_centers.extend(center);
+            }
+            if (left == right) {
+                return left;
+            }
+            std::swap(m_bounds[left], m_bounds[right - 1]);
+            std::swap(m_objects[left], m_objects[right - 1]);
+        }
+    }
+
+    // objects of [begin, end) ordered around the median along axis
+    void median_order(const uint32_t begin, const uint32_t end, const uint32_t middle, const size_t axis) {
+        std::vector<uint32_t> order(end - begin);
+        for (uint32_t i = 0; i < order.size(); i++) {
+            order[i] = begin + i;
+        }
+        std::nth_element(order.begin(), order.begin() + (middle - begin), order.end(), [this, axis](const uint32_t lhs, const uint32_t rhs) {
+            return center_of(m_bounds[lhs])[axis] < center_of(m_bounds[rhs])[axis];
+        });
+        aligned_vector<aabb> bounds(order.size());
+        std::vector<uint32_t> objects(order.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            bounds[i] = m_bounds[order[i]];
+            objects[i] = m_objects[order[i]];
+        }
+        std::copy(bounds.begin(), bounds.end(), m_bounds.begin() + begin);
+        std::copy(objects.begin(), objects.end(), m_objects.begin() + begin);
+    }
+
+    bool make_leaf(const build_task& task) {
+        m_nodes[task.node].first = task.begin;
+        m_nodes[task.node].count = task.end - task.begin;
+        for (uint32_t i = task.begin; i < task.end; i++) {
+            m_leaf[m_objects[i]] = task.node;
+        }
+        return false;
+    }
+
+    static size_t bin_of(const float center, const float minimum, const float scale, const size_t bins_used) {
+        return std::min(bins_used - 1, size_t((center - minimum) * scale));
+    }
+
+    std::vector<node>     m_nodes;
+    std::vector<uint32_t> m_parent;
+    // in leaf order
+    aligned_vector<aabb>  m_bounds;
+    std::vector<uint32_t> m_objects;
+    // per object
+    std::vector<uint32_t> m_position;
+    std::vector<uint32_t> m_leaf;
+};
+
+} // ns math
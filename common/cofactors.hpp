@@ -0,0 +1,107 @@
+#pragma once
+
+#include <utility>
+
+namespace math {
+
+namespace detail {
+
+// sequence without its element at position skip
+template <size_t skip, typename sequence, typename positions = std::make_index_sequence<sequence::size() - 1>>
+struct without;
+
+template <size_t skip, size_t... values, size_t... positions>
+struct without<skip, std::index_sequence<values...>, std::index_sequence<positions...>> {
+    static constexpr size_t source[] = {values...};
+    using type = std::index_sequence<source[positions < skip ? positions : positions + 1]...>;
+};
+
+// determinant of the submatrix formed by rows x cols of dimensions wide storage,
+// Laplace expansion along the first row with every index known at compile time
+template <size_t dimensions, typename value_type, typename rows, typename cols>
+struct minor_determinant;
+
+template <size_t dimensions, typename value_type>
+struct minor_determinant<dimensions, value_type, std::index_sequence<>, std::index_sequence<>> {
+    static constexpr value_type compute(const value_type*) {
+        return 1;
+    }
+};
+
+template <size_t dimensions, typename value_type, size_t row, size_t col>
+struct minor_determinant<dimensions, value_type, std::index_sequence<row>, std::index_sequence<col>> {
+    static constexpr value_type compute(const value_type* m) {
+        return m[row * dimensions + col];
+    }
+};
+
+template <size_t dimensions, typename value_type, size_t row, size_t next_row, size_t... rows, size_t... cols>
+struct minor_determinant<dimensions, value_type, std::index_sequence<row, next_row, rows...>, std::index_sequence<cols...>> {
+    static constexpr value_type compute(const value_type* m) {
+        return expand(m, std::make_index_sequence<sizeof...(cols)>{});
+    }
+
+private:
+    static constexpr size_t columns[] = {cols...};
+
+    template <size_t position>
+    static constexpr value_type term(const value_type* m) {
+        using rest = minor_determinant<dimensions, value_type, std::index_sequence<next_row, rows...>,
+                                       typename without<position, std::index_sequence<cols...>>::type>;
+        const value_type product = m[row * dimensions + columns[position]] * rest::compute(m);
+        return position % 2 ? -product : product;
+    }
+
+    template <size_t... positions>
+    static constexpr value_type expand(const value_type* m, std::index_sequence<positions...>) {
+        return (... + term<positions>(m));
+    }
+};
+
+} // ns detail
+
+// minors, cofactors and the adjugate of dimensions wide row-major storage generated
+// as straight-line code. The adjugate commutes with transposition, so column-major
+// storage gives the column-major adjugate as well
+template <size_t dimensions, typename value_type>
+struct cofactors {
+    using all = std::make_index_sequence<dimensions>;
+
+    template <size_t row, size_t col>
+    static constexpr value_type minor(const value_type* m) {
+        return detail::minor_determinant<dimensions, value_type,
+                                         typename detail::without<row, all>::type,
+                                         typename detail::without<col, all>::type>::compute(m);
+    }
+
+    template <size_t row, size_t col>
+    static constexpr value_type cofactor(const value_type* m) {
+        return (row + col) % 2 ? -minor<row, col>(m) : minor<row, col>(m);
+    }
+
+    // runtime indices go through a table of the generated functions
+    static value_type cofactor(const value_type* m, const size_t row, const size_t col) {
+        return table(std::make_index_sequence<dimensions * dimensions>{})[row * dimensions + col](m);
+    }
+
+    // adjugate[i][j] = cofactor(j, i), written transposed in a single pass
+    static constexpr void adjugate(const value_type* m, value_type* result) {
+        adjugate(m, result, std::make_index_sequence<dimensions * dimensions>{});
+    }
+
+private:
+    using function_type = value_type (*)(const value_type*);
+
+    template <size_t... index>
+    static const function_type* table(std::index_sequence<index...>) {
+        static constexpr function_type functions[] = {&cofactor<index / dimensions, index % dimensions>...};
+        return functions;
+    }
+
+    template <size_t... index>
+    static constexpr void adjugate(const value_type* m, value_type* result, std::index_sequence<index...>) {
+        ((result[index] = cofactor<index % dimensions, index / dimensions>(m)), ...);
+    }
+};
+
+} // ns math
@@ -0,0 +1,517 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <ostream>
+#include <vector>
+#include "aligned_arena.hpp"
+#include "lu_decomposition.hpp"
+#include "matrix.hpp"
+#include "matrix_error.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+
+// square matrices sized at runtime for offline work on larger systems, e.g. 64 - 512
+// dimensional least squares fits. Storage is row-major on the heap, aligned to cache
+// lines; the API follows matrix
+
+namespace math {
+
+namespace detail {
+
+// one tile of the blocked product: result rows [row_begin, row_end) and columns
+// [col_begin, col_end) accumulate lhs columns / rhs rows [depth_begin, depth_end)
+struct product_tile {
+    size_t row_begin, row_end;
+    size_t depth_begin, depth_end;
+    size_t col_begin, col_end;
+};
+
+// rhs tiles of block_depth x block_width stay in L2 while all result rows stream
+// past them, the block_width results of one row stay in L1
+static constexpr size_t block_depth = 128;
+static constexpr size_t block_width = 256;
+
+template <typename value_type>
+struct scalar_block_multiplicator {
+    static void compute(const value_type* lhs, const value_type* rhs, value_type* result, const size_t dimensions, const product_tile& tile) {
+        for (size_t row = tile.row_begin; row < tile.row_end; row++) {
+            value_type* target = result + row * dimensions;
+            for (size_t i = tile.depth_begin; i < tile.depth_end; i++) {
+                const value_type factor = lhs[row * dimensions + i];
+                const value_type* source = rhs + i * dimensions;
+                for (size_t col = tile.col_begin; col < tile.col_end; col++) {
+                    target[col] += factor * source[col];
+                }
+            }
+        }
+    }
+};
+
+// the blocked product dispatches here, the specialization below replaces the generic loops
+template <typename value_type>
+struct block_multiplicator : scalar_block_multiplicator<value_type> {};
+
+#if defined(MATH_SIMD_SSE)
+template <>
+struct block_multiplicator<float> {
+#if defined(MATH_SIMD_AVX)
+    using register_type = __m256;
+    static constexpr size_t width = 8;
+
+    static register_type load(const float* src) { return _mm256_loadu_ps(src); }
+    static void store(const register_type value, float* dst) { _mm256_storeu_ps(dst, value); }
+    static register_type broadcast(const float value) { return _mm256_set1_ps(value); }
+    static register_type multiply_add(const register_type a, const register_type b, const register_type c) {
+        return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+    }
+#else
+    using register_type = __m128;
+    static constexpr size_t width = 4;
+
+    static register_type load(const float* src) { return _mm_loadu_ps(src); }
+    static void store(const register_type value, float* dst) { _mm_storeu_ps(dst, value); }
+    static register_type broadcast(const float value) { return _mm_set1_ps(value); }
+    static register_type multiply_add(const register_type a, const register_type b, const register_type c) {
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+    }
+#endif
+
+    // 4 rows x 2 registers of results stay in registers for the whole tile depth,
+    // every rhs load feeds 4 products; remaining rows and columns take the scalar loops
+    static void compute(const float* lhs, const float* rhs, float* result, const size_t dimensions, const product_tile& tile) {
+        static constexpr size_t rows = 4;
+        static constexpr size_t step = 2 * width;
+        size_t row = tile.row_begin;
+        for (; row + rows <= tile.row_end; row += rows) {
+            size_t col = tile.col_begin;
+            for (; col + step <= tile.col_end; col += step) {
+                register_type sum[rows][2];
+                for (size_t r = 0; r < rows; r++) {
+                    sum[r][0] = load(result + (row + r) * dimensions + col);
+                    sum[r][1] = load(result + (row + r) * dimensions + col + width);
+                }
+                for (size_t i = tile.depth_begin; i < tile.depth_end; i++) {
+                    const register_type b0 = load(rhs + i * dimensions + col);
+                    const register_type b1 = load(rhs + i * dimensions + col + width);
+                    for (size_t r = 0; r < rows; r++) {
+                        const register_type a = broadcast(lhs[(row + r) * dimensions + i]);
+                        sum[r][0] = multiply_add(a, b0, sum[r][0]);
+                        sum[r][1] = multiply_add(a, b1, sum[r][1]);
+                    }
+                }
+                for (size_t r = 0; r < rows; r++) {
+                    store(sum[r][0], result + (row + r) * dimensions + col);
+                    store(sum[r][1], result + (row + r) * dimensions + col + width);
+                }
+            }
+            scalar_block_multiplicator<float>::compute(lhs, rhs, result, dimensions,
+                                                       {row, row + rows, tile.depth_begin, tile.depth_end, col, tile.col_end});
+        }
+        scalar_block_multiplicator<float>::compute(lhs, rhs, result, dimensions,
+                                                   {row, tile.row_end, tile.depth_begin, tile.depth_end, tile.col_begin, tile.col_end});
+    }
+};
+#endif
+
+// result += lhs * rhs, result rows are independent so threads take contiguous row ranges
+template <typename value_type>
+void multiply_blocked(const value_type* lhs, const value_type* rhs, value_type* result, const size_t dimensions, const size_t threads) {
+    // a thread of its own pays off from about a million multiply-adds
+    const size_t min_rows = std::max<size_t>(8, (size_t(1) << 20) / std::max<size_t>(1, dimensions * dimensions));
+    split(dimensions, threads, [=](const size_t begin, const size_t end) {
+        for (size_t depth = 0; depth < dimensions; depth += block_depth) {
+            for (size_t col = 0; col < dimensions; col += block_width) {
+                block_multiplicator<value_type>::compute(lhs, rhs, result, dimensions,
+                                                         {begin, end, depth, std::min(dimensions, depth + block_depth),
+                                                          col, std::min(dimensions, col + block_width)});
+            }
+        }
+    }, min_rows);
+}
+
+// adjugate of a singular matrix through PAQ = LU with complete pivoting, which reveals
+// the rank: below n - 1 every cofactor vanishes, at n - 1 the adjugate is the outer
+// product of the right and left null vectors scaled by the one cofactor that the
+// factorization yields for free
+template <typename value_type>
+void singular_adjugate(const value_type* data, const size_t dimensions, value_type* result) {
+    const size_t last = dimensions - 1;
+    aligned_vector<value_type> lu(data, data + dimensions * dimensions);
+    std::vector<size_t> rows(dimensions), cols(dimensions);
+    value_type scale = 1;
+    for (size_t i = 0; i < dimensions; i++) {
+        rows[i] = cols[i] = i;
+    }
+    std::fill(result, result + dimensions * dimensions, value_type(0));
+
+    // the last pivot of a singular matrix is zero up to rounding and never used
+    size_t rank = 0;
+    for (; rank < last; rank++) {
+        size_t pivot_row = rank, pivot_col = rank;
+        value_type pivot_value = 0;
+        for (size_t i = rank; i < dimensions; i++) {
+            for (size_t j = rank; j < dimensions; j++) {
+                if (std::abs(lu[i * dimensions + j]) > pivot_value) {
+                    pivot_row = i;
+                    pivot_col = j;
+                    pivot_value = std::abs(lu[i * dimensions + j]);
+                }
+            }
+        }
+        if (pivot_value == 0) {
+            break;
+        }
+        if (pivot_row != rank) {
+            for (size_t j = 0; j < dimensions; j++) {
+                std::swap(lu[rank * dimensions + j], lu[pivot_row * dimensions + j]);
+            }
+            std::swap(rows[rank], rows[pivot_row]);
+            scale = -scale;
+        }
+        if (pivot_col != rank) {
+            for (size_t i = 0; i < dimensions; i++) {
+                std::swap(lu[i * dimensions + rank], lu[i * dimensions + pivot_col]);
+            }
+            std::swap(cols[rank], cols[pivot_col]);
+            scale = -scale;
+        }
+        scale *= lu[rank * dimensions + rank];
+
+        const value_type* pivot = lu.data() + rank * dimensions;
+        for (size_t i = rank + 1; i < dimensions; i++) {
+            value_type* row = lu.data() + i * dimensions;
+            const value_type factor = row[rank] /= pivot[rank];
+            for (size_t j = rank + 1; j < dimensions; j++) {
+                row[j] -= factor * pivot[j];
+            }
+        }
+    }
+    if (rank < last) {
+        return;
+    }
+
+    // U z = 0 and v L = e_last with z_last = v_last = 1, permuted back to A x = 0 and y A = 0
+    std::vector<value_type> right(dimensions), left(dimensions);
+    right[last] = left[last] = 1;
+    for (size_t i = last; i--;) {
+        value_type sum = -lu[i * dimensions + last];
+        for (size_t j = i + 1; j < last; j++) {
+            sum -= lu[i * dimensions + j] * right[j];
+        }
+        right[i] = sum / lu[i * dimensions + i];
+
+        value_type left_sum = 0;
+        for (size_t j = i + 1; j < dimensions; j++) {
+            left_sum -= lu[j * dimensions + i] * left[j];
+        }
+        left[i] = left_sum;
+    }
+    // the cofactor of rows[last], cols[last] is the scaled product of the other pivots,
+    // both null vectors are 1 there
+    for (size_t i = 0; i < dimensions; i++) {
+        for (size_t j = 0; j < dimensions; j++) {
+            result[cols[i] * dimensions + rows[j]] = scale * right[i] * left[j];
+        }
+    }
+}
+
+} // ns detail
+
+// runtime sized counterpart of lu_decomposition
+template <typename value_type>
+class dynamic_lu_decomposition {
+
+public:
+    using container_type = aligned_vector<value_type>;
+    using vector_type = std::vector<value_type>;
+    using permutation_type = std::vector<size_t>;
+
+    dynamic_lu_decomposition(const size_t dimensions, const container_type& data):
+        m_dimensions(dimensions), m_lu(data), m_permutation(dimensions), m_sign(1),
+        m_singular(!detail::lu_factorize(m_lu.data(), dimensions, m_permutation.data(), m_sign)) {}
+
+    bool singular() const {
+        return m_singular;
+    }
+
+    value_type determinant() const {
+        if (m_singular) {
+            return 0;
+        }
+        value_type result = m_sign;
+        for (size_t i = 0; i < m_dimensions; i++) {
+            result *= m_lu[i * m_dimensions + i];
+        }
+        return result;
+    }
+
+    const vector_type solve(const vector_type& rhs) const {
+        if (rhs.size() != m_dimensions) {
+            throw matrix_error("right hand side size does not match the matrix dimensions");
+        }
+        vector_type result(m_dimensions);
+        solve(rhs.data(), result.data());
+        return result;
+    }
+
+    const container_type invert() const {
+        container_type result(m_dimensions * m_dimensions);
+        vector_type unit(m_dimensions);
+        vector_type column(m_dimensions);
+
+        for (size_t col = 0; col < m_dimensions; col++) {
+            unit[col] = 1;
+            solve(unit.data(), column.data());
+            unit[col] = 0;
+            for (size_t row = 0; row < m_dimensions; row++) {
+                result[row * m_dimensions + col] = column[row];
+            }
+        }
+        return result;
+    }
+
+    const container_type& container() const {
+        return m_lu;
+    }
+
+    const permutation_type& permutation() const {
+        return m_permutation;
+    }
+
+private:
+
+    void solve(const value_type* rhs, value_type* result) const {
+        if (m_singular) {
+            throw matrix_error("singular matrix system cannot be solved");
+        }
+        detail::lu_solve(m_lu.data(), m_dimensions, m_permutation.data(), rhs, result);
+    }
+
+    size_t           m_dimensions;
+    container_type   m_lu;
+    permutation_type m_permutation;
+    value_type       m_sign;
+    bool             m_singular;
+};
+
+template <typename value_type>
+class dynamic_matrix {
+
+public:
+    using container_type = aligned_vector<value_type>;
+    using vector_type = std::vector<value_type>;
+    using element_type = value_type;
+
+    dynamic_matrix():
+        m_dimensions(0) {}
+    explicit dynamic_matrix(const size_t dimensions):
+        m_dimensions(dimensions), m_data(dimensions * dimensions) {}
+    dynamic_matrix(const size_t dimensions, std::initializer_list<value_type> list):
+        m_dimensions(dimensions), m_data(list.begin(), list.end()) {
+        check_size();
+    }
+    dynamic_matrix(const size_t dimensions, container_type data):
+        m_dimensions(dimensions), m_data(std::move(data)) {
+        check_size();
+    }
+    template <size_t fixed_dimensions, storage_order order>
+    explicit dynamic_matrix(const matrix<fixed_dimensions, value_type, order>& other):
+        dynamic_matrix(fixed_dimensions) {
+        for (size_t row = 0; row < m_dimensions; row++) {
+            for (size_t col = 0; col < m_dimensions; col++) {
+                m_data[row * m_dimensions + col] = other.container().at({row, col});
+            }
+        }
+    }
+
+    static dynamic_matrix make_identity(const size_t dimensions) {
+        dynamic_matrix result(dimensions);
+        for (size_t i = 0; i < dimensions; i++) {
+            result.m_data[i * dimensions + i] = 1;
+        }
+        return result;
+    }
+
+    const dynamic_matrix identity() const {
+        return make_identity(m_dimensions);
+    }
+
+    size_t dimensions() const {
+        return m_dimensions;
+    }
+
+    value_type at(const size_t row, const size_t col) const {
+        return m_data[row * m_dimensions + col];
+    }
+
+    value_type& element(const size_t row, const size_t col) {
+        return m_data[row * m_dimensions + col];
+    }
+
+    const dynamic_matrix submatrix(const size_t row, const size_t col) const {
+        dynamic_matrix result(m_dimensions - 1);
+        for (size_t i = 0; i < m_dimensions - 1; i++) {
+            for (size_t j = 0; j < m_dimensions - 1; j++) {
+                result.m_data[i * (m_dimensions - 1) + j] = at(i < row ? i : i + 1, j < col ? j : j + 1);
+            }
+        }
+        return result;
+    }
+
+    value_type cofactor(const size_t row, const size_t col) const {
+        return ((row + col) % 2 ? -1 : 1) * submatrix(row, col).determinant();
+    }
+
+    value_type determinant() const {
+        return lu().determinant();
+    }
+
+    const dynamic_lu_decomposition<value_type> lu() const {
+        return dynamic_lu_decomposition<value_type>{m_dimensions, m_data};
+    }
+
+    const vector_type solve(const vector_type& rhs) const {
+        return lu().solve(rhs);
+    }
+
+    // det * inverse through one decomposition, singular matrices take a second, rank
+    // revealing one. Both are O(n^3)
+    const dynamic_matrix adjugate() const {
+        const dynamic_lu_decomposition<value_type> decomposition = lu();
+        if (!decomposition.singular()) {
+            return dynamic_matrix{m_dimensions, decomposition.invert()} * decomposition.determinant();
+        }
+        dynamic_matrix result(m_dimensions);
+        detail::singular_adjugate(m_data.data(), m_dimensions, result.m_data.data());
+        return result;
+    }
+
+    const dynamic_matrix invert() const {
+        const dynamic_lu_decomposition<value_type> decomposition = lu();
+        if (decomposition.singular()) {
+            throw matrix_error("matrix with determinant == 0 cannot be inverted");
+        }
+        return dynamic_matrix{m_dimensions, decomposition.invert()};
+    }
+
+    // tile by tile, so that neither side strides through memory a whole row at a time
+    const dynamic_matrix transpose() const {
+        static constexpr size_t tile = 32;
+        dynamic_matrix result(m_dimensions);
+        for (size_t row_begin = 0; row_begin < m_dimensions; row_begin += tile) {
+            for (size_t col_begin = 0; col_begin < m_dimensions; col_begin += tile) {
+                for (size_t row = row_begin; row < std::min(m_dimensions, row_begin + tile); row++) {
+                    for (size_t col = col_begin; col < std::min(m_dimensions, col_begin + tile); col++) {
+                        result.m_data[col * m_dimensions + row] = m_data[row * m_dimensions + col];
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    bool operator==(const dynamic_matrix& rhs) const {
+        return m_dimensions == rhs.m_dimensions && m_data == rhs.m_data;
+    }
+
+    bool operator!=(const dynamic_matrix& rhs) const {
+        return !(*this == rhs);
+    }
+
+    const dynamic_matrix operator*(const value_type rhs) const {
+        dynamic_matrix result(*this);
+        for (value_type& value : result.m_data) {
+            value *= rhs;
+        }
+        return result;
+    }
+
+    // column vector product
+    const vector_type operator*(const vector_type& vec) const {
+        check_size(vec);
+        vector_type result(m_dimensions);
+        for (size_t row = 0; row < m_dimensions; row++) {
+            const value_type* source = m_data.data() + row * m_dimensions;
+            value_type sum = 0;
+            for (size_t col = 0; col < m_dimensions; col++) {
+                sum += source[col] * vec[col];
+            }
+            result[row] = sum;
+        }
+        return result;
+    }
+
+    // row vector product, rows of the matrix are accumulated in storage order
+    const vector_type multiply_row_vector(const vector_type& vec) const {
+        check_size(vec);
+        vector_type result(m_dimensions);
+        for (size_t row = 0; row < m_dimensions; row++) {
+            const value_type* source = m_data.data() + row * m_dimensions;
+            for (size_t col = 0; col < m_dimensions; col++) {
+                result[col] += vec[row] * source[col];
+            }
+        }
+        return result;
+    }
+
+    const dynamic_matrix operator*(const dynamic_matrix& rhs) const {
+        return multiply(rhs, 1);
+    }
+
+    // cache blocked product, threads above 1 split large products by result rows
+    const dynamic_matrix multiply(const dynamic_matrix& rhs, const size_t threads) const {
+        if (rhs.m_dimensions != m_dimensions) {
+            throw matrix_error("matrix product operands must have the same dimensions");
+        }
+        dynamic_matrix result(m_dimensions);
+        detail::multiply_blocked(m_data.data(), rhs.m_data.data(), result.m_data.data(), m_dimensions, threads);
+        return result;
+    }
+
+    const container_type& container() const {
+        return m_data;
+    }
+
+    container_type& container() {
+        return m_data;
+    }
+
+private:
+
+    void check_size() const {
+        if (m_data.size() != m_dimensions * m_dimensions) {
+            throw matrix_error("element count does not match the matrix dimensions");
+        }
+    }
+
+    void check_size(const vector_type& vec) const {
+        if (vec.size() != m_dimensions) {
+            throw matrix_error("vector size does not match the matrix dimensions");
+        }
+    }
+
+    size_t           m_dimensions;
+    container_type   m_data;
+};
+
+template <typename value_type> std::ostream& operator<<(std::ostream& out, const dynamic_matrix<value_type>& rhs) {
+    out << "[";
+    for (size_t i = 0; i < rhs.container().size(); i++) {
+        out << (i ? ", " : "") << rhs.container()[i];
+    }
+    out << "]";
+    return out;
+}
+
+// row vector times matrix, see operator*(vector, matrix)
+template <typename value_type>
+const std::vector<value_type> operator*(const std::vector<value_type>& lhs, const dynamic_matrix<value_type>& rhs) {
+    return rhs.multiply_row_vector(lhs);
+}
+
+using dynamic_matrixf = dynamic_matrix<float>;
+using dynamic_matrixd = dynamic_matrix<double>;
+
+} // ns math
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "simd.hpp"
+#include "bounds.hpp"
+#include "matrix.hpp"
+#include "vector.hpp"
+
+// view frustum as six inward facing planes taken from a view projection matrix,
+// for rejecting bounding volumes that cannot reach the screen. Tests are
+// conservative: volumes near a corner outside the frustum may pass, volumes
+// inside never fail. Batch culls test 4 or 8 volumes at a time and give the
+// single volume results exactly
+
+namespace math {
+
+namespace detail {
+
+#if defined(MATH_SIMD_AVX)
+// rows a, b, c, d hold four floats of volumes i (low half) and i + 4 (high half):
+// the in-lane 4x4 transpose leaves every component of all 8 volumes in one register
+inline void transpose_lanes(const __m256 a, const __m256 b, const __m256 c, const __m256 d, __m256& x, __m256& y, __m256& z, __m256& w) {
+    const __m256 ab_low = _mm256_unpacklo_ps(a, b);
+    const __m256 ab_high = _mm256_unpackhi_ps(a, b);
+    const __m256 cd_low = _mm256_unpacklo_ps(c, d);
+    const __m256 cd_high = _mm256_unpackhi_ps(c, d);
+    x = _mm256_shuffle_ps(ab_low, cd_low, _MM_SHUFFLE(1, 0, 1, 0));
+    y = _mm256_shuffle_ps(ab_low, cd_low, _MM_SHUFFLE(3, 2, 3, 2));
+    z = _mm256_shuffle_ps(ab_high, cd_high, _MM_SHUFFLE(1, 0, 1, 0));
+    w = _mm256_shuffle_ps(ab_high, cd_high, _MM_SHUFFLE(3, 2, 3, 2));
+}
+#endif
+
+#if defined(MATH_SIMD_SSE)
+// plane coefficients and their absolute values broadcast into registers; the
+// products and sums run in the order of frustum::intersects()
+struct plane_lanes4 {
+    __m128 planes[6][4];
+    __m128 normals[6][3];
+
+    explicit plane_lanes4(const std::array<vector::vec4, 6>& source) {
+        for (size_t plane = 0; plane < 6; plane++) {
+            for (size_t component = 0; component < 4; component++) {
+                planes[plane][component] = _mm_set1_ps(source[plane].data()[component]);
+                if (component < 3) {
+                    normals[plane][component] = _mm_set1_ps(std::fabs(source[plane].data()[component]));
+                }
+            }
+        }
+    }
+
+    __m128 distance(const size_t plane, const __m128 x, const __m128 y, const __m128 z) const {
+        const __m128* p = planes[plane];
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, p[0]), _mm_mul_ps(y, p[1])), _mm_add_ps(_mm_mul_ps(z, p[2]), p[3]));
+    }
+
+    // bit per lane
+    int inside(const __m128 x, const __m128 y, const __m128 z, const __m128 radius) const {
+        __m128 result = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t plane = 0; plane < 6; plane++) {
+            result = _mm_and_ps(result, _mm_cmpge_ps(_mm_add_ps(distance(plane, x, y, z), radius), _mm_setzero_ps()));
+        }
+        return _mm_movemask_ps(result);
+    }
+
+    int inside(const __m128 x, const __m128 y, const __m128 z, const __m128 extent_x, const __m128 extent_y, const __m128 extent_z) const {
+        __m128 result = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t plane = 0; plane < 6; plane++) {
+            const __m128* n = normals[plane];
+            const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extent_x, n[0]), _mm_mul_ps(extent_y, n[1])), _mm_mul_ps(extent_z, n[2]));
+            result = _mm_and_ps(result, _mm_cmpge_ps(_mm_add_ps(distance(plane, x, y, z), radius), _mm_setzero_ps()));
+        }
+        return _mm_movemask_ps(result);
+    }
+};
+#endif
+
+#if defined(MATH_SIMD_AVX)
+struct plane_lanes8 {
+    __m256 planes[6][4];
+    __m256 normals[6][3];
+
+    explicit plane_lanes8(const std::array<vector::vec4, 6>& source) {
+        for (size_t plane = 0; plane < 6; plane++) {
+            for (size_t component = 0; component < 4; component++) {
+                planes[plane][component] = _mm256_set1_ps(source[plane].data()[component]);
+                if (component < 3) {
+                    normals[plane][component] = _mm256_set1_ps(std::fabs(source[plane].data()[component]));
+                }
+            }
+        }
+    }
+
+    __m256 distance(const size_t plane, const __m256 x, const __m256 y, const __m256 z) const {
+        const __m256* p = planes[plane];
+        return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, p[0]), _mm256_mul_ps(y, p[1])), _mm256_add_ps(_mm256_mul_ps(z, p[2]), p[3]));
+    }
+
+    int inside(const __m256 x, const __m256 y, const __m256 z, const __m256 radius) const {
+        __m256 result = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t plane = 0; plane < 6; plane++) {
+            result = _mm256_and_ps(result, _mm256_cmp_ps(_mm256_add_ps(distance(plane, x, y, z), radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        return _mm256_movemask_ps(result);
+    }
+
+    int inside(const __m256 x, const __m256 y, const __m256 z, const __m256 extent_x, const __m256 extent_y, const __m256 extent_z) const {
+        __m256 result = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t plane = 0; plane < 6; plane++) {
+            const __m256* n = normals[plane];
+            const __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(extent_x, n[0]), _mm256_mul_ps(extent_y, n[1])), _mm256_mul_ps(extent_z, n[2]));
+            result = _mm256_and_ps(result, _mm256_cmp_ps(_mm256_add_ps(distance(plane, x, y, z), radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        return _mm256_movemask_ps(result);
+    }
+};
+#endif
+
+} // ns detail
+
+class frustum {
+
+public:
+    enum : size_t {
+        left_plane,
+        right_plane,
+        bottom_plane,
+        top_plane,
+        near_plane,
+        far_plane,
+        plane_count
+    };
+
+    // clip = point * view_projection with -w <= x, y, z <= w inside, so each plane
+    // is the sum or difference of the fourth column and another one
+    explicit frustum(const mat4f& view_projection) {
+        const float* m = view_projection.container().raw();
+        for (size_t index = 0; index < plane_count; index++) {
+            const size_t col = index / 2;
+            const float sign = index % 2 ? -1.f : 1.f;
+            const vector::vec4 plane({m[3] + sign * m[col], m[7] + sign * m[4 + col], m[11] + sign * m[8 + col], m[15] + sign * m[12 + col]});
+            const float length = std::sqrt(plane.data()[0] * plane.data()[0] + plane.data()[1] * plane.data()[1] + plane.data()[2] * plane.data()[2]);
+            m_planes[index] = length ? plane / length : plane;
+        }
+    }
+
+    // (normal, distance) with unit normals, signed distances are positive inside
+    const vector::vec4& plane(const size_t index) const {
+        return m_planes[index];
+    }
+
+    bool intersects(const sphere& bounds) const {
+        for (const vector::vec4& plane : m_planes) {
+            if (distance(plane, bounds.x, bounds.y, bounds.z) + bounds.radius < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool intersects(const aabb& bounds) const {
+        const vector::vec3 center = bounds.center();
+        const vector::vec3 extent = bounds.extent();
+        for (const vector::vec4& plane : m_planes) {
+            const float* p = plane.data().data();
+            const float* e = extent.data().data();
+            // extent projected onto the normal
+            const float radius = (e[0] * std::fabs(p[0]) + e[1] * std::fabs(p[1])) + e[2] * std::fabs(p[2]);
+            if (distance(plane, center.data()[0], center.data()[1], center.data()[2]) + radius < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // the whole box is inside, e.g. to accept a bounding volume hierarchy subtree
+    // without testing its contents
+    bool contains(const aabb& bounds) const {
+        const vector::vec3 center = bounds.center();
+        const vector::vec3 extent = bounds.extent();
+        for (const vector::vec4& plane : m_planes) {
+            const float* p = plane.data().data();
+            const float* e = extent.data().data();
+            const float radius = (e[0] * std::fabs(p[0]) + e[1] * std::fabs(p[1])) + e[2] * std::fabs(p[2]);
+            if (distance(plane, center.data()[0], center.data()[1], center.data()[2]) - radius < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // writes the indices of the visible volumes in ascending order to visible,
+    // which has room for count indices, and returns how many there are
+    size_t cull(const sphere* bounds, const size_t count, uint32_t* visible) const {
+        size_t i = 0, result = 0;
+#if defined(MATH_SIMD_AVX)
+        const detail::plane_lanes8 lanes8(m_planes);
+        for (; i + 8 <= count; i += 8) {
+            __m256 x, y, z, radius;
+            detail::transpose_lanes(bounds_row(bounds, i, 0), bounds_row(bounds, i, 1), bounds_row(bounds, i, 2), bounds_row(bounds, i, 3), x, y, z, radius);
+            result = append(lanes8.inside(x, y, z, radius), 8, i, visible, result);
+        }
+#endif
+#if defined(MATH_SIMD_SSE)
+        const detail::plane_lanes4 lanes4(m_planes);
+        for (; i + 4 <= count; i += 4) {
+            __m128 x = _mm_load_ps(&bounds[i].x);
+            __m128 y = _mm_load_ps(&bounds[i + 1].x);
+            __m128 z = _mm_load_ps(&bounds[i + 2].x);
+            __m128 radius = _mm_load_ps(&bounds[i + 3].x);
+            _MM_TRANSPOSE4_PS(x, y, z, radius);
+            result = append(lanes4.inside(x, y, z, radius), 4, i, visible, result);
+        }
+#endif
+        for (; i < count; i++) {
+            visible[result] = uint32_t(i);
+            result += intersects(bounds[i]);
+        }
+        return result;
+    }
+
+    size_t cull(const aabb* bounds, const size_t count, uint32_t* visible) const {
+        size_t i = 0, result = 0;
+#if defined(MATH_SIMD_AVX)
+        const detail::plane_lanes8 lanes8(m_planes);
+        const __m256 half8 = _mm256_set1_ps(.5f);
+        for (; i + 8 <= count; i += 8) {
+            __m256 min_x, min_y, min_z, max_x, max_y, max_z, padding;
+            detail::transpose_lanes(corner_row(bounds, i, 0, &aabb::min), corner_row(bounds, i, 1, &aabb::min),
+                                    corner_row(bounds, i, 2, &aabb::min), corner_row(bounds, i, 3, &aabb::min), min_x, min_y, min_z, padding);
+            detail::transpose_lanes(corner_row(bounds, i, 0, &aabb::max), corner_row(bounds, i, 1, &aabb::max),
+                                    corner_row(bounds, i, 2, &aabb::max), corner_row(bounds, i, 3, &aabb::max), max_x, max_y, max_z, padding);
+            result = append(lanes8.inside(_mm256_mul_ps(_mm256_add_ps(min_x, max_x), half8),
+                                          _mm256_mul_ps(_mm256_add_ps(min_y, max_y), half8),
+                                          _mm256_mul_ps(_mm256_add_ps(min_z, max_z), half8),
+                                          _mm256_mul_ps(_mm256_sub_ps(max_x, min_x), half8),
+                                          _mm256_mul_ps(_mm256_sub_ps(max_y, min_y), half8),
+                                          _mm256_mul_ps(_mm256_sub_ps(max_z, min_z), half8)), 8, i, visible, result);
+        }
+#endif
+#if defined(MATH_SIMD_SSE)
+        const detail::plane_lanes4 lanes4(m_planes);
+        const __m128 half4 = _mm_set1_ps(.5f);
+        for (; i + 4 <= count; i += 4) {
+            __m128 min_x = _mm_load_ps(bounds[i].min.data().data());
+            __m128 min_y = _mm_load_ps(bounds[i + 1].min.data().data());
+            __m128 min_z = _mm_load_ps(bounds[i + 2].min.data().data());
+            __m128 min_padding = _mm_load_ps(bounds[i + 3].min.data().data());
+            __m128 max_x = _mm_load_ps(bounds[i].max.data().data());
+            __m128 max_y = _mm_load_ps(bounds[i + 1].max.data().data());
+            __m128 max_z = _mm_load_ps(bounds[i + 2].max.data().data());
+            __m128 max_padding = _mm_load_ps(bounds[i + 3].max.data().data());
+            _MM_TRANSPOSE4_PS(min_x, min_y, min_z, min_padding);
+            _MM_TRANSPOSE4_PS(max_x, max_y, max_z, max_padding);
+            result = append(lanes4.inside(_mm_mul_ps(_mm_add_ps(min_x, max_x), half4),
+                                          _mm_mul_ps(_mm_add_ps(min_y, max_y), half4),
+                                          _mm_mul_ps(_mm_add_ps(min_z, max_z), half4),
+                                          _mm_mul_ps(_mm_sub_ps(max_x, min_x), half4),
+                                          _mm_mul_ps(_mm_sub_ps(max_y, min_y), half4),
+                                          _mm_mul_ps(_mm_sub_ps(max_z, min_z), half4)), 4, i, visible, result);
+        }
+#endif
+        for (; i < count; i++) {
+            visible[result] = uint32_t(i);
+            result += intersects(bounds[i]);
+        }
+        return result;
+    }
+
+private:
+
+    // same operation order in every path, so batches match the single tests
+    static float distance(const vector::vec4& plane, const float x, const float y, const float z) {
+        const float* p = plane.data().data();
+        return (x * p[0] + y * p[1]) + (z * p[2] + p[3]);
+    }
+
+    // branch free compaction of the lanes set in mask
+    static size_t append(const int mask, const size_t lanes, const size_t first, uint32_t* visible, size_t result) {
+        for (size_t lane = 0; lane < lanes; lane++) {
+            visible[result] = uint32_t(first + lane);
+            result += (mask >> lane) & 1;
+        }
+        return result;
+    }
+
+#if defined(MATH_SIMD_AVX)
+    // volumes first + row and first + row + 4 in the two halves
+    static __m256 bounds_row(const sphere* bounds, const size_t first, const size_t row) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(&bounds[first + row].x)), _mm_load_ps(&bounds[first + row + 4].x), 1);
+    }
+
+    static __m256 corner_row(const aabb* bounds, const size_t first, const size_t row, vector::vec3 aabb::* corner) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps((bounds[first + row].*corner).data().data())),
+                                    _mm_load_ps((bounds[first + row + 4].*corner).data().data()), 1);
+    }
+#endif
+
+    std::array<vector::vec4, plane_count> m_planes;
+};
+
+} // ns math
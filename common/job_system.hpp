@@ -0,0 +1,312 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// work stealing thread pool. Every worker owns a deque: it pushes and pops jobs at
+// the back, idle workers steal from the front of the others. Threads outside the
+// pool share one more deque. Waiting threads run queued jobs instead of blocking,
+// so jobs may submit and wait for further jobs without deadlocking the pool
+
+namespace common {
+
+// counts the unfinished jobs of one submission, keeps the first exception
+class job_counter {
+
+public:
+    job_counter():
+        m_pending(0), m_failed(false) {}
+
+    job_counter(const job_counter&) = delete;
+    job_counter& operator=(const job_counter&) = delete;
+
+    bool done() const {
+        return m_pending.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class job_system;
+
+    std::atomic<size_t> m_pending;
+    std::atomic<bool>   m_failed;
+    std::exception_ptr  m_error;
+};
+
+class job_system {
+
+public:
+    using job = std::function<void()>;
+
+    // threads counts the calling thread, the pool starts threads - 1 workers
+    explicit job_system(const size_t threads = std::max(1u, std::thread::hardware_concurrency())):
+        m_queued(0), m_sleeping(0), m_stop(false) {
+        const size_t workers = std::max<size_t>(1, threads) - 1;
+        for (size_t index = 0; index <= workers; index++) {
+            m_queues.emplace_back(new queue);
+        }
+        for (size_t index = 0; index < workers; index++) {
+            m_workers.emplace_back(&job_system::work, this, index);
+        }
+    }
+
+    job_system(const job_system&) = delete;
+    job_system& operator=(const job_system&) = delete;
+
+    // finishes the queued jobs first
+    ~job_system() {
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    // pool shared by the batch functions of common/
+    static job_system& shared() {
+        static job_system instance;
+        return instance;
+    }
+
+    size_t concurrency() const {
+        return m_workers.size() + 1;
+    }
+
+    void submit(job work, job_counter& counter) {
+        counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+        queue& target = *m_queues[queue_index()];
+        // counted ahead of the push, so the count never drops below the queued jobs
+        m_queued.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(target.mutex);
+            target.tasks.push_back({std::move(work), &counter});
+        }
+        if (m_sleeping.load()) {
+            {
+                std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            }
+            m_wake.notify_one();
+        }
+    }
+
+    // runs queued jobs until the counter drops to zero, then rethrows the first
+    // exception of its jobs
+    void wait(job_counter& counter) {
+        const size_t index = queue_index();
+        while (!counter.done()) {
+            if (!run_one(index)) {
+                std::this_thread::yield();
+            }
+        }
+        if (counter.m_error) {
+            std::rethrow_exception(counter.m_error);
+        }
+    }
+
+    // body(begin, end) over [0, count) in chunks of chunk_size, the calling thread
+    // takes the first chunk and returns when all chunks are done
+    template <typename body_type>
+    void parallel_chunks(const size_t count, const size_t chunk_size, const body_type& body) {
+        if (chunk_size >= count) {
+            body(size_t(0), count);
+            return;
+        }
+        job_counter counter;
+        for (size_t begin = chunk_size; begin < count; begin += chunk_size) {
+            const size_t end = std::min(count, begin + chunk_size);
+            submit([&body, begin, end] { body(begin, end); }, counter);
+        }
+        run(counter, [&body, chunk_size] { body(size_t(0), chunk_size); });
+        wait(counter);
+    }
+
+    // a few chunks per thread leave room for stealing when chunks take unequal time,
+    // min_chunk is the smallest count worth a job of its own
+    template <typename body_type>
+    void parallel_for(const size_t count, const body_type& body, const size_t min_chunk = 1) {
+        const size_t chunks = std::min(concurrency() * 4, std::max<size_t>(1, count / std::max<size_t>(1, min_chunk)));
+        parallel_chunks(count, (count + chunks - 1) / chunks, body);
+    }
+
+private:
+
+    struct task {
+        job          work;
+        job_counter* counter;
+    };
+
+    struct alignas(64) queue {
+        std::mutex       mutex;
+        std::deque<task> tasks;
+    };
+
+    struct thread_identity {
+        const job_system* pool;
+        size_t            index;
+    };
+
+    static thread_identity& identity() {
+        static thread_local thread_identity instance{nullptr, 0};
+        return instance;
+    }
+
+    // workers own a deque each, every other thread uses the last one
+    size_t queue_index() const {
+        const thread_identity& current = identity();
+        return current.pool == this ? current.index : m_queues.size() - 1;
+    }
+
+    template <typename work_type>
+    static void run(job_counter& counter, const work_type& work) {
+        try {
+            work();
+        } catch (...) {
+            if (!counter.m_failed.exchange(true)) {
+                counter.m_error = std::current_exception();
+            }
+        }
+    }
+
+    // own jobs newest first, then the oldest job of another deque
+    bool run_one(const size_t index) {
+        if (!m_queued.load()) {
+            return false;
+        }
+        task current;
+        bool found = false;
+        for (size_t offset = 0; offset < m_queues.size() && !found; offset++) {
+            queue& source = *m_queues[(index + offset) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(source.mutex);
+            if (source.tasks.empty()) {
+                continue;
+            }
+            if (offset) {
+                current = std::move(source.tasks.front());
+                source.tasks.pop_front();
+            } else {
+                current = std::move(source.tasks.back());
+                source.tasks.pop_back();
+            }
+            found = true;
+        }
+        if (!found) {
+            return false;
+        }
+        m_queued.fetch_sub(1);
+        run(*current.counter, current.work);
+        current.counter->m_pending.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    void work(const size_t index) {
+        identity() = {this, index};
+        while (true) {
+            if (run_one(index)) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            if (m_stop && !m_queued.load()) {
+                return;
+            }
+            m_sleeping.fetch_add(1);
+            m_wake.wait(lock, [this] { return m_stop || m_queued.load(); });
+            m_sleeping.fetch_sub(1);
+        }
+    }
+
+    std::vector<std::unique_ptr<queue>> m_queues;
+    std::vector<std::thread>            m_workers;
+    std::atomic<size_t>                 m_queued;
+    std::atomic<size_t>                 m_sleeping;
+    std::mutex                          m_sleep_mutex;
+    std::condition_variable             m_wake;
+    bool                                m_stop;
+};
+
+// jobs with dependencies: a job is submitted once all jobs it depends on are done.
+// run() may be called again after it returns
+class job_graph {
+
+public:
+    using job_id = size_t;
+
+    job_id add(job_system::job work) {
+        m_nodes.push_back({std::move(work), {}, 0, {}});
+        return m_nodes.size() - 1;
+    }
+
+    // job runs after dependency
+    void depend(const job_id job, const job_id dependency) {
+        m_nodes[dependency].successors.push_back(job);
+        m_nodes[job].dependencies++;
+    }
+
+    size_t size() const {
+        return m_nodes.size();
+    }
+
+    void run(job_system& jobs) {
+        for (node& current : m_nodes) {
+            current.remaining.store(current.dependencies, std::memory_order_relaxed);
+        }
+        job_counter counter;
+        for (job_id id = 0; id < m_nodes.size(); id++) {
+            if (!m_nodes[id].dependencies) {
+                submit(jobs, id, counter);
+            }
+        }
+        jobs.wait(counter);
+    }
+
+private:
+
+    struct node {
+        job_system::job     work;
+        std::vector<job_id> successors;
+        size_t              dependencies;
+        std::atomic<size_t> remaining;
+
+        node(job_system::job work, std::vector<job_id> successors, const size_t dependencies, const size_t remaining):
+            work(std::move(work)), successors(std::move(successors)), dependencies(dependencies), remaining(remaining) {}
+
+        node(node&& other):
+            node(std::move(other.work), std::move(other.successors), other.dependencies, other.remaining.load()) {}
+    };
+
+    // successors of a failed job still run, the counter reports the failure
+    void submit(job_system& jobs, const job_id id, job_counter& counter) {
+        jobs.submit([this, &jobs, id, &counter] {
+            try {
+                m_nodes[id].work();
+            } catch (...) {
+                release(jobs, id, counter);
+                throw;
+            }
+            release(jobs, id, counter);
+        }, counter);
+    }
+
+    // submits the successors that waited only for id, outside of any destructor
+    // so that a throwing submit() reaches the counter
+    void release(job_system& jobs, const job_id id, job_counter& counter) {
+        for (const job_id successor : m_nodes[id].successors) {
+            if (m_nodes[successor].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                submit(jobs, successor, counter);
+            }
+        }
+    }
+
+    std::vector<node> m_nodes;
+};
+
+} // ns common
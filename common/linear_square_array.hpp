@@ -2,76 +2,141 @@
 
 #include <array>
 #include <cassert>
+#include <ostream>
+#include <utility>
 
 namespace math {
 
-template <size_t width, typename value_type>
-class linear_square_array {
+// element order in memory; row_major stores element {row, col} at row * width + col
+enum class storage_order {
+    row_major,
+    column_major
+};
+
+// storage layout policies: alignment of the whole array, element order and the
+// number of stored elements per row (or column), indexing hides any padding
+template <size_t alignment_bytes, storage_order storage = storage_order::row_major>
+struct aligned_layout {
+    static constexpr size_t alignment = alignment_bytes;
+    static constexpr storage_order order = storage;
+
+    static constexpr size_t row_stride(const size_t width) {
+        return width;
+    }
+};
+
+// every row (column) padded to four elements, the std140 uniform block layout of mat2 and mat3
+template <storage_order storage = storage_order::row_major>
+struct std140_layout {
+    static constexpr size_t alignment = 16;
+    static constexpr storage_order order = storage;
+
+    static constexpr size_t row_stride(const size_t) {
+        return 4;
+    }
+};
+
+// 16 byte alignment whenever the size is a multiple of it, e.g. mat4f and mat2f
+template <size_t width, typename value_type, storage_order order = storage_order::row_major>
+using default_layout = aligned_layout<(width * width * sizeof(value_type)) % 16 ? alignof(value_type) : 16, order>;
+
+template <size_t width, typename value_type, typename layout = default_layout<width, value_type>>
+class alignas(layout::alignment) linear_square_array {
 
 public:
+    using layout_type = layout;
     static constexpr size_t container_size = width * width;
-    using container_type = std::array<value_type, container_size>;
+    static constexpr size_t row_stride = layout::row_stride(width);
+    static constexpr size_t storage_size = width * row_stride;
+    using container_type = std::array<value_type, storage_size>;
     using index_pair = std::pair<size_t, size_t>;
 
-    linear_square_array() {
-        m_container.fill(0);
-    }
+    constexpr linear_square_array():
+        m_container{} {}
     // TODO: rewrite without copying (std::forward somehow)
-    linear_square_array(std::initializer_list<value_type> list) {
-        assert(m_container.size() == list.size());
+    constexpr linear_square_array(std::initializer_list<value_type> list):
+        m_container{} {
+        assert(container_size == list.size());
         size_t index = 0;
         for (auto&& item : list) {
-            m_container[index++] = item;
+            m_container[to_storage_index(index++)] = item;
         }
     }
-    linear_square_array(const container_type& container):
+    constexpr linear_square_array(const container_type& container):
         m_container(container) {}
+    // repacks between layouts keeping the element values, e.g. into std140 padded
+    // rows for a uniform buffer or into the other storage order
+    template <typename other_layout>
+    constexpr explicit linear_square_array(const linear_square_array<width, value_type, other_layout>& other):
+        m_container{} {
+        for (size_t row = 0; row < width; row++) {
+            for (size_t col = 0; col < width; col++) {
+                m_container[to_linear_index(row, col)] = other.at({row, col});
+            }
+        }
+    }
 
-    value_type& operator[](const index_pair& pair) {
+    constexpr value_type& operator[](const index_pair& pair) {
         return m_container[to_linear_index(pair)];
     }
 
-    value_type& operator[](const size_t linear_index) {
+    constexpr value_type& operator[](const size_t linear_index) {
         assert(linear_index < container_size);
-        return m_container[linear_index];
+        return m_container[to_storage_index(linear_index)];
     }
 
-    const value_type& at(const index_pair& pair) const {
+    constexpr const value_type& at(const index_pair& pair) const {
         return m_container.at(to_linear_index(pair));
     }
 
-    const value_type& at(const size_t linear_index) const {
+    constexpr const value_type& at(const size_t linear_index) const {
         assert(linear_index < container_size);
-        return m_container.at(linear_index);
+        return m_container.at(to_storage_index(linear_index));
     }
 
-    bool operator==(const linear_square_array& other) const {
-        return m_container == other.m_container;
+    constexpr bool operator==(const linear_square_array& other) const {
+        for (size_t i = 0; i < container_size; i++) {
+            if (at(i) != other.at(i)) {
+                return false;
+            }
+        }
+        return true;
     }
 
-    void swap(const index_pair& first, const index_pair& second) {
+    constexpr void swap(const index_pair& first, const index_pair& second) {
         value_type temp = (*this)[first];
         (*this)[first]  = (*this)[second];
         (*this)[second] = temp;
     }
 
-    const value_type* raw() const {
+    // storage_size elements in storage order, including padding
+    constexpr const value_type* raw() const {
+        return m_container.data();
+    }
+
+    constexpr value_type* raw() {
         return m_container.data();
     }
 
 private:
-    size_t to_linear_index(const size_t row, const size_t col) const {
-        return row * width + col;
+    constexpr size_t to_linear_index(const size_t row, const size_t col) const {
+        return layout::order == storage_order::row_major ? row * row_stride + col : col * row_stride + row;
+    }
+
+    // row-major element number to storage position, the identity for dense row-major storage
+    constexpr size_t to_storage_index(const size_t linear_index) const {
+        return row_stride == width && layout::order == storage_order::row_major ? linear_index
+                                                                                 : to_linear_index(linear_index / width, linear_index % width);
     }
 
-    size_t to_linear_index(const index_pair& pair) const {
+    constexpr size_t to_linear_index(const index_pair& pair) const {
         return to_linear_index(pair.first, pair.second);
     }
 
     container_type m_container;
 };
 
-template <size_t width, class value_type> std::ostream& operator<<(std::ostream& out, const linear_square_array<width, value_type>& rhs) {
+template <size_t width, class value_type, class layout> std::ostream& operator<<(std::ostream& out, const linear_square_array<width, value_type, layout>& rhs) {
     out << "[";
     for (size_t i = 0; i < width * width; i++) {
         out << (i ? ", " : "") << rhs.at(i);
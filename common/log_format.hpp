@@ -0,0 +1,531 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+// messages with deferred formatting. A log_format is a message text with {}
+// placeholders, declared once as a static; the binary log stores its id and the
+// raw arguments, and only the decoder renders the text. The file holds the magic
+// bytes followed by records of
+//   varint id, varint payload size, payload
+// id text_record carries plain text, id format_record defines a format (varint
+// id, then its text) ahead of its first use. Any other id is a message whose
+// payload holds one tagged argument per placeholder. Floats are stored in host
+// byte order, the decoder expects a log written on the same kind of machine
+
+namespace common {
+
+class log_format {
+
+public:
+    // text must outlive the format, e.g. a string literal
+    explicit log_format(const char* text):
+        m_text(text), m_id(next_id()), m_ends_line(*text && text[std::strlen(text) - 1] == '\n') {}
+
+    log_format(const log_format&) = delete;
+    log_format& operator=(const log_format&) = delete;
+
+    const char* text() const {
+        return m_text;
+    }
+
+    uint32_t id() const {
+        return m_id;
+    }
+
+    bool ends_line() const {
+        return m_ends_line;
+    }
+
+private:
+
+    static uint32_t next_id();
+
+    const char* m_text;
+    uint32_t    m_id;
+    bool        m_ends_line;
+};
+
+// numbers as text in [first, last), without allocating. Floats look like the
+// default std::ostream output, char is written as a character and any other
+// integer as a number. Each returns the end of the text
+static constexpr size_t max_number_size = 24;
+
+inline char* to_text(char* first, char* last, const int64_t value) {
+    return std::to_chars(first, last, value).ptr;
+}
+
+inline char* to_text(char* first, char* last, const uint64_t value) {
+    return std::to_chars(first, last, value).ptr;
+}
+
+inline char* to_text(char* first, char* last, const double value) {
+#if defined(__cpp_lib_to_chars)
+    return std::to_chars(first, last, value, std::chars_format::general, 6).ptr;
+#else
+    const int size = std::snprintf(first, size_t(last - first), "%g", value);
+    return first + std::max(0, std::min(size, int(last - first) - 1));
+#endif
+}
+
+inline char* to_text(char* first, char* last, const float value) {
+    return to_text(first, last, double(value));
+}
+
+inline char* to_text(char* first, char*, const char character) {
+    *first = character;
+    return first + 1;
+}
+
+template <typename value_type>
+std::enable_if_t<std::is_integral<value_type>::value, char*> to_text(char* first, char* last, const value_type value) {
+    if (std::is_signed<value_type>::value) {
+        return to_text(first, last, int64_t(value));
+    }
+    return to_text(first, last, uint64_t(value));
+}
+
+// GLenum is a plain unsigned int and logs as a number, as gl_enum it logs by name
+struct gl_enum {
+    unsigned int value;
+};
+
+// values from the OpenGL registry, this header does not depend on GL
+inline const char* gl_enum_name(const unsigned int value) {
+    switch (value) {
+        case 0x0500: return "GL_INVALID_ENUM";
+        case 0x0501: return "GL_INVALID_VALUE";
+        case 0x0502: return "GL_INVALID_OPERATION";
+        case 0x0505: return "GL_OUT_OF_MEMORY";
+        case 0x0506: return "GL_INVALID_FRAMEBUFFER_OPERATION";
+        case 0x1400: return "GL_BYTE";
+        case 0x1401: return "GL_UNSIGNED_BYTE";
+        case 0x1402: return "GL_SHORT";
+        case 0x1403: return "GL_UNSIGNED_SHORT";
+        case 0x1404: return "GL_INT";
+        case 0x1405: return "GL_UNSIGNED_INT";
+        case 0x1406: return "GL_FLOAT";
+        case 0x140A: return "GL_DOUBLE";
+        case 0x8B30: return "GL_FRAGMENT_SHADER";
+        case 0x8B31: return "GL_VERTEX_SHADER";
+        case 0x8B50: return "GL_FLOAT_VEC2";
+        case 0x8B51: return "GL_FLOAT_VEC3";
+        case 0x8B52: return "GL_FLOAT_VEC4";
+        case 0x8B53: return "GL_INT_VEC2";
+        case 0x8B54: return "GL_INT_VEC3";
+        case 0x8B55: return "GL_INT_VEC4";
+        case 0x8B56: return "GL_BOOL";
+        case 0x8B5A: return "GL_FLOAT_MAT2";
+        case 0x8B5B: return "GL_FLOAT_MAT3";
+        case 0x8B5C: return "GL_FLOAT_MAT4";
+        case 0x8B5E: return "GL_SAMPLER_2D";
+        case 0x8B5F: return "GL_SAMPLER_3D";
+        case 0x8B60: return "GL_SAMPLER_CUBE";
+        case 0x8B62: return "GL_SAMPLER_2D_SHADOW";
+        case 0x8B81: return "GL_COMPILE_STATUS";
+        case 0x8B82: return "GL_LINK_STATUS";
+        case 0x8B83: return "GL_VALIDATE_STATUS";
+        case 0x8B84: return "GL_INFO_LOG_LENGTH";
+        case 0x8B85: return "GL_ATTACHED_SHADERS";
+        case 0x8B86: return "GL_ACTIVE_UNIFORMS";
+        case 0x8B89: return "GL_ACTIVE_ATTRIBUTES";
+        case 0x8DD9: return "GL_GEOMETRY_SHADER";
+        default: return nullptr;
+    }
+}
+
+// unknown enums in hexadecimal
+inline char* to_text(char* first, char* last, const gl_enum value) {
+    const char* name = gl_enum_name(value.value);
+    if (!name) {
+        first = std::copy_n("0x", 2, first);
+        return std::to_chars(first, last, value.value, 16).ptr;
+    }
+    const size_t size = std::min(std::strlen(name), size_t(last - first));
+    return std::copy_n(name, size, first);
+}
+
+namespace binary_log {
+
+static constexpr char magic[8] = {'g', 'l', '4', 'l', 'o', 'g', '\n', '\1'};
+
+enum : uint32_t {
+    text_record   = 0,
+    format_record = 1,
+    first_format  = 2
+};
+
+enum class argument : uint8_t {
+    signed_integer,
+    unsigned_integer,
+    float32,
+    float64,
+    string,
+    gl_enumeration
+};
+
+// encoded arguments of one message, kept on the stack
+class bytes {
+
+public:
+    static constexpr size_t capacity = 512;
+
+    bytes():
+        m_size(0), m_overflow(false) {}
+
+    void append(const void* data, const size_t size) {
+        if (m_size + size > capacity) {
+            m_overflow = true;
+            return;
+        }
+        std::memcpy(m_data + m_size, data, size);
+        m_size += size;
+    }
+
+    void append_varint(uint64_t value) {
+        char encoded[10];
+        size_t size = 0;
+        do {
+            encoded[size++] = char((value & 0x7f) | (value > 0x7f ? 0x80 : 0));
+            value >>= 7;
+        } while (value);
+        append(encoded, size);
+    }
+
+    void append_tag(const argument tag) {
+        append(&tag, 1);
+    }
+
+    const char* data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    // too many arguments to keep, nothing past capacity was stored
+    bool overflow() const {
+        return m_overflow;
+    }
+
+private:
+    char   m_data[capacity];
+    size_t m_size;
+    bool   m_overflow;
+};
+
+// reads what bytes wrote, every read fails once the input runs out
+class reader {
+
+public:
+    reader(const char* data, const size_t size):
+        m_data(data), m_end(data + size) {}
+
+    bool read(void* target, const size_t size) {
+        if (size_t(m_end - m_data) < size) {
+            return false;
+        }
+        std::memcpy(target, m_data, size);
+        m_data += size;
+        return true;
+    }
+
+    bool read_varint(uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; shift < 64 && m_data < m_end; shift += 7) {
+            const uint8_t byte = uint8_t(*m_data++);
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char* position() const {
+        return m_data;
+    }
+
+    size_t remaining() const {
+        return size_t(m_end - m_data);
+    }
+
+    bool skip(const size_t size) {
+        if (remaining() < size) {
+            return false;
+        }
+        m_data += size;
+        return true;
+    }
+
+private:
+    const char* m_data;
+    const char* m_end;
+};
+
+// arguments, stored by encode() and rendered by append_argument()
+
+template <typename value_type>
+std::enable_if_t<std::is_integral<value_type>::value && std::is_signed<value_type>::value> encode(bytes& target, const value_type value) {
+    const int64_t wide = value;
+    target.append_tag(argument::signed_integer);
+    // zigzag, small negative numbers stay short
+    target.append_varint((uint64_t(wide) << 1) ^ uint64_t(wide >> 63));
+}
+
+template <typename value_type>
+std::enable_if_t<std::is_integral<value_type>::value && !std::is_signed<value_type>::value> encode(bytes& target, const value_type value) {
+    target.append_tag(argument::unsigned_integer);
+    target.append_varint(value);
+}
+
+inline void encode(bytes& target, const float value) {
+    target.append_tag(argument::float32);
+    target.append(&value, sizeof(value));
+}
+
+inline void encode(bytes& target, const double value) {
+    target.append_tag(argument::float64);
+    target.append(&value, sizeof(value));
+}
+
+inline void encode_string(bytes& target, const char* text, const size_t size) {
+    target.append_tag(argument::string);
+    target.append_varint(size);
+    target.append(text, size);
+}
+
+inline void encode(bytes& target, const char* text) {
+    encode_string(target, text, std::strlen(text));
+}
+
+inline void encode(bytes& target, const std::string& text) {
+    encode_string(target, text.data(), text.size());
+}
+
+inline void encode(bytes& target, const char character) {
+    encode_string(target, &character, 1);
+}
+
+inline void encode(bytes& target, const gl_enum value) {
+    target.append_tag(argument::gl_enumeration);
+    target.append_varint(value.value);
+}
+
+template <typename value_type>
+auto append_argument(std::string& out, const value_type value) -> decltype(to_text(nullptr, nullptr, value), void()) {
+    char text[max_number_size];
+    out.append(text, to_text(text, text + sizeof(text), value));
+}
+
+inline void append_argument(std::string& out, const char* text) {
+    out.append(text);
+}
+
+inline void append_argument(std::string& out, const std::string& text) {
+    out.append(text);
+}
+
+// copies format up to the next placeholder and returns what follows it, or
+// copies the rest and returns nullptr
+inline const char* copy_to_placeholder(const char* format, std::string& out) {
+    const char* placeholder = std::strstr(format, "{}");
+    if (!placeholder) {
+        out.append(format);
+        return nullptr;
+    }
+    out.append(format, placeholder);
+    return placeholder + 2;
+}
+
+// the text of a message, surplus arguments are left out and surplus
+// placeholders kept
+template <typename... argument_types>
+void render(const char* format, std::string& out, const argument_types&... arguments) {
+    const auto next = [&format, &out](const auto& value) {
+        if (format && (format = copy_to_placeholder(format, out))) {
+            append_argument(out, value);
+        }
+    };
+    (void)next;
+    (next(arguments), ...);
+    if (format) {
+        out.append(format);
+    }
+}
+
+// the same from encoded arguments, false when they are malformed
+inline bool render_encoded(const char* format, reader& arguments, std::string& out) {
+    while (arguments.remaining()) {
+        const bool shown = format && (format = copy_to_placeholder(format, out));
+        argument tag;
+        uint64_t value;
+        if (!arguments.read(&tag, 1)) {
+            return false;
+        }
+        switch (tag) {
+            case argument::signed_integer:
+                if (!arguments.read_varint(value)) {
+                    return false;
+                }
+                if (shown) {
+                    append_argument(out, int64_t(value >> 1) ^ -int64_t(value & 1));
+                }
+                break;
+            case argument::unsigned_integer:
+                if (!arguments.read_varint(value)) {
+                    return false;
+                }
+                if (shown) {
+                    append_argument(out, value);
+                }
+                break;
+            case argument::float32: {
+                float number;
+                if (!arguments.read(&number, sizeof(number))) {
+                    return false;
+                }
+                if (shown) {
+                    append_argument(out, number);
+                }
+                break;
+            }
+            case argument::float64: {
+                double number;
+                if (!arguments.read(&number, sizeof(number))) {
+                    return false;
+                }
+                if (shown) {
+                    append_argument(out, number);
+                }
+                break;
+            }
+            case argument::gl_enumeration:
+                if (!arguments.read_varint(value)) {
+                    return false;
+                }
+                if (shown) {
+                    append_argument(out, gl_enum{unsigned(value)});
+                }
+                break;
+            case argument::string:
+                if (!arguments.read_varint(value) || arguments.remaining() < value) {
+                    return false;
+                }
+                if (shown) {
+                    out.append(arguments.position(), size_t(value));
+                }
+                arguments.skip(size_t(value));
+                break;
+            default:
+                return false;
+        }
+    }
+    if (format) {
+        out.append(format);
+    }
+    return true;
+}
+
+inline void append_record(std::string& out, const uint32_t id, const char* payload, const size_t size) {
+    bytes header;
+    header.append_varint(id);
+    header.append_varint(size);
+    out.append(header.data(), header.size());
+    out.append(payload, size);
+}
+
+inline void append_definition(std::string& out, const log_format& format) {
+    bytes id;
+    id.append_varint(format.id());
+    const size_t length = std::strlen(format.text());
+    bytes header;
+    header.append_varint(format_record);
+    header.append_varint(id.size() + length);
+    out.append(header.data(), header.size());
+    out.append(id.data(), id.size());
+    out.append(format.text(), length);
+}
+
+// 1 when a varint was read, 0 at the end of the input, -1 when it ends inside one
+inline int read_varint(std::istream& in, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        const int byte = in.get();
+        if (byte == std::char_traits<char>::eof()) {
+            return shift ? -1 : 0;
+        }
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return 1;
+        }
+    }
+    return -1;
+}
+
+// renders a binary log as the text logger would have written it, false if the
+// input is not a binary log or ends in the middle of a record
+inline bool decode(std::istream& in, std::ostream& out) {
+    char header[sizeof(magic)];
+    if (!in.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic))) {
+        return false;
+    }
+    std::unordered_map<uint64_t, std::string> formats;
+    std::string payload, text;
+    while (true) {
+        uint64_t id, size;
+        const int read = read_varint(in, id);
+        if (read <= 0) {
+            return !read;
+        }
+        if (read_varint(in, size) <= 0) {
+            return false;
+        }
+        // the size is not trusted, the payload grows only as far as the input reaches
+        payload.clear();
+        for (uint64_t left = size; left;) {
+            const size_t chunk = size_t(std::min<uint64_t>(left, 1 << 16)), offset = payload.size();
+            payload.resize(offset + chunk);
+            if (!in.read(&payload[offset], std::streamsize(chunk))) {
+                return false;
+            }
+            left -= chunk;
+        }
+        reader record(payload.data(), payload.size());
+        if (id == text_record) {
+            out.write(payload.data(), std::streamsize(payload.size()));
+        } else if (id == format_record) {
+            uint64_t defined;
+            if (!record.read_varint(defined)) {
+                return false;
+            }
+            formats[defined].assign(record.position(), record.remaining());
+        } else {
+            const auto format = formats.find(id);
+            text.clear();
+            if (format == formats.end() || !render_encoded(format->second.c_str(), record, text)) {
+                return false;
+            }
+            out.write(text.data(), std::streamsize(text.size()));
+        }
+    }
+}
+
+} // ns binary_log
+
+inline uint32_t log_format::next_id() {
+    static std::atomic<uint32_t> next(binary_log::first_format);
+    return next.fetch_add(1);
+}
+
+} // ns common
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// outputs of a logger. Log sinks receive the log in its output format, text or
+// binary, mirror sinks receive its text while mirroring is on. The logger
+// serializes writes to its sinks
+
+namespace common {
+
+class file_sink {
+    public:
+
+    static constexpr bool mirror = false;
+
+    void open(const char* filename, const bool binary) {
+        m_file.open(filename, binary ? std::ios::out | std::ios::binary : std::ios::out);
+    }
+
+    void write(const char* data, const size_t size) {
+        if (m_file.is_open()) {
+            m_file.write(data, size);
+        }
+    }
+
+    void flush() {
+        if (m_file.is_open()) {
+            m_file.flush();
+        }
+    }
+
+    private:
+
+    std::ofstream m_file;
+};
+
+class stderr_sink {
+    public:
+
+    static constexpr bool mirror = true;
+
+    void open(const char*, const bool) {}
+
+    void write(const char* data, const size_t size) {
+        std::cerr.write(data, size);
+    }
+
+    void flush() {
+        std::cerr.flush();
+    }
+};
+
+// the last capacity bytes of the log, e.g. for an in-game console or to attach
+// to a crash report
+template <size_t capacity = 64 * 1024>
+class memory_sink {
+    public:
+
+    static constexpr bool mirror = false;
+
+    memory_sink():
+        m_data(new char[capacity]), m_written(0) {}
+
+    void open(const char*, const bool) {}
+
+    void write(const char* data, size_t size) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_written += size;
+        if (size > capacity) {
+            data += size - capacity;
+            size = capacity;
+        }
+        const size_t start = (m_written - size) % capacity;
+        const size_t first = std::min(size, capacity - start);
+        std::memcpy(m_data.get() + start, data, first);
+        std::memcpy(m_data.get(), data + first, size - first);
+    }
+
+    void flush() {}
+
+    // oldest first, may begin in the middle of a line
+    std::string text() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t size = std::min(m_written, capacity);
+        const size_t start = (m_written - size) % capacity;
+        std::string text(m_data.get() + start, std::min(size, capacity - start));
+        text.append(m_data.get(), size - text.size());
+        return text;
+    }
+
+    // including what has been overwritten since
+    size_t written() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_written;
+    }
+
+    private:
+
+    mutable std::mutex      m_mutex;
+    std::unique_ptr<char[]> m_data;
+    size_t                  m_written;
+};
+
+// discards everything, a logger with null sinks only formats nothing either
+class null_sink {
+    public:
+
+    static constexpr bool mirror = false;
+
+    void open(const char*, const bool) {}
+
+    void write(const char*, const size_t) {}
+
+    void flush() {}
+};
+
+} // ns common
@@ -1,50 +1,319 @@
 #pragma once
 
-#include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "log_format.hpp"
+#include "log_sink.hpp"
+#include "matrix.hpp"
+#include "record_ring.hpp"
+
+// any thread may log. operator<< only copies the text into a buffer of the calling
+// thread, finished lines are written whole: by the calling thread under a lock in
+// the synchronous mode, in the asynchronous mode they go into a record_ring and a
+// writer thread empties the ring in batches into the sinks. Records are never lost
+// unless the overflow policy drops them, ~basic_logger() writes everything logged
+// before it returns
 
 namespace common {
 
-class logger {
+// in increasing severity
+enum class log_level {
+    debug,
+    notice,
+    warning,
+    error,
+    // as a minimum level, disables every level
+    off
+};
+
+// debug lines are compiled into debug builds only
+#ifdef NDEBUG
+constexpr log_level default_log_level = log_level::notice;
+#else
+constexpr log_level default_log_level = log_level::debug;
+#endif
+
+// what at() returns for levels below the minimum, whatever it is given is dropped
+// without being formatted
+struct disabled_log {
+    template <typename value_type>
+    constexpr const disabled_log& operator<<(const value_type&) const {
+        return *this;
+    }
+
+    template <typename... argument_types>
+    constexpr void record(const log_format&, const argument_types&...) const {}
+};
+
+// a small number per thread for the staging buffers and the stamps of the loggers,
+// lowest first and reused once a thread exits. So there are never more buffers or
+// lines pending in a writer than threads logging at the same time
+class log_thread {
+    public:
+
+    static constexpr size_t none = size_t(-1);
+
+    struct slot {
+        size_t   index;
+        // differs for every thread that is handed an index
+        uint64_t serial;
+    };
+
+    static const slot& current() {
+        slot& value = assigned();
+        if (value.index == none) {
+            acquire(value);
+        }
+        return value;
+    }
+
+    static size_t index() {
+        return current().index;
+    }
+
+    private:
+
+    struct registry {
+        std::mutex          mutex;
+        // a min-heap
+        std::vector<size_t> released;
+        size_t              next_index = 0;
+        uint64_t            next_serial = 1;
+    };
+
+    // gives the index back when the thread exits
+    struct releaser {
+        ~releaser() {
+            registry& shared = threads();
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            shared.released.push_back(assigned().index);
+            std::push_heap(shared.released.begin(), shared.released.end(), std::greater<size_t>());
+            assigned().index = none;
+        }
+    };
+
+    static registry& threads() {
+        static registry shared;
+        return shared;
+    }
+
+    // trivially destructible, a logger destroyed after the thread_local objects of
+    // its thread still reads it and takes a new index
+    static slot& assigned() {
+        static thread_local slot value = {none, 0};
+        return value;
+    }
+
+    // once per thread, kept out of current() so that it stays small
+    static void acquire(slot& value) {
+        {
+            registry& shared = threads();
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            if (shared.released.empty()) {
+                value.index = shared.next_index++;
+            } else {
+                std::pop_heap(shared.released.begin(), shared.released.end(), std::greater<size_t>());
+                value.index = shared.released.back();
+                shared.released.pop_back();
+            }
+            value.serial = shared.next_serial++;
+        }
+        static thread_local releaser release;
+        (void)release;
+    }
+};
+
+// lines at a level below minimum_level compile to nothing when the level is known
+// at compile time, through at() or enabled()
+template <log_level minimum_level, typename... sink_types>
+class basic_logger {
     public:
 
-    enum class message_type {
-        error,
-        warning,
-        notice
+    using message_type = log_level;
+
+    // what a producer does when the ring is full
+    enum class overflow_policy {
+        // waits for the writer
+        block,
+        // discards what does not fit
+        drop,
+        // discards what does not fit and logs how many records were lost
+        count_drops
+    };
+
+    // binary logs keep the arguments of record() unformatted, tools/log_decode
+    // renders them as text later
+    enum class output_format {
+        text,
+        binary
+    };
+
+    struct async_options {
+        // in records of up to record_ring::payload_size bytes, longer texts take several
+        size_t          capacity;
+        overflow_policy overflow;
     };
 
-    explicit logger(const char *build_version, const bool mirror = false, const char* filename = "default.log"):
-        m_warnings_count(0), m_errors_count(0), m_mirrored(mirror) {
-        m_file.open(filename);
+    explicit basic_logger(const char *build_version, const bool mirror = false, const char* filename = "default.log", const output_format format = output_format::text):
+        m_warnings_count(0), m_errors_count(0), m_mirrored(mirror), m_stamped(false), m_binary(format == output_format::binary),
+        m_start(std::chrono::steady_clock::now()), m_staging(new std::atomic<staging*>[staging_chunks]()),
+        m_overflow(overflow_policy::block), m_dropped(0), m_reported(0), m_written(0), m_stop(false), m_closing(false) {
+        open(filename);
+
+        message(std::string("[INFO] starting build version '") + build_version + "'...\n");
+    }
+
+    basic_logger(const char *build_version, const async_options& async, const bool mirror = false, const char* filename = "default.log", const output_format format = output_format::text):
+        m_warnings_count(0), m_errors_count(0), m_mirrored(mirror), m_stamped(false), m_binary(format == output_format::binary),
+        m_start(std::chrono::steady_clock::now()), m_staging(new std::atomic<staging*>[staging_chunks]()),
+        m_ring(new record_ring(async.capacity)), m_overflow(async.overflow), m_dropped(0), m_reported(0), m_written(0), m_stop(false), m_closing(false) {
+        open(filename);
+        m_writer = std::thread(&basic_logger::write_records, this);
 
         message(std::string("[INFO] starting build version '") + build_version + "'...\n");
     }
 
-    ~logger() {
+    ~basic_logger() {
+        m_closing = true;
         message("[INFO] shutting down...\n");
-        message(std::to_string(m_warnings_count) + " warnings\n");
-        message(std::to_string(m_errors_count) + " errors\n");
+        message(std::to_string(warnings()) + " warnings\n");
+        message(std::to_string(errors()) + " errors\n");
+
+        // unfinished lines of threads that are done logging
+        if (!m_ring) {
+            std::lock_guard<std::mutex> lock(m_sinks_mutex);
+            for_each_staging([this](staging& line) {
+                write_staged(line);
+            });
+        } else {
+            for_each_staging([this](staging& line) {
+                if (line.size) {
+                    push_staged(line, false);
+                }
+            });
+            {
+                std::lock_guard<std::mutex> lock(m_wake_mutex);
+                m_stop.store(true);
+            }
+            m_wake.notify_one();
+            m_writer.join();
+        }
+        for (size_t chunk = 0; chunk < staging_chunks; chunk++) {
+            delete[] m_staging[chunk].load(std::memory_order_relaxed);
+        }
+    }
+
+    // whether lines at level are logged at all, for if constexpr around code that
+    // only gathers what such lines show
+    static constexpr bool enabled(const log_level level) {
+        return level >= minimum_level && has_output;
+    }
 
-        if (m_file.is_open()) {
-            m_file.close();
+    // starts a line at a level known at compile time, below the minimum level
+    // the line is dropped without being formatted
+    template <log_level level>
+    decltype(auto) at() {
+        if constexpr (enabled(level)) {
+            *this << level;
+            return *this;
+        } else {
+            return disabled_log();
         }
     }
 
+    template <typename sink_type>
+    sink_type& sink() {
+        return std::get<sink_type>(m_sinks);
+    }
+
+    unsigned int warnings() const {
+        return m_warnings_count.load(std::memory_order_relaxed);
+    }
+
+    unsigned int errors() const {
+        return m_errors_count.load(std::memory_order_relaxed);
+    }
+
     void toggle_mirroring() {
         m_mirrored = !m_mirrored;
     }
 
-    friend logger& operator<<(logger& log, const message_type type) {
+    // starts the lines of every thread with the time since the logger started and
+    // the thread's index. Lines of a thread keep their order, those of different
+    // threads are in the order they were finished
+    void stamp_lines(const bool stamped) {
+        m_stamped = stamped;
+    }
+
+    // returns once every line finished so far is in the sinks
+    void flush() {
+        if (m_ring) {
+            const size_t target = m_ring->pushed();
+            while (m_written.load(std::memory_order_acquire) < target) {
+                wake_writer();
+                std::this_thread::yield();
+            }
+        }
+        std::lock_guard<std::mutex> lock(m_sinks_mutex);
+        for_each_sink([](auto& sink) {
+            sink.flush();
+        });
+    }
+
+    // records discarded by the overflow policy
+    size_t dropped() const {
+        return m_ring ? m_dropped.load(std::memory_order_relaxed) : 0;
+    }
+
+    // a message with deferred formatting, each {} of the format shows the next
+    // argument. Text logs render it right away, binary logs store the format's id
+    // and the raw arguments
+    template <typename... argument_types>
+    void record(const log_format& format, const argument_types&... arguments) {
+        if constexpr (!has_output) {
+            return;
+        }
+        if (m_binary) {
+            binary_log::bytes payload;
+            const log_format* pointer = &format;
+            payload.append(&pointer, sizeof(pointer));
+            (binary_log::encode(payload, arguments), ...);
+            // too large for a record, the text is stored instead
+            if (!payload.overflow() && (!m_ring || payload.size() <= record_ring::payload_size)) {
+                formatted(payload.data(), payload.size(), format.ends_line());
+                return;
+            }
+        }
+        static thread_local std::string text;
+        text.clear();
+        binary_log::render(format.text(), text, arguments...);
+        message(text.data(), text.size());
+    }
+
+    friend basic_logger& operator<<(basic_logger& log, const message_type type) {
         switch (type) {
-            case logger::message_type::error:
+            case message_type::error:
                 log.message("[ERROR] ");
-                ++log.m_errors_count;
+                log.m_errors_count.fetch_add(1, std::memory_order_relaxed);
                 break;
-            case logger::message_type::warning:
+            case message_type::warning:
                 log.message("[WARNING] ");
-                ++log.m_warnings_count;
+                log.m_warnings_count.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case message_type::debug:
+                log.message("[DEBUG] ");
                 break;
             default:
                 log.message("[NOTICE] ");
@@ -53,44 +322,491 @@ class logger {
         return log;
     }
 
-    friend logger& operator<<(logger& log, const char* text) {
+    friend basic_logger& operator<<(basic_logger& log, const char* text) {
         log.message(text);
         return log;
     }
 
-    friend logger& operator<<(logger& log, const unsigned char* text) {
+    friend basic_logger& operator<<(basic_logger& log, const unsigned char* text) {
         log.message(reinterpret_cast<const char*>(text));
         return log;
     }
 
-    friend logger& operator<<(logger& log, const std::string& text) {
-        log.message(text.c_str());
+    friend basic_logger& operator<<(basic_logger& log, const std::string& text) {
+        log.message(text.data(), text.size());
+        return log;
+    }
+
+    // numbers and gl_enum are written into a buffer on the stack, nothing is allocated
+    template <typename value_type>
+    friend auto operator<<(basic_logger& log, const value_type value) -> decltype(to_text(nullptr, nullptr, value), log) {
+        char text[max_number_size];
+        log.message(text, size_t(to_text(text, text + sizeof(text), value) - text));
+        return log;
+    }
+
+    // as "(x, y, z)" like std::ostream
+    template <typename value_type, size_t size>
+    friend basic_logger& operator<<(basic_logger& log, const vector::vector<value_type, size>& value) {
+        log.elements<size>('(', ')', [&value](const size_t i) { return value.data()[i]; });
+        return log;
+    }
+
+    // as "[m00, m01, ...]" like std::ostream, in storage order
+    template <size_t dimensions, typename value_type, math::storage_order order>
+    friend basic_logger& operator<<(basic_logger& log, const math::matrix<dimensions, value_type, order>& value) {
+        log.elements<dimensions * dimensions>('[', ']', [&value](const size_t i) { return value.container().at(i); });
         return log;
     }
 
-    logger(const logger&) = delete;
-    logger& operator=(const logger&) = delete;
+    basic_logger(const basic_logger&) = delete;
+    basic_logger& operator=(const basic_logger&) = delete;
 
     private:
 
+    static constexpr bool has_output = !(std::is_same<sink_types, null_sink>::value && ...);
+    static constexpr bool has_mirror = (sink_types::mirror || ...);
+
+    enum : uint32_t {
+        mirrored_record  = 1 << 0,
+        // a log_format pointer and encoded arguments, binary logs only
+        formatted_record = 1 << 1,
+        // the line goes on in a later record of the same thread
+        partial_record   = 1 << 2,
+        // the rest of a tag is the index of the thread that pushed the record
+        thread_shift     = 8
+    };
+
+    // how long the idle writer sleeps unless a producer or flush() wakes it
+    static constexpr std::chrono::milliseconds writer_idle{2};
+    // staging buffers are allocated in chunks as thread indices grow, threads
+    // beyond them log every text on its own and without stamps
+    static constexpr size_t staging_chunk_size = 64;
+    static constexpr size_t staging_chunks = 1024;
+
+    struct alignas(64) staging {
+        size_t      size;
+        uint32_t    tag;
+        // log_thread::slot::serial of the thread the buffer belongs to
+        uint64_t    owner;
+        // the line began in an earlier record
+        bool        continued;
+        char        data[record_ring::payload_size];
+        // synchronous mode, the beginning of a line longer than data
+        std::string long_line;
+    };
+
+    // lines not finished yet, by thread, asynchronous writer only
+    struct pending_line {
+        std::string text;
+        std::string mirror;
+    };
+
     void message(const char* text) {
-        if (m_mirrored) {
-            std::cerr << text;
+        message(text, std::char_traits<char>::length(text));
+    }
+
+    void message(const std::string& text) {
+        message(text.data(), text.size());
+    }
+
+    template <size_t count, typename element_type>
+    void elements(const char open, const char close, const element_type& element) {
+        char text[count * (max_number_size + 2) + 2];
+        char* end = text;
+        *end++ = open;
+        for (size_t i = 0; i < count; i++) {
+            if (i) {
+                *end++ = ',';
+                *end++ = ' ';
+            }
+            end = to_text(end, end + max_number_size, element(i));
         }
-        if (m_file.is_open()) {
-            m_file << text;
+        *end++ = close;
+        message(text, size_t(end - text));
+    }
+
+    template <typename function_type>
+    void for_each_sink(function_type&& function) {
+        std::apply([&function](auto&... sinks) {
+            (function(sinks), ...);
+        }, m_sinks);
+    }
+
+    // the log to the log sinks, its text to the mirror sinks
+    void deliver(const char* log, const size_t log_size, const char* mirror, const size_t mirror_size) {
+        for_each_sink([=](auto& sink) {
+            if constexpr (std::decay_t<decltype(sink)>::mirror) {
+                if (mirror_size) {
+                    sink.write(mirror, mirror_size);
+                }
+            } else if (log_size) {
+                sink.write(log, log_size);
+            }
+        });
+    }
+
+    void open(const char* filename) {
+        for_each_sink([filename, this](auto& sink) {
+            sink.open(filename, m_binary);
+        });
+        if (m_binary) {
+            deliver(binary_log::magic, sizeof(binary_log::magic), nullptr, 0);
         }
     }
 
-    void message(const std::string& text) {
-        message(text.c_str());
+    // whether mirror sinks get what is logged now
+    bool mirrored() const {
+        return has_mirror && m_mirrored.load(std::memory_order_relaxed);
+    }
+
+    uint32_t tag(const log_thread::slot& thread) const {
+        return (mirrored() ? uint32_t(mirrored_record) : 0) | uint32_t(thread.index << thread_shift);
+    }
+
+    // text is collected per thread until a line ends and then logged at once, so
+    // lines of different threads never mix. The asynchronous mode pushes longer
+    // lines in several partial records and the writer puts them back together,
+    // the synchronous mode keeps them in long_line
+    void message(const char* text, const size_t size) {
+        if constexpr (!has_output) {
+            return;
+        }
+        const log_thread::slot& thread = log_thread::current();
+        const uint32_t tag = this->tag(thread);
+        const bool finished = size && text[size - 1] == '\n';
+        staging* line = staged(thread);
+        if (!line) {
+            dispatch(nullptr, text, size, finished ? tag : tag | partial_record);
+            return;
+        }
+        begin_line(*line, tag);
+        if (line->size && (line->tag != tag || line->size + size > record_ring::payload_size)) {
+            push_staged(*line, false);
+        }
+        if (size > record_ring::payload_size) {
+            dispatch(line, text, size, finished ? tag : tag | partial_record);
+            return;
+        }
+        std::memcpy(line->data + line->size, text, size);
+        line->size += size;
+        line->tag = tag;
+        if (finished) {
+            push_staged(*line, true);
+        }
+    }
+
+    // payload of a formatted_record, finished if the format ends a line
+    void formatted(const char* payload, const size_t size, const bool finished) {
+        const log_thread::slot& thread = log_thread::current();
+        const uint32_t tag = this->tag(thread) | formatted_record;
+        staging* line = staged(thread);
+        if (line) {
+            begin_line(*line, tag & ~formatted_record);
+        }
+        if (!m_ring) {
+            std::lock_guard<std::mutex> lock(m_sinks_mutex);
+            if (line) {
+                write_staged(*line);
+                line->continued = !finished;
+            }
+            write(payload, size, tag);
+            return;
+        }
+        // after the start of the line this thread logged as text
+        if (line && line->size) {
+            push_staged(*line, false);
+        }
+        push(payload, size, finished ? tag : tag | partial_record);
+        if (line) {
+            line->continued = !finished;
+        }
     }
 
-    std::ofstream m_file;
+    // a new line of a thread starts with its stamp if lines are stamped
+    void begin_line(staging& line, const uint32_t tag) {
+        if (line.size || line.continued || !m_stamped.load(std::memory_order_relaxed)) {
+            return;
+        }
+        // "[seconds.microseconds #thread] " since the logger started
+        const uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+        char* end = line.data;
+        *end++ = '[';
+        end = to_text(end, end + max_number_size, elapsed / 1000000);
+        *end++ = '.';
+        for (uint64_t digit = 100000; digit; digit /= 10) {
+            *end++ = char('0' + elapsed / digit % 10);
+        }
+        *end++ = ' ';
+        *end++ = '#';
+        end = to_text(end, end + max_number_size, log_thread::index());
+        *end++ = ']';
+        *end++ = ' ';
+        line.size = size_t(end - line.data);
+        line.tag = tag;
+    }
+
+    void push_staged(staging& line, const bool finished) {
+        dispatch(&line, line.data, line.size, finished ? line.tag : line.tag | partial_record);
+        line.size = 0;
+    }
 
-    unsigned int  m_warnings_count;
-    unsigned int  m_errors_count;
-    bool          m_mirrored;
+    // a text of the calling thread: a record in the asynchronous mode, written with
+    // the beginning of its line once the line is finished in the synchronous mode
+    void dispatch(staging* line, const char* text, const size_t size, const uint32_t tag) {
+        if (line) {
+            line->continued = tag & partial_record;
+        }
+        if (m_ring) {
+            push(text, size, tag);
+            return;
+        }
+        if (line && (tag & partial_record)) {
+            line->long_line.append(text, size);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_sinks_mutex);
+        if (line && !line->long_line.empty()) {
+            write(line->long_line.data(), line->long_line.size(), tag);
+            line->long_line.clear();
+        }
+        write(text, size, tag);
+    }
+
+    // synchronous mode, whatever the thread staged, with m_sinks_mutex held
+    void write_staged(staging& line) {
+        if (!line.long_line.empty()) {
+            write(line.long_line.data(), line.long_line.size(), line.tag);
+            line.long_line.clear();
+        }
+        if (line.size) {
+            write(line.data, line.size, line.tag);
+            line.size = 0;
+        }
+    }
+
+    // synchronous mode, with m_sinks_mutex held
+    void write(const char* data, const size_t size, const uint32_t tag) {
+        const bool mirror = tag & mirrored_record;
+        if (!m_binary) {
+            deliver(data, size, data, mirror ? size : 0);
+            return;
+        }
+        static thread_local std::string out, text;
+        out.clear();
+        text.clear();
+        convert(out, out, mirror ? &text : nullptr, data, size, tag & formatted_record);
+        deliver(out.data(), out.size(), text.data(), text.size());
+    }
+
+    // appends a text or formatted record as it goes into the file, and its text
+    // to mirror if given. A format is defined in definitions ahead of its first use
+    void convert(std::string& definitions, std::string& out, std::string* mirror, const char* data, size_t size, const bool formatted) {
+        if (!formatted) {
+            if (m_binary) {
+                binary_log::append_record(out, binary_log::text_record, data, size);
+            } else {
+                out.append(data, size);
+            }
+            if (mirror) {
+                mirror->append(data, size);
+            }
+            return;
+        }
+        const log_format* format;
+        std::memcpy(&format, data, sizeof(format));
+        data += sizeof(format);
+        size -= sizeof(format);
+        if (format->id() >= m_defined.size()) {
+            m_defined.resize(format->id() + 1, false);
+        }
+        if (!m_defined[format->id()]) {
+            binary_log::append_definition(definitions, *format);
+            m_defined[format->id()] = true;
+        }
+        binary_log::append_record(out, format->id(), data, size);
+        if (mirror) {
+            binary_log::reader arguments(data, size);
+            binary_log::render_encoded(format->text(), arguments, *mirror);
+        }
+    }
+
+    // the calling thread's buffer, none for indices beyond the staging chunks. What
+    // an exited thread with the same index left in it is finished first
+    staging* staged(const log_thread::slot& thread) {
+        if (thread.index >= staging_chunks * staging_chunk_size) {
+            return nullptr;
+        }
+        staging* lines = m_staging[thread.index / staging_chunk_size].load(std::memory_order_acquire);
+        if (!lines) {
+            lines = allocate_staging(thread.index / staging_chunk_size);
+        }
+        staging& line = lines[thread.index % staging_chunk_size];
+        if (line.owner != thread.serial) {
+            retire(line, thread);
+        }
+        return &line;
+    }
+
+    staging* allocate_staging(const size_t chunk) {
+        staging* lines = nullptr;
+        staging* allocated = new staging[staging_chunk_size]();
+        if (m_staging[chunk].compare_exchange_strong(lines, allocated, std::memory_order_acq_rel)) {
+            return allocated;
+        }
+        delete[] allocated;
+        return lines;
+    }
+
+    // the unfinished line of an exited thread ends where it is
+    void retire(staging& line, const log_thread::slot& thread) {
+        if (!m_ring) {
+            std::lock_guard<std::mutex> lock(m_sinks_mutex);
+            write_staged(line);
+        } else if (line.size || line.continued) {
+            dispatch(&line, line.data, line.size, line.size ? line.tag : uint32_t(thread.index << thread_shift));
+            line.size = 0;
+        }
+        line.continued = false;
+        line.owner = thread.serial;
+    }
+
+    template <typename function_type>
+    void for_each_staging(const function_type& function) {
+        for (size_t chunk = 0; chunk < staging_chunks; chunk++) {
+            if (staging* lines = m_staging[chunk].load(std::memory_order_acquire)) {
+                for (size_t index = 0; index < staging_chunk_size; index++) {
+                    function(lines[index]);
+                }
+            }
+        }
+    }
+
+    // longer texts take several records, all partial but the last. An empty text
+    // is one empty record, it still ends the line of its thread
+    void push(const char* text, size_t size, const uint32_t tag) {
+        do {
+            const size_t part = std::min(size, record_ring::payload_size);
+            const uint32_t part_tag = part < size ? tag | partial_record : tag;
+            size_t position;
+            while (!m_ring->try_push(text, part, part_tag, &position)) {
+                // the closing summary is never dropped
+                if (m_overflow != overflow_policy::block && !m_closing) {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                wake_writer();
+                std::this_thread::yield();
+            }
+            // the writer polls while busy, a quarter of the ring filled up while it slept
+            if (!(position & (m_ring->capacity() / 4 - 1))) {
+                wake_writer();
+            }
+            text += part;
+            size -= part;
+        } while (size);
+    }
+
+    void wake_writer() {
+        {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+        }
+        m_wake.notify_one();
+    }
+
+    void write_records() {
+        std::string text, mirror;
+        std::vector<pending_line> pending;
+        // drop reports follow the mirroring of the records around them
+        uint32_t last_tag = 0;
+        while (true) {
+            // records pushed before stop are visible to the drain below
+            const bool stopping = m_stop.load();
+            text.clear();
+            mirror.clear();
+            const size_t count = m_ring->consume([this, &text, &mirror, &pending, &last_tag](const char* data, const size_t size, const uint32_t tag) {
+                const size_t thread = tag >> thread_shift;
+                if (thread >= pending.size()) {
+                    pending.resize(thread + 1);
+                }
+                pending_line& line = pending[thread];
+                const bool formatted = tag & formatted_record;
+                if (line.text.empty() && !(tag & partial_record)) {
+                    convert(text, text, (tag & mirrored_record) ? &mirror : nullptr, data, size, formatted);
+                } else {
+                    convert(text, line.text, (tag & mirrored_record) ? &line.mirror : nullptr, data, size, formatted);
+                    if (!(tag & partial_record)) {
+                        text += line.text;
+                        mirror += line.mirror;
+                        line.text.clear();
+                        line.mirror.clear();
+                    }
+                }
+                last_tag = tag;
+            });
+            const size_t dropped = m_dropped.load(std::memory_order_relaxed);
+            if (m_overflow == overflow_policy::count_drops && dropped != m_reported) {
+                const std::string report = "[WARNING] " + std::to_string(dropped - m_reported) + " log records dropped\n";
+                convert(text, text, (last_tag & mirrored_record) ? &mirror : nullptr, report.data(), report.size(), false);
+                m_reported = dropped;
+            }
+            if (stopping && !count) {
+                // lines left unfinished by threads that are done logging
+                for (pending_line& line : pending) {
+                    text += line.text;
+                    mirror += line.mirror;
+                }
+                pending.clear();
+            }
+            std::unique_lock<std::mutex> sinks_lock(m_sinks_mutex);
+            deliver(text.data(), text.size(), mirror.data(), mirror.size());
+            if (count) {
+                m_written.fetch_add(count, std::memory_order_release);
+                continue;
+            }
+            for_each_sink([](auto& sink) {
+                sink.flush();
+            });
+            sinks_lock.unlock();
+            if (stopping) {
+                return;
+            }
+            std::unique_lock<std::mutex> lock(m_wake_mutex);
+            if (!m_stop.load()) {
+                m_wake.wait_for(lock, writer_idle);
+            }
+        }
+    }
+
+    std::tuple<sink_types...> m_sinks;
+
+    std::atomic<unsigned int> m_warnings_count;
+    std::atomic<unsigned int> m_errors_count;
+    std::atomic<bool>         m_mirrored;
+    std::atomic<bool>         m_stamped;
+    bool                      m_binary;
+    const std::chrono::steady_clock::time_point m_start;
+    // formats by id already defined in a binary log
+    std::vector<bool> m_defined;
+    // chunks of staging_chunk_size buffers, by thread index
+    std::unique_ptr<std::atomic<staging*>[]> m_staging;
+
+    // asynchronous mode only
+    std::unique_ptr<record_ring> m_ring;
+    overflow_policy              m_overflow;
+    std::atomic<size_t>          m_dropped;
+    size_t                       m_reported;
+    std::atomic<size_t>          m_written;
+    std::atomic<bool>            m_stop;
+    bool                         m_closing;
+    // writes of the synchronous mode and the writer's batches against flush()
+    std::mutex                   m_sinks_mutex;
+    std::mutex                   m_wake_mutex;
+    std::condition_variable      m_wake;
+    std::thread                  m_writer;
 };
 
+// the log file, mirrored to stderr on request
+using logger = basic_logger<default_log_level, file_sink, stderr_sink>;
+
 } // ns common
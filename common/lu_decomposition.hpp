@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <utility>
+#include "linear_square_array.hpp"
+#include "matrix_error.hpp"
+#include "vector.hpp"
+
+namespace math {
+
+namespace detail {
+
+// in place PA = LU of dimensions x dimensions row-major storage, shared by the fixed
+// and the runtime sized decompositions. Returns false for singular matrices, the
+// remaining columns are still eliminated
+template <typename value_type>
+bool lu_factorize(value_type* lu, const size_t dimensions, size_t* permutation, value_type& sign) {
+    bool regular = true;
+    sign = 1;
+    for (size_t i = 0; i < dimensions; i++) {
+        permutation[i] = i;
+    }
+
+    for (size_t k = 0; k < dimensions; k++) {
+        size_t pivot = k;
+        value_type pivot_value = std::abs(lu[k * dimensions + k]);
+        for (size_t i = k + 1; i < dimensions; i++) {
+            const value_type candidate = std::abs(lu[i * dimensions + k]);
+            if (candidate > pivot_value) {
+                pivot = i;
+                pivot_value = candidate;
+            }
+        }
+
+        if (pivot_value == 0) {
+            regular = false;
+            continue;
+        }
+
+        if (pivot != k) {
+            for (size_t j = 0; j < dimensions; j++) {
+                std::swap(lu[k * dimensions + j], lu[pivot * dimensions + j]);
+            }
+            std::swap(permutation[k], permutation[pivot]);
+            sign = -sign;
+        }
+
+        const value_type* pivot_row = lu + k * dimensions;
+        for (size_t i = k + 1; i < dimensions; i++) {
+            value_type* row = lu + i * dimensions;
+            const value_type factor = row[k] /= pivot_row[k];
+            for (size_t j = k + 1; j < dimensions; j++) {
+                row[j] -= factor * pivot_row[j];
+            }
+        }
+    }
+    return regular;
+}
+
+template <typename value_type>
+void lu_solve(const value_type* lu, const size_t dimensions, const size_t* permutation, const value_type* rhs, value_type* result) {
+    // forward substitution with L
+    for (size_t i = 0; i < dimensions; i++) {
+        value_type sum = rhs[permutation[i]];
+        for (size_t j = 0; j < i; j++) {
+            sum -= lu[i * dimensions + j] * result[j];
+        }
+        result[i] = sum;
+    }
+    // back substitution with U
+    for (size_t i = dimensions; i--;) {
+        value_type sum = result[i];
+        for (size_t j = i + 1; j < dimensions; j++) {
+            sum -= lu[i * dimensions + j] * result[j];
+        }
+        result[i] = sum / lu[i * dimensions + i];
+    }
+}
+
+} // ns detail
+
+// PA = LU factorization with partial pivoting, L has an implicit unit diagonal
+// and shares storage with U
+template <size_t dimensions, typename value_type>
+class lu_decomposition {
+
+public:
+    using container_type = linear_square_array<dimensions, value_type>;
+    using vector_type = vector::vector<value_type, dimensions>;
+    using permutation_type = std::array<size_t, dimensions>;
+
+    explicit lu_decomposition(const container_type& data):
+        m_lu(data), m_permutation{}, m_sign(1),
+        m_singular(!detail::lu_factorize(m_lu.raw(), dimensions, m_permutation.data(), m_sign)) {}
+
+    bool singular() const {
+        return m_singular;
+    }
+
+    value_type determinant() const {
+        if (m_singular) {
+            return 0;
+        }
+        value_type result = m_sign;
+        for (size_t i = 0; i < dimensions; i++) {
+            result *= m_lu.raw()[i * dimensions + i];
+        }
+        return result;
+    }
+
+    const vector_type solve(const vector_type& rhs) const {
+        typename vector_type::data_type data{};
+        solve(rhs.data().data(), data.data());
+        return vector_type{data};
+    }
+
+    const container_type invert() const {
+        container_type result;
+        std::array<value_type, dimensions> unit{};
+        std::array<value_type, dimensions> column;
+
+        for (size_t col = 0; col < dimensions; col++) {
+            unit[col] = 1;
+            solve(unit.data(), column.data());
+            unit[col] = 0;
+            for (size_t row = 0; row < dimensions; row++) {
+                result[{row, col}] = column[row];
+            }
+        }
+        return result;
+    }
+
+    const container_type& container() const {
+        return m_lu;
+    }
+
+    const permutation_type& permutation() const {
+        return m_permutation;
+    }
+
+private:
+
+    void solve(const value_type* rhs, value_type* result) const {
+        if (m_singular) {
+            throw matrix_error("singular matrix system cannot be solved");
+        }
+        detail::lu_solve(m_lu.raw(), dimensions, m_permutation.data(), rhs, result);
+    }
+
+    container_type   m_lu;
+    permutation_type m_permutation;
+    value_type       m_sign;
+    bool             m_singular;
+};
+
+} // ns math
@@ -1,50 +1,225 @@
 #pragma once
 
+#include <cassert>
+#include <cmath>
 #include <math.h>
+#include <type_traits>
+#include <utility>
+#include "cofactors.hpp"
 #include "linear_square_array.hpp"
+#include "lu_decomposition.hpp"
+#include "matrix_error.hpp"
+#include "multiplicator.hpp"
 #include "vector.hpp"
 
 namespace math {
 
-class matrix_error : public std::runtime_error {
-public:
-    matrix_error(const std::string& error):
-        std::runtime_error{error} {}
-};
-
-template <size_t dimensions, typename value_type> class matrix;
+template <size_t dimensions, typename value_type, storage_order order = storage_order::row_major> class matrix;
+template <typename lhs_type, typename rhs_type> class product_expression;
 
 template<size_t dimensions, typename value_type>
 struct determinator {
-    static value_type compute(const matrix<dimensions, value_type>& src) {
-        value_type result = 0;
-        for (size_t i = dimensions; i--;) {
-            result += src.container().at(i) * src.cofactor(0, i);
-        }
-        return result;
+    template <storage_order order>
+    static value_type compute(const matrix<dimensions, value_type, order>& src) {
+        return src.lu().determinant();
     }
 };
 
 template<typename value_type>
 struct determinator<1, value_type> {
-    static value_type compute(const matrix<1, value_type>& src) {
+    template <storage_order order>
+    static value_type compute(const matrix<1, value_type, order>& src) {
         return src.container().at(0);
     }
 };
 
-template <size_t dimensions, typename value_type>
+template<typename value_type>
+struct determinator<2, value_type> {
+    template <storage_order order>
+    static value_type compute(const matrix<2, value_type, order>& src) {
+        const value_type* m = src.container().raw();
+        return m[0] * m[3] - m[1] * m[2];
+    }
+};
+
+template<typename value_type>
+struct determinator<3, value_type> {
+    template <storage_order order>
+    static value_type compute(const matrix<3, value_type, order>& src) {
+        const value_type* m = src.container().raw();
+        return m[0] * (m[4] * m[8] - m[5] * m[7])
+             - m[1] * (m[3] * m[8] - m[5] * m[6])
+             + m[2] * (m[3] * m[7] - m[4] * m[6]);
+    }
+};
+
+// 2x2 minors of the upper (s) and lower (c) row pairs, shared by determinant and inverse
+template<typename value_type>
+struct minors4 {
+    explicit minors4(const value_type* m):
+        s{m[0] * m[5] - m[4] * m[1],
+          m[0] * m[6] - m[4] * m[2],
+          m[0] * m[7] - m[4] * m[3],
+          m[1] * m[6] - m[5] * m[2],
+          m[1] * m[7] - m[5] * m[3],
+          m[2] * m[7] - m[6] * m[3]},
+        c{m[8] * m[13] - m[12] * m[9],
+          m[8] * m[14] - m[12] * m[10],
+          m[8] * m[15] - m[12] * m[11],
+          m[9] * m[14] - m[13] * m[10],
+          m[9] * m[15] - m[13] * m[11],
+          m[10] * m[15] - m[14] * m[11]} {}
+
+    value_type determinant() const {
+        return s[0] * c[5] - s[1] * c[4] + s[2] * c[3] + s[3] * c[2] - s[4] * c[1] + s[5] * c[0];
+    }
+
+    value_type s[6];
+    value_type c[6];
+};
+
+template<typename value_type>
+struct determinator<4, value_type> {
+    template <storage_order order>
+    static value_type compute(const matrix<4, value_type, order>& src) {
+        return minors4<value_type>{src.container().raw()}.determinant();
+    }
+};
+
+// the closed forms work on storage as is, which is fine for both storage orders
+// since the inverse of a transpose is the transpose of the inverse
+template<size_t dimensions, typename value_type>
+struct inverter {
+    template <typename container_type>
+    static container_type compute(const container_type& src) {
+        const lu_decomposition<dimensions, value_type> decomposition{linear_square_array<dimensions, value_type>(src)};
+        if (decomposition.singular()) {
+            throw matrix_error("matrix with determinant == 0 cannot be inverted");
+        }
+        return container_type(decomposition.invert());
+    }
+};
+
+template<typename value_type>
+struct inverter<2, value_type> {
+    template <typename container_type>
+    static container_type compute(const container_type& src) {
+        const value_type* m = src.raw();
+        const value_type det = m[0] * m[3] - m[1] * m[2];
+        if (det == 0) {
+            throw matrix_error("matrix with determinant == 0 cannot be inverted");
+        }
+        const value_type inv = 1 / det;
+        container_type data;
+        value_type* r = data.raw();
+        r[0] = m[3] * inv;
+        r[1] = -m[1] * inv;
+        r[2] = -m[2] * inv;
+        r[3] = m[0] * inv;
+        return data;
+    }
+};
+
+template<typename value_type>
+struct inverter<3, value_type> {
+    template <typename container_type>
+    static container_type compute(const container_type& src) {
+        const value_type* m = src.raw();
+        const value_type c0 = m[4] * m[8] - m[5] * m[7];
+        const value_type c1 = m[5] * m[6] - m[3] * m[8];
+        const value_type c2 = m[3] * m[7] - m[4] * m[6];
+        const value_type det = m[0] * c0 + m[1] * c1 + m[2] * c2;
+        if (det == 0) {
+            throw matrix_error("matrix with determinant == 0 cannot be inverted");
+        }
+        const value_type inv = 1 / det;
+        container_type data;
+        value_type* r = data.raw();
+        r[0] = c0 * inv;
+        r[1] = (m[2] * m[7] - m[1] * m[8]) * inv;
+        r[2] = (m[1] * m[5] - m[2] * m[4]) * inv;
+        r[3] = c1 * inv;
+        r[4] = (m[0] * m[8] - m[2] * m[6]) * inv;
+        r[5] = (m[2] * m[3] - m[0] * m[5]) * inv;
+        r[6] = c2 * inv;
+        r[7] = (m[1] * m[6] - m[0] * m[7]) * inv;
+        r[8] = (m[0] * m[4] - m[1] * m[3]) * inv;
+        return data;
+    }
+};
+
+template<typename value_type>
+struct inverter<4, value_type> {
+    template <typename container_type>
+    static container_type compute(const container_type& src) {
+        const value_type* m = src.raw();
+        const minors4<value_type> minors{m};
+        const value_type det = minors.determinant();
+        if (det == 0) {
+            throw matrix_error("matrix with determinant == 0 cannot be inverted");
+        }
+        const value_type inv = 1 / det;
+        const value_type* s = minors.s;
+        const value_type* c = minors.c;
+        container_type data;
+        value_type* r = data.raw();
+        r[0]  = ( m[5] * c[5] - m[6] * c[4] + m[7] * c[3]) * inv;
+        r[1]  = (-m[1] * c[5] + m[2] * c[4] - m[3] * c[3]) * inv;
+        r[2]  = ( m[13] * s[5] - m[14] * s[4] + m[15] * s[3]) * inv;
+        r[3]  = (-m[9] * s[5] + m[10] * s[4] - m[11] * s[3]) * inv;
+        r[4]  = (-m[4] * c[5] + m[6] * c[2] - m[7] * c[1]) * inv;
+        r[5]  = ( m[0] * c[5] - m[2] * c[2] + m[3] * c[1]) * inv;
+        r[6]  = (-m[12] * s[5] + m[14] * s[2] - m[15] * s[1]) * inv;
+        r[7]  = ( m[8] * s[5] - m[10] * s[2] + m[11] * s[1]) * inv;
+        r[8]  = ( m[4] * c[4] - m[5] * c[2] + m[7] * c[0]) * inv;
+        r[9]  = (-m[0] * c[4] + m[1] * c[2] - m[3] * c[0]) * inv;
+        r[10] = ( m[12] * s[4] - m[13] * s[2] + m[15] * s[0]) * inv;
+        r[11] = (-m[8] * s[4] + m[9] * s[2] - m[11] * s[0]) * inv;
+        r[12] = (-m[4] * c[3] + m[5] * c[1] - m[6] * c[0]) * inv;
+        r[13] = ( m[0] * c[3] - m[1] * c[1] + m[2] * c[0]) * inv;
+        r[14] = (-m[12] * s[3] + m[13] * s[1] - m[14] * s[0]) * inv;
+        r[15] = ( m[8] * s[3] - m[9] * s[1] + m[10] * s[0]) * inv;
+        return data;
+    }
+};
+
+// order only changes the storage: row_major keeps element {row, col} at
+// row * dimensions + col, column_major at col * dimensions + row. Either way the
+// storage uploads as is (GL_FALSE) when matrices are built for the shader
+// convention of their order: row vectors with the translation in the last row for
+// row_major, like translate() below, column vectors with the translation in the
+// last column for column_major
+template <size_t dimensions, typename value_type, storage_order order>
 class matrix {
 
 public:
-    using container_type = math::linear_square_array<dimensions, value_type>;
-
-    matrix() = default;
-    matrix(std::initializer_list<value_type> list):
+    using container_type = math::linear_square_array<dimensions, value_type, default_layout<dimensions, value_type, order>>;
+    using matrix_type = matrix;
+    static constexpr storage_order storage = order;
+    using element_type = value_type;
+    using vector_type = vector::vector<value_type, dimensions>;
+
+    constexpr matrix() = default;
+    constexpr matrix(std::initializer_list<value_type> list):
         m_data{list} {}
-    matrix(const container_type& data):
+    constexpr matrix(const container_type& data):
         m_data{data} {}
+    // same elements in the other storage order
+    template <storage_order other_order>
+    constexpr explicit matrix(const matrix<dimensions, value_type, other_order>& other):
+        m_data{other.container()} {}
+
+    // evaluates the whole product chain, SIMD kernels are not usable in constant expressions
+    template <typename lhs_type, typename rhs_type>
+    constexpr matrix(const product_expression<lhs_type, rhs_type>& expression) {
+        if (MATH_CONSTANT_EVALUATED()) {
+            evaluate<scalar_multiplicator<dimensions, value_type>>(expression);
+        } else {
+            evaluate<multiplicator<dimensions, value_type>>(expression);
+        }
+    }
 
-    const matrix identity() const {
+    static constexpr matrix make_identity() {
         container_type data;
         for (size_t i = dimensions; i--;) {
             for (size_t j = dimensions; j--;) {
@@ -54,61 +229,139 @@ public:
         return matrix{data};
     }
 
-    const matrix<dimensions - 1, value_type> submatrix(const size_t row, const size_t col) const {
-        using result_type = matrix<dimensions - 1, value_type>;
+    constexpr const matrix identity() const {
+        return make_identity();
+    }
+
+    const matrix<dimensions - 1, value_type, order> submatrix(const size_t row, const size_t col) const {
+        using result_type = matrix<dimensions - 1, value_type, order>;
         using result_container_type = typename result_type::container_type;
 
         result_container_type data;
-#if 1
-        size_t k = 0;
-
-        for (size_t i = 0; i < dimensions; i++) {
-            for (size_t j = 0; j < dimensions; j++) {
-                if (i == row || j == col) {
-                    continue;
-                }
-                data[k++] = m_data.at({i, j});
-            }
-        }
-#else
-        for (size_t i = dimensions - 1; i--;) {
-            for (size_t j = dimensions - 1; j--;) {
+        for (size_t i = 0; i < dimensions - 1; i++) {
+            for (size_t j = 0; j < dimensions - 1; j++) {
                 data[{i, j}] = m_data.at({i < row ? i : i + 1, j < col ? j : j + 1});
             }
         }
-#endif
         return result_type{data};
     }
 
+    // beyond 4x4 the generated expansions grow factorially, larger matrices
+    // take the runtime path through submatrix determinants
+    static constexpr bool generated_cofactors = dimensions <= 4;
+
     value_type cofactor(const size_t row, const size_t col) const {
-        return ((row + col) % 2 ? -1 : 1) * submatrix(row, col).determinant();
+        if constexpr (generated_cofactors) {
+            return order == storage_order::row_major ? cofactors<dimensions, value_type>::cofactor(m_data.raw(), row, col)
+                                                     : cofactors<dimensions, value_type>::cofactor(m_data.raw(), col, row);
+        } else {
+            return ((row + col) % 2 ? -1 : 1) * submatrix(row, col).determinant();
+        }
+    }
+
+    template <size_t row, size_t col>
+    constexpr value_type cofactor() const {
+        if constexpr (order == storage_order::row_major) {
+            return cofactors<dimensions, value_type>::template cofactor<row, col>(m_data.raw());
+        } else {
+            return cofactors<dimensions, value_type>::template cofactor<col, row>(m_data.raw());
+        }
     }
 
     value_type determinant() const {
         return determinator<dimensions, value_type>::compute(*this);
     }
 
-    const matrix adjugate() const {
+    const lu_decomposition<dimensions, value_type> lu() const {
+        return lu_decomposition<dimensions, value_type>{linear_square_array<dimensions, value_type>(m_data)};
+    }
+
+    const vector::vector<value_type, dimensions> solve(const vector::vector<value_type, dimensions>& rhs) const {
+        return lu().solve(rhs);
+    }
+
+    constexpr const matrix adjugate() const {
         container_type data;
 
-        for (size_t row = 0; row < dimensions; row++) {
-            for (size_t col = 0; col < dimensions; col++) {
-                data[{row, col}] = cofactor(row, col);
+        if constexpr (generated_cofactors) {
+            cofactors<dimensions, value_type>::adjugate(m_data.raw(), data.raw());
+        } else {
+            for (size_t row = 0; row < dimensions; row++) {
+                for (size_t col = 0; col < dimensions; col++) {
+                    data[{col, row}] = cofactor(row, col);
+                }
             }
         }
-        // TODO: better way
-        return matrix{data}.transpose();
+        return matrix{data};
     }
 
     const matrix invert() const {
-        value_type det = determinant();
-        if (det == 0) {
-            throw matrix_error("matrix with determinant == 0 cannot be inverted");
+        return matrix{inverter<dimensions, value_type>::compute(m_data)};
+    }
+
+    // translate/rotate/scale compositions keep the last column at (0, ..., 0, 1)
+    // with the translation stored in the last row; column_major storage of the
+    // transposed convention is identical, so the storage based code below serves both
+    bool is_affine() const {
+        const value_type* m = m_data.raw();
+        for (size_t row = 0; row < dimensions - 1; row++) {
+            if (m[row * dimensions + dimensions - 1] != 0) {
+                return false;
+            }
+        }
+        return m[dimensions * dimensions - 1] == 1;
+    }
+
+    // inverts the linear part only and moves the translation through it,
+    // falls back to the generic inversion for non-affine matrices
+    const matrix invert_affine() const {
+        if (!is_affine()) {
+            return invert();
+        }
+        linear_square_array<dimensions - 1, value_type> linear;
+        for (size_t row = 0; row < dimensions - 1; row++) {
+            for (size_t col = 0; col < dimensions - 1; col++) {
+                linear[row * (dimensions - 1) + col] = m_data.raw()[row * dimensions + col];
+            }
+        }
+        return from_linear_inverse(inverter<dimensions - 1, value_type>::compute(linear));
+    }
+
+    // affine with an orthonormal linear part, i.e. rotation + translation only
+    bool is_rigid(const value_type tolerance = value_type(1e-4)) const {
+        if (!is_affine()) {
+            return false;
+        }
+        const value_type* m = m_data.raw();
+        for (size_t i = 0; i < dimensions - 1; i++) {
+            for (size_t j = 0; j < dimensions - 1; j++) {
+                value_type dot = 0;
+                for (size_t k = 0; k < dimensions - 1; k++) {
+                    dot += m[i * dimensions + k] * m[j * dimensions + k];
+                }
+                if (std::abs(dot - value_type(i == j)) > tolerance) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // rotation + translation only: the inverse of the orthonormal linear part is its
+    // transpose. Scaled or sheared input silently gives a wrong result, debug builds
+    // assert is_rigid()
+    const matrix invert_rigid() const {
+        assert(is_rigid());
+        linear_square_array<dimensions - 1, value_type> linear;
+        for (size_t row = 0; row < dimensions - 1; row++) {
+            for (size_t col = 0; col < dimensions - 1; col++) {
+                linear[row * (dimensions - 1) + col] = m_data.raw()[col * dimensions + row];
+            }
         }
-        return adjugate() * (1 / det);
+        return from_linear_inverse(linear);
     }
 
-    const matrix transpose() {
+    constexpr const matrix transpose() const {
         container_type data(m_data);
 
         for (size_t row = 0; row < dimensions - 1; row++) {
@@ -119,11 +372,11 @@ public:
         return matrix{data};
     }
 
-    bool operator==(const matrix& rhs) const {
+    constexpr bool operator==(const matrix& rhs) const {
         return m_data == rhs.container();
     }
 
-    const matrix operator*(const value_type rhs) const {
+    constexpr const matrix operator*(const value_type rhs) const {
         container_type data(m_data);
 
         for (size_t index = 0; index < dimensions * dimensions; index++) {
@@ -132,41 +385,200 @@ public:
         return matrix{data};
     }
 
-    const vector::vector<value_type, dimensions> operator*(const vector::vector<value_type, dimensions>& vec) const {
-        typename vector::vector<value_type, dimensions>::container_type data;
+    // column vector product
+    constexpr const vector_type operator*(const vector_type& vec) const {
+        if (MATH_CONSTANT_EVALUATED()) {
+            return vector_product<scalar_multiplicator<dimensions, value_type>>(vec);
+        }
+        return vector_product<multiplicator<dimensions, value_type>>(vec);
+    }
+
+    // row vector product, see operator*(vector, matrix)
+    constexpr const vector_type multiply_row_vector(const vector_type& vec) const {
+        if (MATH_CONSTANT_EVALUATED()) {
+            return row_vector_product<scalar_multiplicator<dimensions, value_type>>(vec);
+        }
+        return row_vector_product<multiplicator<dimensions, value_type>>(vec);
+    }
+
+    template <typename kernel>
+    constexpr typename kernel::row_type evaluate_row(const size_t index) const {
+        return kernel::load_row(m_data, index);
+    }
+
+    template <typename kernel>
+    constexpr typename kernel::row_type multiply_row(const typename kernel::row_type& row) const {
+        return kernel::multiply_row(row, m_data);
+    }
+
+    constexpr const container_type& container() const {
+        return m_data;
+    }
+
+    constexpr container_type& container() {
+        return m_data;
+    }
+
+protected:
 
+    container_type   m_data;
+
+private:
+
+    // column-major storage holds the transpose, which turns column vector
+    // products into row vector products of the storage and vice versa
+    template <typename kernel>
+    constexpr const vector_type vector_product(const vector_type& vec) const {
+        if constexpr (order == storage_order::row_major) {
+            return kernel::compute(m_data, vec);
+        } else {
+            return kernel::compute(vec, m_data);
+        }
+    }
+
+    template <typename kernel>
+    constexpr const vector_type row_vector_product(const vector_type& vec) const {
+        if constexpr (order == storage_order::row_major) {
+            return kernel::compute(vec, m_data);
+        } else {
+            return kernel::compute(m_data, vec);
+        }
+    }
+
+    // every result row is pushed through all factors in turn, rows are kept local
+    // until the end so that stores cannot alias the operands
+    template <typename kernel, typename expression_type>
+    constexpr void evaluate(const expression_type& expression) {
+        typename kernel::row_type rows[dimensions]{};
         for (size_t row = 0; row < dimensions; row++) {
-            for (size_t col = 0; col < dimensions; col++) {
-                data[col] += m_data.at({row, col}) * vec.data().at(col);
-            }
+            rows[row] = expression.template evaluate_row<kernel>(row);
+        }
+        for (size_t row = 0; row < dimensions; row++) {
+            kernel::store_row(rows[row], m_data, row);
         }
-        return vector::vector<value_type, dimensions>{data};
     }
 
-    const matrix operator*(const matrix& rhs) const {
+    const matrix from_linear_inverse(const linear_square_array<dimensions - 1, value_type>& linear) const {
+        const value_type* m = m_data.raw();
+        const value_type* l = linear.raw();
+        const value_type* translation = m + (dimensions - 1) * dimensions;
         container_type data;
+        value_type* result = data.raw();
 
-        for (size_t row = 0; row < dimensions; row++) {
-            for (size_t col = 0; col < dimensions; col++) {
-                for (size_t i = 0; i < dimensions; i++) {
-                    data[{row, col}] += m_data.at({row, i}) * rhs.container().at({i, col});
-                }
+        for (size_t row = 0; row < dimensions - 1; row++) {
+            for (size_t col = 0; col < dimensions - 1; col++) {
+                result[row * dimensions + col] = l[row * (dimensions - 1) + col];
             }
         }
+        // t' = -t * L^-1
+        for (size_t col = 0; col < dimensions - 1; col++) {
+            value_type sum = 0;
+            for (size_t i = 0; i < dimensions - 1; i++) {
+                sum -= translation[i] * l[i * (dimensions - 1) + col];
+            }
+            result[(dimensions - 1) * dimensions + col] = sum;
+        }
+        result[dimensions * dimensions - 1] = 1;
         return matrix{data};
     }
+};
 
-    const container_type& container() const {
-        return m_data;
+template <size_t dimensions, class value_type, storage_order order> std::ostream& operator<<(std::ostream& out, const matrix<dimensions, value_type, order>& rhs) {
+    out << rhs.container();
+    return out;
+}
+
+// row vector times matrix: what a shader computes for a matrix uploaded without
+// transposition, translations in the last row move points with w == 1
+template <size_t dimensions, class value_type, storage_order order>
+constexpr const vector::vector<value_type, dimensions> operator*(const vector::vector<value_type, dimensions>& lhs, const matrix<dimensions, value_type, order>& rhs) {
+    return rhs.multiply_row_vector(lhs);
+}
+
+template <typename...> struct void_type {
+    using type = void;
+};
+
+// matrices, their subclasses and product expressions
+template <typename type, typename = void>
+struct is_matrix_expression : std::false_type {};
+
+template <typename type>
+struct is_matrix_expression<type, typename void_type<typename type::matrix_type>::type> : std::true_type {};
+
+// operands are copied or moved into the expression, so one held by `auto` neither
+// dangles nor sees later changes to the matrices it was built from. A mat4f copy
+// is cheap next to the product, views (matrix_ref) still refer to their storage
+template <typename operand_type>
+using expression_operand = typename std::decay<operand_type>::type;
+
+// lazy matrix product, evaluated once when converted to a matrix: every result row
+// is pushed through all factors in turn and never written to an intermediate matrix.
+// Column-major storage of a product is the storage product in reverse order
+template <typename lhs_type, typename rhs_type>
+class product_expression {
+
+public:
+    using matrix_type = typename std::decay<lhs_type>::type::matrix_type;
+    using element_type = typename matrix_type::element_type;
+    using vector_type = typename matrix_type::vector_type;
+
+    template <typename lhs_operand, typename rhs_operand>
+    constexpr product_expression(lhs_operand&& lhs, rhs_operand&& rhs):
+        m_lhs(std::forward<lhs_operand>(lhs)), m_rhs(std::forward<rhs_operand>(rhs)) {}
+
+    template <typename kernel>
+    constexpr typename kernel::row_type evaluate_row(const size_t index) const {
+        if constexpr (matrix_type::storage == storage_order::row_major) {
+            return m_rhs.template multiply_row<kernel>(m_lhs.template evaluate_row<kernel>(index));
+        } else {
+            return m_lhs.template multiply_row<kernel>(m_rhs.template evaluate_row<kernel>(index));
+        }
     }
 
-protected:
+    template <typename kernel>
+    constexpr typename kernel::row_type multiply_row(const typename kernel::row_type& row) const {
+        if constexpr (matrix_type::storage == storage_order::row_major) {
+            return m_rhs.template multiply_row<kernel>(m_lhs.template multiply_row<kernel>(row));
+        } else {
+            return m_lhs.template multiply_row<kernel>(m_rhs.template multiply_row<kernel>(row));
+        }
+    }
 
-    container_type   m_data;
+    constexpr const matrix_type evaluate() const {
+        return matrix_type{*this};
+    }
+
+    constexpr const matrix_type operator*(const element_type rhs) const {
+        return evaluate() * rhs;
+    }
+
+    constexpr const vector_type operator*(const vector_type& rhs) const {
+        return evaluate() * rhs;
+    }
+
+    constexpr bool operator==(const matrix_type& rhs) const {
+        return evaluate() == rhs;
+    }
+
+private:
+
+    lhs_type m_lhs;
+    rhs_type m_rhs;
 };
 
-template <size_t dimensions, class value_type> std::ostream& operator<<(std::ostream& out, const matrix<dimensions, value_type>& rhs) {
-    out << rhs.container();
+template <typename lhs_type, typename rhs_type,
+          typename = typename std::enable_if<is_matrix_expression<typename std::decay<lhs_type>::type>::value &&
+                                             is_matrix_expression<typename std::decay<rhs_type>::type>::value>::type>
+constexpr product_expression<expression_operand<lhs_type>, expression_operand<rhs_type>> operator*(lhs_type&& lhs, rhs_type&& rhs) {
+    static_assert(std::is_same<typename std::decay<lhs_type>::type::matrix_type,
+                               typename std::decay<rhs_type>::type::matrix_type>::value,
+                  "matrix product operands must have the same dimensions, value type and storage order");
+    return {std::forward<lhs_type>(lhs), std::forward<rhs_type>(rhs)};
+}
+
+template <typename lhs_type, typename rhs_type> std::ostream& operator<<(std::ostream& out, const product_expression<lhs_type, rhs_type>& rhs) {
+    out << rhs.evaluate();
     return out;
 }
 
@@ -174,22 +586,28 @@ using mat2f = matrix<2, float>;
 using mat3f = matrix<3, float>;
 using mat4f = matrix<4, float>;
 
+template <size_t dimensions, typename value_type>
+using column_major_matrix = matrix<dimensions, value_type, storage_order::column_major>;
+
+using column_major_mat3f = column_major_matrix<3, float>;
+using column_major_mat4f = column_major_matrix<4, float>;
+
 class identity4f : public mat4f {
 public:
-    identity4f():
-        mat4f(mat4f::identity()) {}
+    constexpr identity4f():
+        mat4f(mat4f::make_identity()) {}
 };
 
 //TODO: template-based
 class translate : public identity4f {
 public:
-    translate(const float x, const float y, const float z):
+    constexpr translate(const float x, const float y, const float z):
         identity4f() {
         m_data[12] = x;
         m_data[13] = y;
         m_data[14] = z;
     }
-    translate(const vector::vec3& vec):
+    constexpr translate(const vector::vec3& vec):
         identity4f() {
         m_data[12] = vec.data()[0];
         m_data[13] = vec.data()[1];
@@ -199,13 +617,13 @@ public:
 
 class scale : public identity4f {
 public:
-    scale(const float x, const float y, const float z):
+    constexpr scale(const float x, const float y, const float z):
         identity4f() {
         m_data[0] = x;
         m_data[5] = y;
         m_data[10] = z;
     }
-    scale(const vector::vec3& vec):
+    constexpr scale(const vector::vec3& vec):
         identity4f() {
         m_data[0] = vec.data()[0];
         m_data[5] = vec.data()[1];
@@ -217,10 +635,12 @@ class rotate_x : public identity4f {
 public:
     rotate_x(const float value):
         identity4f() {
-        m_data[5] = cos(value);
-        m_data[6] = sin(value);
-        m_data[9] = -sin(value);
-        m_data[10] = cos(value);
+        const float cosine = cos(value);
+        const float sine = sin(value);
+        m_data[5] = cosine;
+        m_data[6] = sine;
+        m_data[9] = -sine;
+        m_data[10] = cosine;
     }
 };
 
@@ -228,10 +648,12 @@ class rotate_y : public identity4f {
 public:
     rotate_y(const float value):
         identity4f() {
-        m_data[0] = cos(value);
-        m_data[2] = -sin(value);
-        m_data[8] = sin(value);
-        m_data[10] = cos(value);
+        const float cosine = cos(value);
+        const float sine = sin(value);
+        m_data[0] = cosine;
+        m_data[2] = -sine;
+        m_data[8] = sine;
+        m_data[10] = cosine;
     }
 };
 
@@ -239,10 +661,63 @@ class rotate_z : public identity4f {
 public:
     rotate_z(const float value):
         identity4f() {
-        m_data[0] = cos(value);
-        m_data[1] = sin(value);
-        m_data[4] = -sin(value);
-        m_data[5] = cos(value);
+        const float cosine = cos(value);
+        const float sine = sin(value);
+        m_data[0] = cosine;
+        m_data[1] = sine;
+        m_data[4] = -sine;
+        m_data[5] = cosine;
+    }
+};
+
+// camera matrices for the same row vector convention: clip = point * view * projection,
+// the product uploaded with GL_FALSE. View space is right handed looking down -z,
+// clip space depth runs from -1 at z_near to 1 at z_far as with glFrustum
+
+// fov_y in radians
+class perspective : public identity4f {
+public:
+    perspective(const float fov_y, const float aspect, const float z_near, const float z_far):
+        identity4f() {
+        const float focal = 1 / tan(fov_y / 2);
+        m_data[0] = focal / aspect;
+        m_data[5] = focal;
+        m_data[10] = (z_far + z_near) / (z_near - z_far);
+        m_data[11] = -1;
+        m_data[14] = 2 * z_far * z_near / (z_near - z_far);
+        m_data[15] = 0;
+    }
+};
+
+class orthographic : public identity4f {
+public:
+    constexpr orthographic(const float left, const float right, const float bottom, const float top, const float z_near, const float z_far):
+        identity4f() {
+        m_data[0] = 2 / (right - left);
+        m_data[5] = 2 / (top - bottom);
+        m_data[10] = -2 / (z_far - z_near);
+        m_data[12] = -(right + left) / (right - left);
+        m_data[13] = -(top + bottom) / (top - bottom);
+        m_data[14] = -(z_far + z_near) / (z_far - z_near);
+    }
+};
+
+// up must not be parallel to target - eye
+class look_at : public identity4f {
+public:
+    look_at(const vector::vec3& eye, const vector::vec3& target, const vector::vec3& up):
+        identity4f() {
+        const vector::vec3 forward = vector::normalize(target - eye);
+        const vector::vec3 side = vector::normalize(vector::cross(forward, up));
+        const vector::vec3 upward = vector::cross(side, forward);
+        for (size_t axis = 0; axis < 3; axis++) {
+            m_data[axis * 4 + 0] = side.data()[axis];
+            m_data[axis * 4 + 1] = upward.data()[axis];
+            m_data[axis * 4 + 2] = -forward.data()[axis];
+        }
+        m_data[12] = -vector::dot(side, eye);
+        m_data[13] = -vector::dot(upward, eye);
+        m_data[14] = vector::dot(forward, eye);
     }
 };
 
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+namespace math {
+
+class matrix_error : public std::runtime_error {
+public:
+    matrix_error(const std::string& error):
+        std::runtime_error{error} {}
+};
+
+} // ns math
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <array>
+#include "matrix.hpp"
+
+namespace math {
+
+// lanes matrices interleaved element by element (AoSoA): element {row, col} of all
+// of them is one contiguous, aligned run of lanes values, i.e. a single SSE or AVX
+// register for 4 or 8 floats, so kernels process a whole group per instruction
+template <size_t lanes, size_t width, typename value_type>
+class alignas(lanes * sizeof(value_type)) matrix_group {
+    static_assert(lanes && !(lanes & (lanes - 1)), "lane count must be a power of two");
+
+public:
+    static constexpr size_t lane_count = lanes;
+    using matrix_type = matrix<width, value_type>;
+    using container_type = std::array<value_type, width * width * lanes>;
+
+    constexpr matrix_group():
+        m_data{} {}
+
+    constexpr void set(const size_t lane, const matrix_type& value) {
+        for (size_t index = 0; index < width * width; index++) {
+            m_data[index * lanes + lane] = value.container().at(index);
+        }
+    }
+
+    constexpr matrix_type get(const size_t lane) const {
+        typename matrix_type::container_type data;
+        for (size_t index = 0; index < width * width; index++) {
+            data[index] = m_data[index * lanes + lane];
+        }
+        return matrix_type{data};
+    }
+
+    // lanes values of element {row, col}
+    constexpr value_type* element(const size_t row, const size_t col) {
+        return m_data.data() + (row * width + col) * lanes;
+    }
+
+    constexpr const value_type* element(const size_t row, const size_t col) const {
+        return m_data.data() + (row * width + col) * lanes;
+    }
+
+    constexpr const value_type* raw() const {
+        return m_data.data();
+    }
+
+    constexpr value_type* raw() {
+        return m_data.data();
+    }
+
+private:
+    container_type m_data;
+};
+
+// lane-wise matrix products, the innermost loop runs over lanes and vectorizes
+template <size_t lanes, size_t width, typename value_type>
+void multiply(const matrix_group<lanes, width, value_type>& lhs, const matrix_group<lanes, width, value_type>& rhs,
+              matrix_group<lanes, width, value_type>& result) {
+    for (size_t row = 0; row < width; row++) {
+        for (size_t col = 0; col < width; col++) {
+            value_type sum[lanes] = {};
+            for (size_t i = 0; i < width; i++) {
+                const value_type* a = lhs.element(row, i);
+                const value_type* b = rhs.element(i, col);
+                for (size_t lane = 0; lane < lanes; lane++) {
+                    sum[lane] += a[lane] * b[lane];
+                }
+            }
+            value_type* target = result.element(row, col);
+            for (size_t lane = 0; lane < lanes; lane++) {
+                target[lane] = sum[lane];
+            }
+        }
+    }
+}
+
+// count matrices into (count + lanes - 1) / lanes groups, unused lanes of the last
+// group are identity matrices
+template <size_t lanes, size_t width, typename value_type>
+void pack(const matrix<width, value_type>* matrices, const size_t count, matrix_group<lanes, width, value_type>* groups) {
+    for (size_t i = 0; i < count; i++) {
+        groups[i / lanes].set(i % lanes, matrices[i]);
+    }
+    for (size_t i = count; i % lanes; i++) {
+        groups[i / lanes].set(i % lanes, matrix<width, value_type>::make_identity());
+    }
+}
+
+template <size_t lanes, size_t width, typename value_type>
+void unpack(const matrix_group<lanes, width, value_type>* groups, const size_t count, matrix<width, value_type>* matrices) {
+    for (size_t i = 0; i < count; i++) {
+        matrices[i] = groups[i / lanes].get(i % lanes);
+    }
+}
+
+namespace detail {
+
+// lanes values of one element, the registers of the batch kernels
+template <size_t lanes, typename value_type>
+struct lane_arithmetic {
+    using register_type = std::array<value_type, lanes>;
+
+    static register_type zero() {
+        return register_type{};
+    }
+
+    static register_type load(const value_type* src) {
+        register_type result;
+        for (size_t lane = 0; lane < lanes; lane++) {
+            result[lane] = src[lane];
+        }
+        return result;
+    }
+
+    static void store(const register_type& value, value_type* dst) {
+        for (size_t lane = 0; lane < lanes; lane++) {
+            dst[lane] = value[lane];
+        }
+    }
+
+    static register_type add(const register_type& lhs, const register_type& rhs) {
+        register_type result;
+        for (size_t lane = 0; lane < lanes; lane++) {
+            result[lane] = lhs[lane] + rhs[lane];
+        }
+        return result;
+    }
+
+    static register_type subtract(const register_type& lhs, const register_type& rhs) {
+        register_type result;
+        for (size_t lane = 0; lane < lanes; lane++) {
+            result[lane] = lhs[lane] - rhs[lane];
+        }
+        return result;
+    }
+
+    static register_type multiply(const register_type& lhs, const register_type& rhs) {
+        register_type result;
+        for (size_t lane = 0; lane < lanes; lane++) {
+            result[lane] = lhs[lane] * rhs[lane];
+        }
+        return result;
+    }
+
+    // 1 / value, 0 for zero lanes
+    static register_type reciprocal(const register_type& value) {
+        register_type result;
+        for (size_t lane = 0; lane < lanes; lane++) {
+            result[lane] = value[lane] == 0 ? 0 : 1 / value[lane];
+        }
+        return result;
+    }
+
+    // bit lane set for every zero lane
+    static unsigned zero_mask(const register_type& value) {
+        unsigned mask = 0;
+        for (size_t lane = 0; lane < lanes; lane++) {
+            mask |= (value[lane] == 0) << lane;
+        }
+        return mask;
+    }
+};
+
+#if defined(MATH_SIMD_SSE)
+template <>
+struct lane_arithmetic<4, float> {
+    using register_type = __m128;
+
+    static register_type zero() { return _mm_setzero_ps(); }
+    static register_type load(const float* src) { return _mm_load_ps(src); }
+    static void store(const register_type value, float* dst) { _mm_store_ps(dst, value); }
+    static register_type add(const register_type lhs, const register_type rhs) { return _mm_add_ps(lhs, rhs); }
+    static register_type subtract(const register_type lhs, const register_type rhs) { return _mm_sub_ps(lhs, rhs); }
+    static register_type multiply(const register_type lhs, const register_type rhs) { return _mm_mul_ps(lhs, rhs); }
+
+    static register_type reciprocal(const register_type value) {
+        const register_type zero = _mm_cmpeq_ps(value, _mm_setzero_ps());
+        return _mm_andnot_ps(zero, _mm_div_ps(_mm_set1_ps(1), value));
+    }
+
+    static unsigned zero_mask(const register_type value) {
+        return _mm_movemask_ps(_mm_cmpeq_ps(value, _mm_setzero_ps()));
+    }
+};
+#endif
+
+#if defined(MATH_SIMD_AVX)
+template <>
+struct lane_arithmetic<8, float> {
+    using register_type = __m256;
+
+    static register_type zero() { return _mm256_setzero_ps(); }
+    static register_type load(const float* src) { return _mm256_load_ps(src); }
+    static void store(const register_type value, float* dst) { _mm256_store_ps(dst, value); }
+    static register_type add(const register_type lhs, const register_type rhs) { return _mm256_add_ps(lhs, rhs); }
+    static register_type subtract(const register_type lhs, const register_type rhs) { return _mm256_sub_ps(lhs, rhs); }
+    static register_type multiply(const register_type lhs, const register_type rhs) { return _mm256_mul_ps(lhs, rhs); }
+
+    static register_type reciprocal(const register_type value) {
+        const register_type zero = _mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_EQ_OQ);
+        return _mm256_andnot_ps(zero, _mm256_div_ps(_mm256_set1_ps(1), value));
+    }
+
+    static unsigned zero_mask(const register_type value) {
+        return _mm256_movemask_ps(_mm256_cmp_ps(value, _mm256_setzero_ps(), _CMP_EQ_OQ));
+    }
+};
+#endif
+
+// inverter<4> evaluated for all lanes at once. All elements are loaded before the
+// first store, so src and dst may be the same group
+template <size_t lanes, typename value_type, bool transposed>
+unsigned invert_lanes(const value_type* src, value_type* dst) {
+    using ops = lane_arithmetic<lanes, value_type>;
+    using reg = typename ops::register_type;
+
+    reg m[16];
+    for (size_t index = 0; index < 16; index++) {
+        m[index] = ops::load(src + index * lanes);
+    }
+    const auto minor = [&](const size_t a, const size_t b, const size_t c, const size_t d) {
+        return ops::subtract(ops::multiply(m[a], m[b]), ops::multiply(m[c], m[d]));
+    };
+    // a * x - b * y + c * z
+    const auto combine = [](const reg& a, const reg& x, const reg& b, const reg& y, const reg& c, const reg& z) {
+        return ops::add(ops::subtract(ops::multiply(a, x), ops::multiply(b, y)), ops::multiply(c, z));
+    };
+
+    const reg s[6] = {minor(0, 5, 4, 1), minor(0, 6, 4, 2), minor(0, 7, 4, 3),
+                      minor(1, 6, 5, 2), minor(1, 7, 5, 3), minor(2, 7, 6, 3)};
+    const reg c[6] = {minor(8, 13, 12, 9), minor(8, 14, 12, 10), minor(8, 15, 12, 11),
+                      minor(9, 14, 13, 10), minor(9, 15, 13, 11), minor(10, 15, 14, 11)};
+    // summed in the order of minors4::determinant()
+    const reg det = ops::add(ops::subtract(ops::add(combine(s[0], c[5], s[1], c[4], s[2], c[3]),
+                                                    ops::multiply(s[3], c[2])),
+                                           ops::multiply(s[4], c[1])),
+                             ops::multiply(s[5], c[0]));
+    const unsigned singular = ops::zero_mask(det);
+    const reg inv = ops::reciprocal(det);
+    // not inv - inv, which is NaN where a denormal determinant made inv infinite
+    const reg zero = ops::zero();
+    const auto negate = [&](const reg& value) {
+        return ops::subtract(zero, value);
+    };
+
+    const reg r[16] = {
+        combine(m[5], c[5], m[6], c[4], m[7], c[3]),
+        negate(combine(m[1], c[5], m[2], c[4], m[3], c[3])),
+        combine(m[13], s[5], m[14], s[4], m[15], s[3]),
+        negate(combine(m[9], s[5], m[10], s[4], m[11], s[3])),
+        negate(combine(m[4], c[5], m[6], c[2], m[7], c[1])),
+        combine(m[0], c[5], m[2], c[2], m[3], c[1]),
+        negate(combine(m[12], s[5], m[14], s[2], m[15], s[1])),
+        combine(m[8], s[5], m[10], s[2], m[11], s[1]),
+        combine(m[4], c[4], m[5], c[2], m[7], c[0]),
+        negate(combine(m[0], c[4], m[1], c[2], m[3], c[0])),
+        combine(m[12], s[4], m[13], s[2], m[15], s[0]),
+        negate(combine(m[8], s[4], m[9], s[2], m[11], s[0])),
+        negate(combine(m[4], c[3], m[5], c[1], m[6], c[0])),
+        combine(m[0], c[3], m[1], c[1], m[2], c[0]),
+        negate(combine(m[12], s[3], m[13], s[1], m[14], s[0])),
+        combine(m[8], s[3], m[9], s[1], m[10], s[0])
+    };
+    for (size_t index = 0; index < 16; index++) {
+        const size_t target = transposed ? (index % 4) * 4 + index / 4 : index;
+        ops::store(ops::multiply(r[index], inv), dst + target * lanes);
+    }
+    return singular;
+}
+
+} // ns detail
+
+// lane-wise inverse of a group of 4x4 matrices. Instead of throwing matrix_error,
+// singular lanes are zeroed and reported in the returned mask, bit lane per lane
+template <size_t lanes, typename value_type>
+unsigned invert(const matrix_group<lanes, 4, value_type>& src, matrix_group<lanes, 4, value_type>& result) {
+    static_assert(lanes <= sizeof(unsigned) * 8, "one mask bit per lane");
+    return detail::invert_lanes<lanes, value_type, false>(src.raw(), result.raw());
+}
+
+// transposed inverse, the normal matrix of a model matrix
+template <size_t lanes, typename value_type>
+unsigned invert_transpose(const matrix_group<lanes, 4, value_type>& src, matrix_group<lanes, 4, value_type>& result) {
+    static_assert(lanes <= sizeof(unsigned) * 8, "one mask bit per lane");
+    return detail::invert_lanes<lanes, value_type, true>(src.raw(), result.raw());
+}
+
+// count groups at a time, singular receives the mask of every group when given;
+// returns the number of singular matrices
+template <size_t lanes, typename value_type>
+size_t invert(const matrix_group<lanes, 4, value_type>* src, matrix_group<lanes, 4, value_type>* result,
+              const size_t count, unsigned* singular = nullptr) {
+    size_t singular_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        const unsigned mask = invert(src[i], result[i]);
+        for (unsigned bits = mask; bits; bits &= bits - 1) {
+            singular_count++;
+        }
+        if (singular) {
+            singular[i] = mask;
+        }
+    }
+    return singular_count;
+}
+
+template <size_t lanes>
+using mat4f_group = matrix_group<lanes, 4, float>;
+
+} // ns math
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "matrix.hpp"
+
+namespace math {
+
+// non-owning view of dense dimensions x dimensions storage in the given order, e.g.
+// a mapped instance buffer or a memory-mapped file of transforms. Views take part in
+// product expressions like matrices; the operations below write their results into
+// a destination pointer, which may be the viewed storage itself
+template <size_t dimensions, typename value_type, storage_order order = storage_order::row_major>
+class const_matrix_ref {
+
+public:
+    using matrix_type = matrix<dimensions, value_type, order>;
+    using container_type = typename matrix_type::container_type;
+    static constexpr storage_order storage = order;
+    using element_type = value_type;
+    using vector_type = typename matrix_type::vector_type;
+    static constexpr size_t size = dimensions * dimensions;
+
+    constexpr explicit const_matrix_ref(const value_type* data):
+        m_data(data) {}
+    constexpr const_matrix_ref(const matrix_type& m):
+        m_data(m.container().raw()) {}
+    const_matrix_ref(const matrix_type&&) = delete;
+
+    constexpr const value_type* raw() const {
+        return m_data;
+    }
+
+    constexpr value_type at(const size_t row, const size_t col) const {
+        return order == storage_order::row_major ? m_data[row * dimensions + col] : m_data[col * dimensions + row];
+    }
+
+    // copy into an owning matrix
+    constexpr const matrix_type evaluate() const {
+        container_type data;
+        for (size_t index = 0; index < size; index++) {
+            data.raw()[index] = m_data[index];
+        }
+        return matrix_type{data};
+    }
+
+    constexpr bool operator==(const matrix_type& rhs) const {
+        return evaluate() == rhs;
+    }
+
+    value_type determinant() const {
+        return evaluate().determinant();
+    }
+
+    bool is_affine() const {
+        return evaluate().is_affine();
+    }
+
+    const vector_type solve(const vector_type& rhs) const {
+        return evaluate().solve(rhs);
+    }
+
+    // column vector product
+    constexpr const vector_type operator*(const vector_type& vec) const {
+        if (MATH_CONSTANT_EVALUATED()) {
+            return vector_product<scalar_multiplicator<dimensions, value_type>>(vec);
+        }
+        return vector_product<multiplicator<dimensions, value_type>>(vec);
+    }
+
+    // row vector product, see operator*(vector, const_matrix_ref)
+    constexpr const vector_type multiply_row_vector(const vector_type& vec) const {
+        if (MATH_CONSTANT_EVALUATED()) {
+            return row_vector_product<scalar_multiplicator<dimensions, value_type>>(vec);
+        }
+        return row_vector_product<multiplicator<dimensions, value_type>>(vec);
+    }
+
+    constexpr const matrix_type operator*(const value_type rhs) const {
+        return evaluate() * rhs;
+    }
+
+    template <typename kernel>
+    constexpr typename kernel::row_type evaluate_row(const size_t index) const {
+        return kernel::load_row(*this, index);
+    }
+
+    template <typename kernel>
+    constexpr typename kernel::row_type multiply_row(const typename kernel::row_type& row) const {
+        return kernel::multiply_row(row, *this);
+    }
+
+    constexpr void multiply(const value_type rhs, value_type* dst) const {
+        for (size_t index = 0; index < size; index++) {
+            dst[index] = m_data[index] * rhs;
+        }
+    }
+
+    constexpr void transpose(value_type* dst) const {
+        if (dst == m_data) {
+            for (size_t row = 0; row < dimensions - 1; row++) {
+                for (size_t col = row + 1; col < dimensions; col++) {
+                    const value_type temp = dst[row * dimensions + col];
+                    dst[row * dimensions + col] = dst[col * dimensions + row];
+                    dst[col * dimensions + row] = temp;
+                }
+            }
+            return;
+        }
+        for (size_t row = 0; row < dimensions; row++) {
+            for (size_t col = 0; col < dimensions; col++) {
+                dst[col * dimensions + row] = m_data[row * dimensions + col];
+            }
+        }
+    }
+
+    // the generated cofactors read the source throughout, in place results go through a copy
+    constexpr void adjugate(value_type* dst) const {
+        if constexpr (matrix_type::generated_cofactors) {
+            if (dst != m_data) {
+                cofactors<dimensions, value_type>::adjugate(m_data, dst);
+                return;
+            }
+        }
+        store(evaluate().adjugate(), dst);
+    }
+
+    // the inversion kernels work on a loaded copy, the result is stored once
+    void invert(value_type* dst) const {
+        store(evaluate().invert(), dst);
+    }
+
+    void invert_affine(value_type* dst) const {
+        store(evaluate().invert_affine(), dst);
+    }
+
+    void invert_rigid(value_type* dst) const {
+        store(evaluate().invert_rigid(), dst);
+    }
+
+protected:
+
+    static constexpr void store(const matrix_type& src, value_type* dst) {
+        for (size_t index = 0; index < size; index++) {
+            dst[index] = src.container().raw()[index];
+        }
+    }
+
+    const value_type* m_data;
+
+private:
+
+    // see matrix::vector_product
+    template <typename kernel>
+    constexpr const vector_type vector_product(const vector_type& vec) const {
+        if constexpr (order == storage_order::row_major) {
+            return kernel::compute(*this, vec);
+        } else {
+            return kernel::compute(vec, *this);
+        }
+    }
+
+    template <typename kernel>
+    constexpr const vector_type row_vector_product(const vector_type& vec) const {
+        if constexpr (order == storage_order::row_major) {
+            return kernel::compute(vec, *this);
+        } else {
+            return kernel::compute(*this, vec);
+        }
+    }
+};
+
+// assignment writes through the view instead of rebinding it, so
+// `matrix_ref(buffer) = view * model` evaluates the product straight into buffer
+template <size_t dimensions, typename value_type, storage_order order = storage_order::row_major>
+class matrix_ref : public const_matrix_ref<dimensions, value_type, order> {
+
+public:
+    using base_type = const_matrix_ref<dimensions, value_type, order>;
+    using matrix_type = typename base_type::matrix_type;
+    using base_type::size;
+    using base_type::multiply;
+    using base_type::transpose;
+    using base_type::adjugate;
+    using base_type::invert;
+    using base_type::invert_affine;
+    using base_type::invert_rigid;
+
+    constexpr explicit matrix_ref(value_type* data):
+        base_type(data) {}
+    constexpr matrix_ref(matrix_type& m):
+        base_type(m.container().raw()) {}
+    constexpr matrix_ref(const matrix_ref&) = default;
+
+    // constructed from a mutable pointer, constness is the view's
+    constexpr value_type* raw() const {
+        return const_cast<value_type*>(this->m_data);
+    }
+
+    constexpr value_type& element(const size_t row, const size_t col) const {
+        return order == storage_order::row_major ? raw()[row * dimensions + col] : raw()[col * dimensions + row];
+    }
+
+    constexpr matrix_ref& operator=(const matrix_type& rhs) {
+        base_type::store(rhs, raw());
+        return *this;
+    }
+
+    constexpr matrix_ref& operator=(const base_type& rhs) {
+        for (size_t index = 0; index < size; index++) {
+            raw()[index] = rhs.raw()[index];
+        }
+        return *this;
+    }
+
+    constexpr matrix_ref& operator=(const matrix_ref& rhs) {
+        return *this = static_cast<const base_type&>(rhs);
+    }
+
+    // rows are kept local until all of them are evaluated, the destination may be an operand
+    template <typename lhs_type, typename rhs_type>
+    constexpr matrix_ref& operator=(const product_expression<lhs_type, rhs_type>& expression) {
+        if (MATH_CONSTANT_EVALUATED()) {
+            evaluate<scalar_multiplicator<dimensions, value_type>>(expression);
+        } else {
+            evaluate<multiplicator<dimensions, value_type>>(expression);
+        }
+        return *this;
+    }
+
+    template <typename rhs_type>
+    constexpr matrix_ref& operator*=(const rhs_type& rhs) {
+        return *this = *this * rhs;
+    }
+
+    constexpr matrix_ref& operator*=(const value_type rhs) {
+        multiply(rhs, raw());
+        return *this;
+    }
+
+    constexpr void transpose() {
+        transpose(raw());
+    }
+
+    constexpr void adjugate() {
+        adjugate(raw());
+    }
+
+    void invert() {
+        invert(raw());
+    }
+
+    void invert_affine() {
+        invert_affine(raw());
+    }
+
+    void invert_rigid() {
+        invert_rigid(raw());
+    }
+
+private:
+
+    template <typename kernel, typename expression_type>
+    constexpr void evaluate(const expression_type& expression) {
+        typename kernel::row_type rows[dimensions]{};
+        for (size_t row = 0; row < dimensions; row++) {
+            rows[row] = expression.template evaluate_row<kernel>(row);
+        }
+        for (size_t row = 0; row < dimensions; row++) {
+            kernel::store_row(rows[row], *this, row);
+        }
+    }
+};
+
+template <size_t dimensions, class value_type, storage_order order>
+constexpr const vector::vector<value_type, dimensions> operator*(const vector::vector<value_type, dimensions>& lhs, const const_matrix_ref<dimensions, value_type, order>& rhs) {
+    return rhs.multiply_row_vector(lhs);
+}
+
+template <size_t dimensions, class value_type, storage_order order> std::ostream& operator<<(std::ostream& out, const const_matrix_ref<dimensions, value_type, order>& rhs) {
+    out << rhs.evaluate();
+    return out;
+}
+
+using mat3f_ref = matrix_ref<3, float>;
+using mat4f_ref = matrix_ref<4, float>;
+using const_mat3f_ref = const_matrix_ref<3, float>;
+using const_mat4f_ref = const_matrix_ref<4, float>;
+
+} // ns math
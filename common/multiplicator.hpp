@@ -0,0 +1,194 @@
+#pragma once
+
+#include <array>
+#include "simd.hpp"
+#include "linear_square_array.hpp"
+#include "vector.hpp"
+
+namespace math {
+
+// kernels work on storage as is: for column-major matrices the storage of a
+// product is the row-major product of the operand storages in reverse order, the
+// matrix class swaps operands accordingly
+template<size_t dimensions, typename value_type>
+struct scalar_multiplicator {
+    using vector_type = vector::vector<value_type, dimensions>;
+    using row_type = std::array<value_type, dimensions>;
+
+    template <typename container_type>
+    static constexpr container_type compute(const container_type& lhs, const container_type& rhs) {
+        container_type data;
+        const value_type* a = lhs.raw();
+        const value_type* b = rhs.raw();
+        value_type* r = data.raw();
+
+        for (size_t row = 0; row < dimensions; row++) {
+            for (size_t col = 0; col < dimensions; col++) {
+                for (size_t i = 0; i < dimensions; i++) {
+                    r[row * dimensions + col] += a[row * dimensions + i] * b[i * dimensions + col];
+                }
+            }
+        }
+        return data;
+    }
+
+    // storage times column vector
+    template <typename container_type>
+    static constexpr vector_type compute(const container_type& lhs, const vector_type& rhs) {
+        typename vector_type::data_type data{};
+
+        for (size_t row = 0; row < dimensions; row++) {
+            for (size_t col = 0; col < dimensions; col++) {
+                data[row] += lhs.raw()[row * dimensions + col] * rhs.data()[col];
+            }
+        }
+        return vector_type{data};
+    }
+
+    // row vector times storage
+    template <typename container_type>
+    static constexpr vector_type compute(const vector_type& lhs, const container_type& rhs) {
+        typename vector_type::data_type data{};
+
+        for (size_t row = 0; row < dimensions; row++) {
+            for (size_t col = 0; col < dimensions; col++) {
+                data[col] += lhs.data()[row] * rhs.raw()[row * dimensions + col];
+            }
+        }
+        return vector_type{data};
+    }
+
+    // row-at-a-time interface used to evaluate product expressions without
+    // materializing intermediate matrices
+    template <typename container_type>
+    static constexpr row_type load_row(const container_type& src, const size_t row) {
+        row_type result{};
+        for (size_t col = 0; col < dimensions; col++) {
+            result[col] = src.raw()[row * dimensions + col];
+        }
+        return result;
+    }
+
+    template <typename container_type>
+    static constexpr row_type multiply_row(const row_type& row, const container_type& rhs) {
+        row_type result{};
+        for (size_t col = 0; col < dimensions; col++) {
+            for (size_t i = 0; i < dimensions; i++) {
+                result[col] += row[i] * rhs.raw()[i * dimensions + col];
+            }
+        }
+        return result;
+    }
+
+    template <typename container_type>
+    static constexpr void store_row(const row_type& row, container_type& dst, const size_t index) {
+        for (size_t col = 0; col < dimensions; col++) {
+            dst.raw()[index * dimensions + col] = row[col];
+        }
+    }
+};
+
+// matrix::operator* dispatches here, specializations below replace the generic loops
+template<size_t dimensions, typename value_type>
+struct multiplicator : scalar_multiplicator<dimensions, value_type> {};
+
+#if defined(MATH_SIMD_SSE)
+template<>
+struct multiplicator<4, float> {
+    using vector_type = vector::vec4;
+    using row_type = __m128;
+
+    // every row of the result is a linear combination of rhs rows, accumulated
+    // in the same order as the scalar loop so both paths give identical results
+    template <typename container_type>
+    static container_type compute(const container_type& lhs, const container_type& rhs) {
+        container_type result;
+        const float* a = lhs.raw();
+        const float* b = rhs.raw();
+        float* r = result.raw();
+#if defined(MATH_SIMD_AVX)
+        // two result rows per iteration, each 128-bit lane handles one of them
+        const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b));
+        const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 4));
+        const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 8));
+        const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 12));
+
+        for (size_t row = 0; row < 4; row += 2) {
+            const __m256 rows = _mm256_loadu_ps(a + row * 4);
+            __m256 sum = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), b0);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x55), b1));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xaa), b2));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xff), b3));
+            _mm256_storeu_ps(r + row * 4, sum);
+        }
+#else
+        const __m128 b0 = _mm_loadu_ps(b);
+        const __m128 b1 = _mm_loadu_ps(b + 4);
+        const __m128 b2 = _mm_loadu_ps(b + 8);
+        const __m128 b3 = _mm_loadu_ps(b + 12);
+
+        for (size_t row = 0; row < 4; row++) {
+            const float* a_row = a + row * 4;
+            __m128 sum = _mm_mul_ps(_mm_set1_ps(a_row[0]), b0);
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a_row[1]), b1));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a_row[2]), b2));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a_row[3]), b3));
+            _mm_storeu_ps(r + row * 4, sum);
+        }
+#endif
+        return result;
+    }
+
+    // transposed rows are matrix columns, the result is their linear combination
+    template <typename container_type>
+    static vector_type compute(const container_type& lhs, const vector_type& rhs) {
+        const float* a = lhs.raw();
+        const float* v = rhs.data().data();
+
+        __m128 c0 = _mm_loadu_ps(a);
+        __m128 c1 = _mm_loadu_ps(a + 4);
+        __m128 c2 = _mm_loadu_ps(a + 8);
+        __m128 c3 = _mm_loadu_ps(a + 12);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+        __m128 sum = _mm_mul_ps(c0, _mm_set1_ps(v[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c1, _mm_set1_ps(v[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c2, _mm_set1_ps(v[2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c3, _mm_set1_ps(v[3])));
+
+        vector_type::data_type data;
+        _mm_storeu_ps(data.data(), sum);
+        return vector_type{data};
+    }
+
+    // the result is a linear combination of rows
+    template <typename container_type>
+    static vector_type compute(const vector_type& lhs, const container_type& rhs) {
+        vector_type::data_type data;
+        _mm_storeu_ps(data.data(), multiply_row(_mm_loadu_ps(lhs.data().data()), rhs));
+        return vector_type{data};
+    }
+
+    template <typename container_type>
+    static row_type load_row(const container_type& src, const size_t row) {
+        return _mm_loadu_ps(src.raw() + row * 4);
+    }
+
+    template <typename container_type>
+    static row_type multiply_row(const row_type& row, const container_type& rhs) {
+        const float* b = rhs.raw();
+        __m128 sum = _mm_mul_ps(_mm_shuffle_ps(row, row, 0x00), _mm_loadu_ps(b));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(row, row, 0x55), _mm_loadu_ps(b + 4)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xaa), _mm_loadu_ps(b + 8)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xff), _mm_loadu_ps(b + 12)));
+        return sum;
+    }
+
+    template <typename container_type>
+    static void store_row(const row_type& row, container_type& dst, const size_t index) {
+        _mm_storeu_ps(dst.raw() + index * 4, row);
+    }
+};
+#endif
+
+} // ns math
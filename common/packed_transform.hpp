@@ -0,0 +1,594 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "simd.hpp"
+#include "matrix.hpp"
+#include "quaternion.hpp"
+#include "transform.hpp"
+#include "vector.hpp"
+
+// compact per instance transforms for streaming to the GPU, decoded by the
+// functions in common/packed_transform.vert:
+//   packed_affine       48 bytes, exact for affine matrices
+//   packed_half_affine  24 bytes, the same layout in half floats
+//   packed_trs          16 bytes, quantized rotation, translation and scale
+// Batch pack/unpack use SSE: packed_trs 4 instances at a time, one component of
+// each per register, the affine layouts one instance at a time, one row per
+// register. Unpacked matrices equal what the shaders reconstruct
+
+namespace math {
+
+namespace detail {
+
+// IEEE 754 binary16, round to nearest even. Values beyond the half range become
+// infinity, NaNs stay NaN
+inline uint16_t float_to_half(const float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t result;
+    if (bits >= (127u + 16) << 23) {
+        result = bits > 255u << 23 ? 0x7e00 : 0x7c00;
+    } else if (bits < (127u - 14) << 23) {
+        // subnormal: adding the magic number lets the FPU do the rounding
+        const uint32_t magic_bits = ((127u - 15) + (23 - 10) + 1) << 23;
+        float magic, sum;
+        std::memcpy(&magic, &magic_bits, sizeof(magic));
+        std::memcpy(&sum, &bits, sizeof(sum));
+        sum += magic;
+        std::memcpy(&result, &sum, sizeof(result));
+        result -= magic_bits;
+    } else {
+        const uint32_t odd = (bits >> 13) & 1;
+        result = (bits + ((15u - 127) << 23) + 0xfff + odd) >> 13;
+    }
+    return uint16_t(result | sign >> 16);
+}
+
+inline float half_to_float(const uint16_t half) {
+    const uint32_t exponent_mask = 0x7c00u << 13;
+    uint32_t bits = (half & 0x7fffu) << 13;
+    const uint32_t exponent = bits & exponent_mask;
+    bits += (127u - 15) << 23;
+
+    float result;
+    if (exponent == exponent_mask) {
+        bits += (128u - 16) << 23;
+        std::memcpy(&result, &bits, sizeof(result));
+    } else if (!exponent) {
+        // subnormal: renormalized by the FPU
+        bits += 1 << 23;
+        std::memcpy(&result, &bits, sizeof(result));
+        result -= 6.103515625e-05f;
+    } else {
+        std::memcpy(&result, &bits, sizeof(result));
+    }
+    const uint32_t sign = uint32_t(half & 0x8000u) << 16;
+    uint32_t result_bits;
+    std::memcpy(&result_bits, &result, sizeof(result_bits));
+    result_bits |= sign;
+    std::memcpy(&result, &result_bits, sizeof(result));
+    return result;
+}
+
+#if defined(MATH_SIMD_SSE)
+// 4 floats to 4 halves in the low 64 bits
+inline __m128i float_to_half(const __m128 value) {
+#if defined(MATH_SIMD_F16C)
+    return _mm_cvtps_ph(value, _MM_FROUND_TO_NEAREST_INT);
+#else
+    // the scalar algorithm above with both branches evaluated and blended
+    const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(int(0x80000000u)));
+    const __m128i subnormal_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+
+    const __m128 sign = _mm_and_ps(value, sign_mask);
+    const __m128 magnitude = _mm_xor_ps(value, sign);
+    const __m128i bits = _mm_castps_si128(magnitude);
+    const __m128i regular = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), bits);
+    const __m128i nan = _mm_castps_si128(_mm_cmpunord_ps(magnitude, magnitude));
+    const __m128i special = _mm_or_si128(_mm_and_si128(nan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+    const __m128i subnormal = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), bits);
+
+    const __m128i subnormal_result = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(magnitude, _mm_castsi128_ps(subnormal_magic))), subnormal_magic);
+    const __m128i odd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+    const __m128i rounded = _mm_sub_epi32(_mm_add_epi32(bits, _mm_set1_epi32(0xfff - ((127 - 15) << 23))), odd);
+    const __m128i normal_result = _mm_srli_epi32(rounded, 13);
+
+    const __m128i finite = _mm_or_si128(_mm_and_si128(subnormal, subnormal_result), _mm_andnot_si128(subnormal, normal_result));
+    const __m128i joined = _mm_or_si128(_mm_and_si128(regular, finite), _mm_andnot_si128(regular, special));
+    const __m128i result = _mm_or_si128(joined, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+    // sign extension keeps the saturating pack from touching the low 16 bits
+    const __m128i extended = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+    return _mm_packs_epi32(extended, extended);
+#endif
+}
+
+// 4 halves in the low 64 bits to 4 floats
+inline __m128 half_to_float(const __m128i half) {
+#if defined(MATH_SIMD_F16C)
+    return _mm_cvtph_ps(half);
+#else
+    const __m128i value = _mm_unpacklo_epi16(half, _mm_setzero_si128());
+    const __m128i magnitude = _mm_and_si128(value, _mm_set1_epi32(0x7fff));
+    const __m128i sign = _mm_slli_epi32(_mm_xor_si128(value, magnitude), 16);
+    // multiplying by 2^112 rebiases the exponent and renormalizes subnormals
+    const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(magnitude, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+    const __m128i special = _mm_cmpgt_epi32(magnitude, _mm_set1_epi32(0x7bff));
+    const __m128 special_exponent = _mm_and_ps(_mm_castsi128_ps(special), _mm_castsi128_ps(_mm_set1_epi32(255 << 23)));
+    return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(sign), special_exponent));
+#endif
+}
+#endif
+
+} // ns detail
+
+// the first three columns of an affine row-major mat4f, one row per column:
+// (m[0][c], m[1][c], m[2][c], m[3][c]). The last column of affine matrices is
+// (0, 0, 0, 1) and not stored, each row is one vec4 instance attribute
+class alignas(16) packed_affine {
+
+public:
+    using data_type = std::array<float, 12>;
+
+    packed_affine():
+        m_data{} {}
+
+    explicit packed_affine(const mat4f& matrix) {
+        const float* m = matrix.container().raw();
+        for (size_t col = 0; col < 3; col++) {
+            for (size_t row = 0; row < 4; row++) {
+                m_data[col * 4 + row] = m[row * 4 + col];
+            }
+        }
+    }
+
+    mat4f unpack() const {
+        mat4f::container_type data;
+        float* m = data.raw();
+        for (size_t row = 0; row < 4; row++) {
+            for (size_t col = 0; col < 3; col++) {
+                m[row * 4 + col] = m_data[col * 4 + row];
+            }
+            m[row * 4 + 3] = row == 3;
+        }
+        return mat4f{data};
+    }
+
+    const data_type& data() const {
+        return m_data;
+    }
+
+    data_type& data() {
+        return m_data;
+    }
+
+private:
+    data_type m_data;
+};
+
+// packed_affine in half floats, uploads as GL_HALF_FLOAT vec4 attributes. Elements
+// keep a relative error below 2^-11, translations need to stay well within +-65504
+class alignas(8) packed_half_affine {
+
+public:
+    using data_type = std::array<uint16_t, 12>;
+
+    packed_half_affine():
+        m_data{} {}
+
+    explicit packed_half_affine(const mat4f& matrix) {
+        const packed_affine affine(matrix);
+        for (size_t index = 0; index < 12; index++) {
+            m_data[index] = detail::float_to_half(affine.data()[index]);
+        }
+    }
+
+    mat4f unpack() const {
+        packed_affine affine;
+        for (size_t index = 0; index < 12; index++) {
+            affine.data()[index] = detail::half_to_float(m_data[index]);
+        }
+        return affine.unpack();
+    }
+
+    const data_type& data() const {
+        return m_data;
+    }
+
+    data_type& data() {
+        return m_data;
+    }
+
+private:
+    data_type m_data;
+};
+
+// translations of packed_trs are quantized within origin + [0, extent], e.g. the
+// bounds of the scene or of one instance batch. The shader gets the same range
+struct quantization_range {
+    vector::vec3 origin;
+    vector::vec3 extent;
+};
+
+// trs() style transforms, scale(s) * rotation * translate(t), in one uvec4:
+//   x: rotation, smallest three: bits 30-31 index of the dropped largest component,
+//      three times 10 bits of the others in [-1/sqrt(2), 1/sqrt(2)]
+//   y: translation x | y << 16, 16 bit fractions of the quantization range
+//   z: translation z | half scale x << 16
+//   w: half scale y | half scale z << 16
+// Rotation components are off by at most 7e-4, translations by half a 1/65535 step
+// of the range, scales by a relative 2^-11. Scales have to be positive
+class alignas(16) packed_trs {
+
+public:
+    using data_type = std::array<uint32_t, 4>;
+
+    static constexpr float component_range = 0.70710678f;
+    static constexpr float component_steps = 1023;
+    static constexpr float translation_steps = 65535;
+
+    packed_trs():
+        m_data{} {}
+
+    packed_trs(const vector::vec3& translation, const quat& rotation, const vector::vec3& scale, const quantization_range& range) {
+        // the largest component is dropped, the sign of the quaternion makes it positive
+        size_t largest = 0;
+        for (size_t i = 1; i < 4; i++) {
+            if (std::fabs(rotation.data()[i]) > std::fabs(rotation.data()[largest])) {
+                largest = i;
+            }
+        }
+        const float sign = rotation.data()[largest] < 0 ? -1.f : 1.f;
+        uint32_t packed_rotation = uint32_t(largest) << 30;
+        for (size_t i = 0, shift = 20; i < 4; i++) {
+            if (i != largest) {
+                packed_rotation |= quantize(rotation.data()[i] * sign * (.5f / component_range) + .5f, component_steps) << shift;
+                shift -= 10;
+            }
+        }
+
+        uint32_t position[3];
+        for (size_t axis = 0; axis < 3; axis++) {
+            position[axis] = quantize((translation[axis] - range.origin[axis]) / range.extent[axis], translation_steps);
+        }
+        m_data[0] = packed_rotation;
+        m_data[1] = position[0] | position[1] << 16;
+        m_data[2] = position[2] | uint32_t(detail::float_to_half(scale[0])) << 16;
+        m_data[3] = detail::float_to_half(scale[1]) | uint32_t(detail::float_to_half(scale[2])) << 16;
+    }
+
+    // decomposes matrices built like trs(), without shear and with positive scales
+    packed_trs(const mat4f& matrix, const quantization_range& range):
+        packed_trs(decompose(matrix, range)) {}
+
+    quat rotation() const {
+        const size_t largest = m_data[0] >> 30;
+        float components[4];
+        float sum = 0;
+        for (size_t i = 0, shift = 20; i < 4; i++) {
+            if (i != largest) {
+                const float value = ((m_data[0] >> shift & 1023) * (1 / component_steps) - .5f) * (2 * component_range);
+                components[i] = value;
+                sum += value * value;
+                shift -= 10;
+            }
+        }
+        components[largest] = std::sqrt(std::fmax(0.f, 1 - sum));
+        return quat{components[0], components[1], components[2], components[3]};
+    }
+
+    vector::vec3 translation(const quantization_range& range) const {
+        const uint32_t position[3] = {m_data[1] & 0xffff, m_data[1] >> 16, m_data[2] & 0xffff};
+        vector::vec3 result;
+        for (size_t axis = 0; axis < 3; axis++) {
+            result[axis] = range.origin[axis] + position[axis] * (1 / translation_steps) * range.extent[axis];
+        }
+        return result;
+    }
+
+    vector::vec3 scale() const {
+        return vector::vec3({detail::half_to_float(uint16_t(m_data[2] >> 16)), detail::half_to_float(uint16_t(m_data[3])),
+                             detail::half_to_float(uint16_t(m_data[3] >> 16)), 0});
+    }
+
+    mat4f unpack(const quantization_range& range) const {
+        float r[9];
+        rotation().rotation(r);
+        mat4f::container_type data;
+        detail::compose(r, translation(range), scale(), data.raw());
+        return mat4f{data};
+    }
+
+    const data_type& data() const {
+        return m_data;
+    }
+
+    data_type& data() {
+        return m_data;
+    }
+
+private:
+
+    static uint32_t quantize(const float fraction, const float steps) {
+        return uint32_t(std::nearbyint(std::fmin(std::fmax(fraction, 0.f), 1.f) * steps));
+    }
+
+    static packed_trs decompose(const mat4f& matrix, const quantization_range& range) {
+        const float* m = matrix.container().raw();
+        vector::vec3 scale;
+        float r[9];
+        for (size_t row = 0; row < 3; row++) {
+            const float* source = m + row * 4;
+            scale[row] = std::sqrt(source[0] * source[0] + source[1] * source[1] + source[2] * source[2]);
+            for (size_t col = 0; col < 3; col++) {
+                r[row * 3 + col] = source[col] / scale[row];
+            }
+        }
+        return packed_trs{vector::vec3({m[12], m[13], m[14], 0}), quat::from_rotation(r), scale, range};
+    }
+
+    data_type m_data;
+};
+
+static_assert(sizeof(packed_affine) == 48 && sizeof(packed_half_affine) == 24 && sizeof(packed_trs) == 16,
+              "packed transforms are uploaded as is");
+
+namespace detail {
+
+#if defined(MATH_SIMD_SSE)
+// rows 0 - 2 of the transposed matrix are the packed_affine rows
+inline void transposed_rows(const mat4f& matrix, __m128 (&rows)[4]) {
+    const float* m = matrix.container().raw();
+    rows[0] = _mm_load_ps(m);
+    rows[1] = _mm_load_ps(m + 4);
+    rows[2] = _mm_load_ps(m + 8);
+    rows[3] = _mm_load_ps(m + 12);
+    _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+}
+
+inline void store_transposed(__m128 (&rows)[4], mat4f& matrix) {
+    rows[3] = _mm_set_ps(1, 0, 0, 0);
+    _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+    float* m = matrix.container().raw();
+    _mm_store_ps(m, rows[0]);
+    _mm_store_ps(m + 4, rows[1]);
+    _mm_store_ps(m + 8, rows[2]);
+    _mm_store_ps(m + 12, rows[3]);
+}
+
+// four vec3 as x, y and z registers
+inline void load_lanes(const vector::vec3* source, __m128 (&lanes)[3]) {
+    __m128 w = _mm_load_ps(source[3].data().data());
+    lanes[0] = _mm_load_ps(source[0].data().data());
+    lanes[1] = _mm_load_ps(source[1].data().data());
+    lanes[2] = _mm_load_ps(source[2].data().data());
+    _MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], w);
+}
+
+inline __m128i quantize(const __m128 fraction, const float steps) {
+    const __m128 clamped = _mm_min_ps(_mm_max_ps(fraction, _mm_setzero_ps()), _mm_set1_ps(1));
+    return _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(steps)));
+}
+#endif
+
+} // ns detail
+
+// count matrices at a time, the packed and unpacked arrays must not overlap
+inline void pack(const mat4f* matrices, packed_affine* result, const size_t count) {
+    size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+    for (; i < count; i++) {
+        __m128 rows[4];
+        detail::transposed_rows(matrices[i], rows);
+        float* target = result[i].data().data();
+        _mm_store_ps(target, rows[0]);
+        _mm_store_ps(target + 4, rows[1]);
+        _mm_store_ps(target + 8, rows[2]);
+    }
+#endif
+    for (; i < count; i++) {
+        result[i] = packed_affine{matrices[i]};
+    }
+}
+
+inline void unpack(const packed_affine* packed, mat4f* result, const size_t count) {
+    size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+    for (; i < count; i++) {
+        const float* source = packed[i].data().data();
+        __m128 rows[4] = {_mm_load_ps(source), _mm_load_ps(source + 4), _mm_load_ps(source + 8)};
+        detail::store_transposed(rows, result[i]);
+    }
+#endif
+    for (; i < count; i++) {
+        result[i] = packed[i].unpack();
+    }
+}
+
+inline void pack(const mat4f* matrices, packed_half_affine* result, const size_t count) {
+    size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+    for (; i < count; i++) {
+        __m128 rows[4];
+        detail::transposed_rows(matrices[i], rows);
+        char* target = reinterpret_cast<char*>(result[i].data().data());
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(target), detail::float_to_half(rows[0]));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(target + 8), detail::float_to_half(rows[1]));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(target + 16), detail::float_to_half(rows[2]));
+    }
+#endif
+    for (; i < count; i++) {
+        result[i] = packed_half_affine{matrices[i]};
+    }
+}
+
+inline void unpack(const packed_half_affine* packed, mat4f* result, const size_t count) {
+    size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+    for (; i < count; i++) {
+        const char* source = reinterpret_cast<const char*>(packed[i].data().data());
+        __m128 rows[4] = {detail::half_to_float(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source))),
+                          detail::half_to_float(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + 8))),
+                          detail::half_to_float(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + 16)))};
+        detail::store_transposed(rows, result[i]);
+    }
+#endif
+    for (; i < count; i++) {
+        result[i] = packed[i].unpack();
+    }
+}
+
+// four instances per iteration, every register holds one component of all four
+inline void pack(const vector::vec3* translations, const quat* rotations, const vector::vec3* scales,
+                 packed_trs* result, const size_t count, const quantization_range& range) {
+    size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+    const __m128i one = _mm_set1_epi32(1);
+    for (; i + 4 <= count; i += 4) {
+        const detail::quat_lanes q = detail::quat_lanes::load(rotations + i);
+        const __m128 sign_bit = _mm_set1_ps(-0.f);
+        const __m128 magnitudes[4] = {_mm_andnot_ps(sign_bit, q.x), _mm_andnot_ps(sign_bit, q.y),
+                                      _mm_andnot_ps(sign_bit, q.z), _mm_andnot_ps(sign_bit, q.w)};
+        const __m128 components[4] = {q.x, q.y, q.z, q.w};
+
+        // first largest magnitude wins ties, as in the scalar loop
+        __m128 largest_magnitude = magnitudes[0];
+        __m128 largest_value = components[0];
+        __m128i largest = _mm_setzero_si128();
+        for (int component = 1; component < 4; component++) {
+            const __m128 greater = _mm_cmpgt_ps(magnitudes[component], largest_magnitude);
+            largest_magnitude = _mm_max_ps(magnitudes[component], largest_magnitude);
+            largest_value = simd::select(greater, components[component], largest_value);
+            largest = _mm_or_si128(_mm_and_si128(_mm_castps_si128(greater), _mm_set1_epi32(component)),
+                                   _mm_andnot_si128(_mm_castps_si128(greater), largest));
+        }
+        const __m128 sign = _mm_and_ps(largest_value, sign_bit);
+        const __m128 dropped_x = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_setzero_si128()));
+        const __m128 dropped_y = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, one));
+        const __m128 dropped_z = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(2)));
+        // the three kept components in order
+        const __m128 kept[3] = {
+            simd::select(dropped_x, q.y, q.x),
+            simd::select(_mm_or_ps(dropped_x, dropped_y), q.z, q.y),
+            simd::select(_mm_or_ps(_mm_or_ps(dropped_x, dropped_y), dropped_z), q.w, q.z)
+        };
+        __m128i packed_rotation = _mm_slli_epi32(largest, 30);
+        for (int component = 0; component < 3; component++) {
+            const __m128 value = _mm_xor_ps(kept[component], sign);
+            const __m128 fraction = _mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(.5f / packed_trs::component_range)), _mm_set1_ps(.5f));
+            packed_rotation = _mm_or_si128(packed_rotation, _mm_slli_epi32(detail::quantize(fraction, packed_trs::component_steps), 20 - 10 * component));
+        }
+
+        __m128 translation[3], scale[3];
+        detail::load_lanes(translations + i, translation);
+        detail::load_lanes(scales + i, scale);
+        __m128i position[3], half_scale[3];
+        for (int axis = 0; axis < 3; axis++) {
+            const __m128 fraction = _mm_div_ps(_mm_sub_ps(translation[axis], _mm_set1_ps(range.origin[axis])), _mm_set1_ps(range.extent[axis]));
+            position[axis] = detail::quantize(fraction, packed_trs::translation_steps);
+            half_scale[axis] = _mm_unpacklo_epi16(detail::float_to_half(scale[axis]), _mm_setzero_si128());
+        }
+
+        __m128 words[4] = {
+            _mm_castsi128_ps(packed_rotation),
+            _mm_castsi128_ps(_mm_or_si128(position[0], _mm_slli_epi32(position[1], 16))),
+            _mm_castsi128_ps(_mm_or_si128(position[2], _mm_slli_epi32(half_scale[0], 16))),
+            _mm_castsi128_ps(_mm_or_si128(half_scale[1], _mm_slli_epi32(half_scale[2], 16)))
+        };
+        _MM_TRANSPOSE4_PS(words[0], words[1], words[2], words[3]);
+        for (int lane = 0; lane < 4; lane++) {
+            _mm_store_ps(reinterpret_cast<float*>(result[i + lane].data().data()), words[lane]);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        result[i] = packed_trs{translations[i], rotations[i], scales[i], range};
+    }
+}
+
+inline void unpack(const packed_trs* packed, mat4f* result, const size_t count, const quantization_range& range) {
+    size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+    const __m128i ten_bits = _mm_set1_epi32(1023);
+    const __m128i sixteen_bits = _mm_set1_epi32(0xffff);
+    for (; i + 4 <= count; i += 4) {
+        __m128 words[4];
+        for (int lane = 0; lane < 4; lane++) {
+            words[lane] = _mm_load_ps(reinterpret_cast<const float*>(packed[i + lane].data().data()));
+        }
+        _MM_TRANSPOSE4_PS(words[0], words[1], words[2], words[3]);
+        const __m128i rotation = _mm_castps_si128(words[0]);
+
+        __m128 kept[3];
+        __m128 sum = _mm_setzero_ps();
+        for (int component = 0; component < 3; component++) {
+            const __m128i quantized = _mm_and_si128(_mm_srli_epi32(rotation, 20 - 10 * component), ten_bits);
+            const __m128 fraction = _mm_mul_ps(_mm_cvtepi32_ps(quantized), _mm_set1_ps(1 / packed_trs::component_steps));
+            kept[component] = _mm_mul_ps(_mm_sub_ps(fraction, _mm_set1_ps(.5f)), _mm_set1_ps(2 * packed_trs::component_range));
+            sum = _mm_add_ps(sum, _mm_mul_ps(kept[component], kept[component]));
+        }
+        const __m128 dropped = _mm_sqrt_ps(_mm_max_ps(_mm_setzero_ps(), _mm_sub_ps(_mm_set1_ps(1), sum)));
+        const __m128i largest = _mm_srli_epi32(rotation, 30);
+        const __m128 dropped_x = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_setzero_si128()));
+        const __m128 dropped_y = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(1)));
+        const __m128 dropped_z = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(2)));
+        const __m128 dropped_w = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(3)));
+        const __m128 x = simd::select(dropped_x, dropped, kept[0]);
+        const __m128 y = simd::select(dropped_x, kept[0], simd::select(dropped_y, dropped, kept[1]));
+        const __m128 z = simd::select(dropped_w, kept[2], simd::select(dropped_z, dropped, kept[1]));
+        const __m128 w = simd::select(dropped_w, dropped, kept[2]);
+
+        const __m128i positions[3] = {_mm_and_si128(_mm_castps_si128(words[1]), sixteen_bits),
+                                      _mm_srli_epi32(_mm_castps_si128(words[1]), 16),
+                                      _mm_and_si128(_mm_castps_si128(words[2]), sixteen_bits)};
+        const __m128i halves = _mm_packs_epi32(_mm_srai_epi32(_mm_castps_si128(words[2]), 16),
+                                               _mm_srai_epi32(_mm_slli_epi32(_mm_castps_si128(words[3]), 16), 16));
+        const __m128 scale[3] = {detail::half_to_float(halves),
+                                 detail::half_to_float(_mm_srli_si128(halves, 8)),
+                                 detail::half_to_float(_mm_packs_epi32(_mm_srai_epi32(_mm_castps_si128(words[3]), 16), _mm_setzero_si128()))};
+
+        // rotation block as in quat::rotation(), rows scaled
+        const __m128 two = _mm_set1_ps(2);
+        const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+        const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+        const __m128 xw = _mm_mul_ps(x, w), yw = _mm_mul_ps(y, w), zw = _mm_mul_ps(z, w);
+        const __m128 one = _mm_set1_ps(1);
+        const __m128 r[9] = {
+            _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), _mm_mul_ps(two, _mm_add_ps(xy, zw)), _mm_mul_ps(two, _mm_sub_ps(xz, yw)),
+            _mm_mul_ps(two, _mm_sub_ps(xy, zw)), _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), _mm_mul_ps(two, _mm_add_ps(yz, xw)),
+            _mm_mul_ps(two, _mm_add_ps(xz, yw)), _mm_mul_ps(two, _mm_sub_ps(yz, xw)), _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)))
+        };
+
+        __m128 rows[4][4];
+        for (int row = 0; row < 3; row++) {
+            for (int col = 0; col < 3; col++) {
+                rows[row][col] = _mm_mul_ps(r[row * 3 + col], scale[row]);
+            }
+            rows[row][3] = _mm_setzero_ps();
+        }
+        for (int axis = 0; axis < 3; axis++) {
+            const __m128 fraction = _mm_mul_ps(_mm_cvtepi32_ps(positions[axis]), _mm_set1_ps(1 / packed_trs::translation_steps));
+            rows[3][axis] = _mm_add_ps(_mm_set1_ps(range.origin[axis]), _mm_mul_ps(fraction, _mm_set1_ps(range.extent[axis])));
+        }
+        rows[3][3] = one;
+
+        // element registers to one row per instance
+        for (int row = 0; row < 4; row++) {
+            _MM_TRANSPOSE4_PS(rows[row][0], rows[row][1], rows[row][2], rows[row][3]);
+            for (int lane = 0; lane < 4; lane++) {
+                _mm_store_ps(result[i + lane].container().raw() + row * 4, rows[row][lane]);
+            }
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        result[i] = packed[i].unpack(range);
+    }
+}
+
+} // ns math
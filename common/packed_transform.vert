@@ -0,0 +1,63 @@
+#version 130
+
+// decoders for the packed instance transforms of common/packed_transform.hpp. Load
+// this file as an additional vertex shader of the program and declare the decoders
+// the main vertex shader uses, e.g.
+//
+//   mat4 decode_trs(uvec4 packed, vec3 origin, vec3 extent);
+//
+// Every decoder returns the mat4 a shader sees for the unpacked matrix uploaded
+// with GL_FALSE, i.e. it replaces a `uniform mat4 matrix` as is
+
+// packed_affine as three GL_FLOAT vec4 attributes, or packed_half_affine as three
+// GL_HALF_FLOAT vec4 attributes: the vertex fetch converts the halves already
+mat4 decode_affine(vec4 row0, vec4 row1, vec4 row2) {
+  return transpose(mat4(row0, row1, row2, vec4(0.0, 0.0, 0.0, 1.0)));
+}
+
+// finite halves only, the packed formats never hold infinities or NaNs
+float decode_half(uint bits) {
+  uint exponent = (bits >> 10u) & 31u;
+  uint mantissa = bits & 1023u;
+  float magnitude = exponent == 0u ? float(mantissa) * exp2(-24.0)
+                                   : float(mantissa + 1024u) * exp2(float(exponent) - 25.0);
+  return (bits & 32768u) != 0u ? -magnitude : magnitude;
+}
+
+vec2 decode_half2(uint bits) {
+  return vec2(decode_half(bits & 65535u), decode_half(bits >> 16u));
+}
+
+// packed_half_affine read as six uints, e.g. from two uvec3 attributes
+mat4 decode_half_affine(uvec3 first, uvec3 second) {
+  return decode_affine(vec4(decode_half2(first.x), decode_half2(first.y)),
+                       vec4(decode_half2(first.z), decode_half2(second.x)),
+                       vec4(decode_half2(second.y), decode_half2(second.z)));
+}
+
+// packed_trs as one uvec4 attribute (glVertexAttribIPointer), origin and extent are
+// the quantization_range used for packing
+mat4 decode_trs(uvec4 packed, vec3 origin, vec3 extent) {
+  const float component_range = 0.70710678;
+  vec3 kept = vec3((uvec3(packed.x) >> uvec3(20u, 10u, 0u)) & 1023u) / 1023.0;
+  kept = (kept - 0.5) * (2.0 * component_range);
+  float dropped = sqrt(max(0.0, 1.0 - dot(kept, kept)));
+  uint largest = packed.x >> 30u;
+  vec4 q = largest == 0u ? vec4(dropped, kept)
+         : largest == 1u ? vec4(kept.x, dropped, kept.yz)
+         : largest == 2u ? vec4(kept.xy, dropped, kept.z)
+         : vec4(kept, dropped);
+
+  vec3 position = vec3(packed.y & 65535u, packed.y >> 16u, packed.z & 65535u) / 65535.0;
+  vec3 translation = origin + position * extent;
+  vec3 scale = vec3(decode_half(packed.z >> 16u), decode_half2(packed.w));
+
+  // matrix rows as in quat::rotation(), scaled; the shader sees them as columns
+  float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+  float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+  float xw = q.x * q.w, yw = q.y * q.w, zw = q.z * q.w;
+  vec3 row0 = vec3(1.0 - 2.0 * (yy + zz), 2.0 * (xy + zw), 2.0 * (xz - yw)) * scale.x;
+  vec3 row1 = vec3(2.0 * (xy - zw), 1.0 - 2.0 * (xx + zz), 2.0 * (yz + xw)) * scale.y;
+  vec3 row2 = vec3(2.0 * (xz + yw), 2.0 * (yz - xw), 1.0 - 2.0 * (xx + yy)) * scale.z;
+  return mat4(vec4(row0, 0.0), vec4(row1, 0.0), vec4(row2, 0.0), vec4(translation, 1.0));
+}
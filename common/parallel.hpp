@@ -0,0 +1,26 @@
+#pragma once
+
+#include <algorithm>
+#include "job_system.hpp"
+
+namespace math {
+namespace detail {
+
+// runs body(begin, end) over [0, count) as up to threads jobs of the shared job
+// system. Jobs cost more than a few thousand cheap items, min_chunk is the
+// smallest count worth a job of its own
+template <typename body_type>
+void split(const size_t count, size_t threads, const body_type& body, const size_t min_chunk = 1 << 14) {
+    threads = std::min(threads, std::max<size_t>(1, count / min_chunk));
+    if (threads <= 1) {
+        body(size_t(0), count);
+        return;
+    }
+
+    // multiples of 8 keep every chunk but the last free of scalar tails
+    const size_t chunk = ((count + threads - 1) / threads + 7) & ~size_t(7);
+    common::job_system::shared().parallel_chunks(count, chunk, body);
+}
+
+} // ns detail
+} // ns math
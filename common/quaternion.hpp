@@ -0,0 +1,295 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <ostream>
+#include "simd.hpp"
+#include "matrix.hpp"
+#include "transform.hpp"
+#include "vector.hpp"
+
+namespace math {
+
+// rotation quaternion (x, y, z, w). q1 * q2 applies q2 first; in the matrix layout
+// used by rotate_x/y/z that becomes (q1 * q2).to_mat4() == q2.to_mat4() * q1.to_mat4()
+class alignas(16) quat {
+
+public:
+    using data_type = std::array<float, 4>;
+
+    constexpr quat():
+        m_data{0, 0, 0, 1} {}
+    constexpr quat(const float x, const float y, const float z, const float w):
+        m_data{x, y, z, w} {}
+
+    static quat from_axis_angle(const axis_angle& rotation) {
+        const float half = rotation.angle * .5f;
+        const float s = std::sin(half);
+        return quat{rotation.axis.data()[0] * s, rotation.axis.data()[1] * s, rotation.axis.data()[2] * s, std::cos(half)};
+    }
+
+    // inverse of rotation(), r has to be orthonormal
+    static quat from_rotation(const float (&r)[9]) {
+        const float trace = r[0] + r[4] + r[8];
+        if (trace > 0) {
+            const float s = std::sqrt(trace + 1) * 2;
+            return quat{(r[5] - r[7]) / s, (r[6] - r[2]) / s, (r[1] - r[3]) / s, s * .25f};
+        }
+        if (r[0] > r[4] && r[0] > r[8]) {
+            const float s = std::sqrt(1 + r[0] - r[4] - r[8]) * 2;
+            return quat{s * .25f, (r[1] + r[3]) / s, (r[2] + r[6]) / s, (r[5] - r[7]) / s};
+        }
+        if (r[4] > r[8]) {
+            const float s = std::sqrt(1 + r[4] - r[0] - r[8]) * 2;
+            return quat{(r[1] + r[3]) / s, s * .25f, (r[5] + r[7]) / s, (r[6] - r[2]) / s};
+        }
+        const float s = std::sqrt(1 + r[8] - r[0] - r[4]) * 2;
+        return quat{(r[2] + r[6]) / s, (r[5] + r[7]) / s, s * .25f, (r[1] - r[3]) / s};
+    }
+
+    constexpr float x() const { return m_data[0]; }
+    constexpr float y() const { return m_data[1]; }
+    constexpr float z() const { return m_data[2]; }
+    constexpr float w() const { return m_data[3]; }
+
+    constexpr const data_type& data() const {
+        return m_data;
+    }
+
+    constexpr data_type& data() {
+        return m_data;
+    }
+
+    constexpr quat operator*(const quat& rhs) const {
+        return quat{
+            w() * rhs.x() + x() * rhs.w() + y() * rhs.z() - z() * rhs.y(),
+            w() * rhs.y() - x() * rhs.z() + y() * rhs.w() + z() * rhs.x(),
+            w() * rhs.z() + x() * rhs.y() - y() * rhs.x() + z() * rhs.w(),
+            w() * rhs.w() - x() * rhs.x() - y() * rhs.y() - z() * rhs.z()
+        };
+    }
+
+    constexpr bool operator==(const quat& rhs) const {
+        return x() == rhs.x() && y() == rhs.y() && z() == rhs.z() && w() == rhs.w();
+    }
+
+    constexpr quat conjugate() const {
+        return quat{-x(), -y(), -z(), w()};
+    }
+
+    constexpr float dot(const quat& rhs) const {
+        return x() * rhs.x() + y() * rhs.y() + z() * rhs.z() + w() * rhs.w();
+    }
+
+    float length() const {
+        return std::sqrt(dot(*this));
+    }
+
+    quat normalize() const {
+        const float inv = 1 / length();
+        return quat{x() * inv, y() * inv, z() * inv, w() * inv};
+    }
+
+    // rotation block in the rotate_x/y/z layout
+    void rotation(float (&r)[9]) const {
+        const float xx = x() * x(), yy = y() * y(), zz = z() * z();
+        const float xy = x() * y(), xz = x() * z(), yz = y() * z();
+        const float xw = x() * w(), yw = y() * w(), zw = z() * w();
+
+        r[0] = 1 - 2 * (yy + zz);
+        r[1] = 2 * (xy + zw);
+        r[2] = 2 * (xz - yw);
+        r[3] = 2 * (xy - zw);
+        r[4] = 1 - 2 * (xx + zz);
+        r[5] = 2 * (yz + xw);
+        r[6] = 2 * (xz + yw);
+        r[7] = 2 * (yz - xw);
+        r[8] = 1 - 2 * (xx + yy);
+    }
+
+    mat3f to_mat3() const {
+        float r[9];
+        rotation(r);
+        mat3f::container_type data;
+        for (size_t i = 0; i < 9; i++) {
+            data[i] = r[i];
+        }
+        return mat3f{data};
+    }
+
+    mat4f to_mat4() const {
+        float r[9];
+        rotation(r);
+        mat4f::container_type data;
+        detail::compose(r, vector::vec3({0, 0, 0}), vector::vec3({1, 1, 1}), data.raw());
+        return mat4f{data};
+    }
+
+private:
+
+    data_type m_data;
+};
+
+inline std::ostream& operator<<(std::ostream& out, const quat& rhs) {
+    out << "(" << rhs.x() << ", " << rhs.y() << ", " << rhs.z() << ", " << rhs.w() << ")";
+    return out;
+}
+
+// both interpolations take the shorter arc
+inline quat nlerp(const quat& from, const quat& to, const float t) {
+    const float sign = from.dot(to) < 0 ? -1.f : 1.f;
+    const float a = 1 - t;
+    const float b = t * sign;
+    return quat{a * from.x() + b * to.x(), a * from.y() + b * to.y(),
+                a * from.z() + b * to.z(), a * from.w() + b * to.w()}.normalize();
+}
+
+inline quat slerp(const quat& from, const quat& to, const float t) {
+    float cosine = from.dot(to);
+    const float sign = cosine < 0 ? -1.f : 1.f;
+    cosine *= sign;
+
+    float a = 1 - t;
+    float b = t;
+    // nearly parallel quaternions: sin(theta) vanishes, linear weights are exact enough
+    if (cosine < .9995f) {
+        const float theta = std::acos(cosine);
+        const float inv = 1 / std::sin(theta);
+        a = std::sin(a * theta) * inv;
+        b = std::sin(b * theta) * inv;
+    }
+    b *= sign;
+    return quat{a * from.x() + b * to.x(), a * from.y() + b * to.y(),
+                a * from.z() + b * to.z(), a * from.w() + b * to.w()}.normalize();
+}
+
+namespace detail {
+
+#if defined(MATH_SIMD_SSE)
+// four quaternions per call, transposed so that every register holds one component
+struct quat_lanes {
+    __m128 x, y, z, w;
+
+    static quat_lanes load(const quat* source) {
+        quat_lanes lanes{_mm_load_ps(source[0].data().data()), _mm_load_ps(source[1].data().data()),
+                         _mm_load_ps(source[2].data().data()), _mm_load_ps(source[3].data().data())};
+        _MM_TRANSPOSE4_PS(lanes.x, lanes.y, lanes.z, lanes.w);
+        return lanes;
+    }
+
+    void store(quat* destination) {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_store_ps(destination[0].data().data(), x);
+        _mm_store_ps(destination[1].data().data(), y);
+        _mm_store_ps(destination[2].data().data(), z);
+        _mm_store_ps(destination[3].data().data(), w);
+    }
+
+    __m128 dot(const quat_lanes& rhs) const {
+        __m128 result = _mm_mul_ps(x, rhs.x);
+        result = _mm_add_ps(result, _mm_mul_ps(y, rhs.y));
+        result = _mm_add_ps(result, _mm_mul_ps(z, rhs.z));
+        return _mm_add_ps(result, _mm_mul_ps(w, rhs.w));
+    }
+
+    static quat_lanes blend(const quat_lanes& from, const __m128 a, const quat_lanes& to, const __m128 b) {
+        quat_lanes result{_mm_add_ps(_mm_mul_ps(from.x, a), _mm_mul_ps(to.x, b)),
+                          _mm_add_ps(_mm_mul_ps(from.y, a), _mm_mul_ps(to.y, b)),
+                          _mm_add_ps(_mm_mul_ps(from.z, a), _mm_mul_ps(to.z, b)),
+                          _mm_add_ps(_mm_mul_ps(from.w, a), _mm_mul_ps(to.w, b))};
+        const __m128 inv = _mm_div_ps(_mm_set1_ps(1), _mm_sqrt_ps(result.dot(result)));
+        result.x = _mm_mul_ps(result.x, inv);
+        result.y = _mm_mul_ps(result.y, inv);
+        result.z = _mm_mul_ps(result.z, inv);
+        result.w = _mm_mul_ps(result.w, inv);
+        return result;
+    }
+};
+
+// acos on [0, 1], Abramowitz & Stegun 4.4.46, |error| <= 2e-8
+inline __m128 acos_unit(const __m128 x) {
+    __m128 p = _mm_set1_ps(-0.0012624911f);
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0066700901f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.0170881256f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0308918810f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.0501743046f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0889789874f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.2145988016f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(1.5707963050f));
+    return _mm_mul_ps(p, _mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1), x)));
+}
+
+// sin on [0, pi / 2], Taylor series up to x^11, |error| < 1e-7
+inline __m128 sin_quadrant(const __m128 x) {
+    const __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_set1_ps(-1.f / 39916800);
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.f / 362880));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.f / 5040));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.f / 120));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.f / 6));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1));
+    return _mm_mul_ps(p, x);
+}
+
+// flips the target of every lane with a negative dot product, returns |dot|
+inline __m128 shorter_arc(const quat_lanes& from, quat_lanes& to) {
+    const __m128 sign_bit = _mm_set1_ps(-0.f);
+    const __m128 cosine = from.dot(to);
+    const __m128 sign = _mm_and_ps(cosine, sign_bit);
+    to.x = _mm_xor_ps(to.x, sign);
+    to.y = _mm_xor_ps(to.y, sign);
+    to.z = _mm_xor_ps(to.z, sign);
+    to.w = _mm_xor_ps(to.w, sign);
+    return _mm_andnot_ps(sign_bit, cosine);
+}
+#endif
+
+} // ns detail
+
+// batch interpolation of count quaternion pairs with a weight per pair
+inline void nlerp(const quat* from, const quat* to, const float* t, quat* result, const size_t count) {
+    size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+    for (; i + 4 <= count; i += 4) {
+        const detail::quat_lanes a = detail::quat_lanes::load(from + i);
+        detail::quat_lanes b = detail::quat_lanes::load(to + i);
+        detail::shorter_arc(a, b);
+
+        const __m128 weight = _mm_loadu_ps(t + i);
+        detail::quat_lanes::blend(a, _mm_sub_ps(_mm_set1_ps(1), weight), b, weight).store(result + i);
+    }
+#endif
+    for (; i < count; i++) {
+        result[i] = nlerp(from[i], to[i], t[i]);
+    }
+}
+
+inline void slerp(const quat* from, const quat* to, const float* t, quat* result, const size_t count) {
+    size_t i = 0;
+#if defined(MATH_SIMD_SSE)
+    const __m128 one = _mm_set1_ps(1);
+    for (; i + 4 <= count; i += 4) {
+        const detail::quat_lanes a = detail::quat_lanes::load(from + i);
+        detail::quat_lanes b = detail::quat_lanes::load(to + i);
+        const __m128 cosine = _mm_min_ps(detail::shorter_arc(a, b), one);
+
+        const __m128 weight = _mm_loadu_ps(t + i);
+        const __m128 linear_a = _mm_sub_ps(one, weight);
+
+        const __m128 theta = detail::acos_unit(cosine);
+        const __m128 inv = _mm_div_ps(one, detail::sin_quadrant(theta));
+        const __m128 spherical_a = _mm_mul_ps(detail::sin_quadrant(_mm_mul_ps(linear_a, theta)), inv);
+        const __m128 spherical_b = _mm_mul_ps(detail::sin_quadrant(_mm_mul_ps(weight, theta)), inv);
+
+        // same threshold as the scalar version, the division result is discarded there
+        const __m128 nearly_parallel = _mm_cmpge_ps(cosine, _mm_set1_ps(.9995f));
+        detail::quat_lanes::blend(a, simd::select(nearly_parallel, linear_a, spherical_a),
+                                  b, simd::select(nearly_parallel, weight, spherical_b)).store(result + i);
+    }
+#endif
+    for (; i < count; i++) {
+        result[i] = slerp(from[i], to[i], t[i]);
+    }
+}
+
+} // ns math
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// bounded multi producer, single consumer queue of small byte records. Producers
+// claim a slot with one compare and swap and publish it through the slot's
+// sequence number, so they never take a lock; the consumer reads published
+// records in claim order. A full ring makes try_push() fail, what happens then
+// is up to the caller
+
+namespace common {
+
+class record_ring {
+
+public:
+    static constexpr size_t slot_size = 256;
+
+    // sequence and header first, the rest of the slot is payload
+    struct alignas(64) slot {
+        std::atomic<size_t> sequence;
+        uint32_t            size;
+        uint32_t            tag;
+        char                data[slot_size - sizeof(std::atomic<size_t>) - 2 * sizeof(uint32_t)];
+    };
+    static constexpr size_t payload_size = sizeof(slot::data);
+
+    // capacity in records, rounded up to a power of two
+    explicit record_ring(const size_t capacity):
+        m_mask(round_up(capacity) - 1), m_slots(new slot[m_mask + 1]), m_enqueue(0), m_dequeue(0) {
+        for (size_t index = 0; index <= m_mask; index++) {
+            m_slots[index].sequence.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    record_ring(const record_ring&) = delete;
+    record_ring& operator=(const record_ring&) = delete;
+
+    size_t capacity() const {
+        return m_mask + 1;
+    }
+
+    // copies up to payload_size bytes, false when the ring is full. position
+    // receives the record's place in the consumption order
+    bool try_push(const char* data, const size_t size, const uint32_t tag, size_t* position = nullptr) {
+        size_t claimed = m_enqueue.load(std::memory_order_relaxed);
+        slot* target;
+        while (true) {
+            target = &m_slots[claimed & m_mask];
+            const size_t sequence = target->sequence.load(std::memory_order_acquire);
+            const intptr_t lag = intptr_t(sequence) - intptr_t(claimed);
+            if (!lag) {
+                if (m_enqueue.compare_exchange_weak(claimed, claimed + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                claimed = m_enqueue.load(std::memory_order_relaxed);
+            }
+        }
+        target->size = uint32_t(std::min(size, payload_size));
+        target->tag = tag;
+        std::memcpy(target->data, data, target->size);
+        target->sequence.store(claimed + 1, std::memory_order_release);
+        if (position) {
+            *position = claimed;
+        }
+        return true;
+    }
+
+    // consumer only: visitor(data, size, tag) for every record published in
+    // order so far, returns how many were consumed
+    template <typename visitor_type>
+    size_t consume(visitor_type&& visitor) {
+        size_t position = m_dequeue.load(std::memory_order_relaxed);
+        const size_t first = position;
+        while (true) {
+            slot& source = m_slots[position & m_mask];
+            if (source.sequence.load(std::memory_order_acquire) != position + 1) {
+                break;
+            }
+            visitor(static_cast<const char*>(source.data), size_t(source.size), source.tag);
+            source.sequence.store(position + m_mask + 1, std::memory_order_release);
+            position++;
+        }
+        m_dequeue.store(position, std::memory_order_release);
+        return position - first;
+    }
+
+    // records claimed so far, published or not
+    size_t pushed() const {
+        return m_enqueue.load(std::memory_order_acquire);
+    }
+
+    // records consumed so far
+    size_t consumed() const {
+        return m_dequeue.load(std::memory_order_acquire);
+    }
+
+private:
+
+    static size_t round_up(const size_t capacity) {
+        size_t result = 2;
+        while (result < capacity) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    const size_t              m_mask;
+    std::unique_ptr<slot[]>   m_slots;
+    // producers and the consumer on separate cache lines
+    alignas(64) std::atomic<size_t> m_enqueue;
+    alignas(64) std::atomic<size_t> m_dequeue;
+};
+
+} // ns common
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include "aligned_arena.hpp"
+#include "job_system.hpp"
+#include "matrix.hpp"
+#include "matrix_error.hpp"
+
+// transform hierarchy stored as flat structure of arrays. Every parent precedes
+// its children, so world transforms resolve in one forward pass; update() only
+// multiplies nodes whose local transform or whose ancestors changed and lists
+// them for upload. World transforms follow the row vector convention of the
+// shaders: world = local * parent world. With a job system each depth level is
+// updated in parallel
+
+namespace math {
+
+class scene_graph {
+
+public:
+    // stable across updates, a removed node's id is handed out again
+    using node_id = uint32_t;
+    static constexpr node_id none = std::numeric_limits<node_id>::max();
+
+    struct changed_transform {
+        node_id node;
+        const mat4f& world;
+    };
+
+    // the world transforms recomputed by the last update(), in hierarchy order
+    class changed_range {
+
+    public:
+        class iterator {
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = changed_transform;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = changed_transform;
+
+            iterator(const scene_graph* graph, const uint32_t* slot):
+                m_graph(graph), m_slot(slot) {}
+
+            changed_transform operator*() const {
+                return {m_graph->m_node[*m_slot], m_graph->m_world[*m_slot]};
+            }
+
+            iterator& operator++() {
+                ++m_slot;
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator result = *this;
+                ++m_slot;
+                return result;
+            }
+
+            bool operator==(const iterator& rhs) const {
+                return m_slot == rhs.m_slot;
+            }
+
+            bool operator!=(const iterator& rhs) const {
+                return m_slot != rhs.m_slot;
+            }
+
+        private:
+            const scene_graph* m_graph;
+            const uint32_t*    m_slot;
+        };
+
+        explicit changed_range(const scene_graph* graph):
+            m_graph(graph) {}
+
+        iterator begin() const {
+            return {m_graph, m_graph->m_changed.data()};
+        }
+
+        iterator end() const {
+            return {m_graph, m_graph->m_changed.data() + m_graph->m_changed.size()};
+        }
+
+        size_t size() const {
+            return m_graph->m_changed.size();
+        }
+
+        bool empty() const {
+            return m_graph->m_changed.empty();
+        }
+
+    private:
+        const scene_graph* m_graph;
+    };
+
+    scene_graph():
+        m_restructure(false) {}
+
+    // new nodes are dirty, their world transform is valid after the next update()
+    node_id add(const mat4f& local, const node_id parent = none) {
+        if (parent != none && !contains(parent)) {
+            throw matrix_error("scene_graph: unknown parent node");
+        }
+
+        node_id node;
+        if (m_free.empty()) {
+            node = node_id(m_slot.size());
+            m_slot.push_back(0);
+        } else {
+            node = m_free.back();
+            m_free.pop_back();
+        }
+        // appending keeps parents ahead of their children, update() regroups by depth
+        m_slot[node] = uint32_t(m_node.size());
+        const uint32_t parent_slot = parent == none ? none : m_slot[parent];
+        m_node.push_back(node);
+        m_parent.push_back(parent_slot);
+        m_depth.push_back(parent == none ? 0 : m_depth[parent_slot] + 1);
+        m_flags.push_back(local_dirty);
+        m_local.push_back(local);
+        m_world.push_back(local);
+        m_restructure |= !m_levels.empty() && m_depth.back() + 1 < m_levels.size() - 1;
+        if (!m_restructure) {
+            extend_levels(m_depth.back());
+        }
+        return node;
+    }
+
+    // removes the node together with its subtree at the next update()
+    void remove(const node_id node) {
+        if (!contains(node)) {
+            throw matrix_error("scene_graph: unknown node");
+        }
+        m_flags[m_slot[node]] |= removed;
+        m_restructure = true;
+    }
+
+    bool contains(const node_id node) const {
+        return node < m_slot.size() && m_slot[node] != none && !(m_flags[m_slot[node]] & removed);
+    }
+
+    size_t size() const {
+        return m_node.size();
+    }
+
+    // accessors expect a node that contains() reports, debug builds assert it
+    node_id parent(const node_id node) const {
+        assert(contains(node));
+        const uint32_t parent_slot = m_parent[m_slot[node]];
+        return parent_slot == none ? none : m_node[parent_slot];
+    }
+
+    const mat4f& local(const node_id node) const {
+        assert(contains(node));
+        return m_local[m_slot[node]];
+    }
+
+    void set_local(const node_id node, const mat4f& local) {
+        if (!contains(node)) {
+            throw matrix_error("scene_graph: unknown node");
+        }
+        const uint32_t slot = m_slot[node];
+        m_local[slot] = local;
+        m_flags[slot] |= local_dirty;
+    }
+
+    // as of the last update()
+    const mat4f& world(const node_id node) const {
+        assert(contains(node));
+        return m_world[m_slot[node]];
+    }
+
+    // recomputes the world transforms of dirty nodes and their descendants,
+    // returns how many were recomputed
+    size_t update() {
+        if (m_restructure) {
+            restructure();
+        }
+        propagate(0, m_node.size());
+        return collect_changed();
+    }
+
+    // same results, the nodes of each level are split across the jobs
+    size_t update(common::job_system& jobs) {
+        if (m_restructure) {
+            restructure();
+        }
+        for (size_t depth = 0; depth + 1 < m_levels.size(); depth++) {
+            const size_t begin = m_levels[depth];
+            jobs.parallel_for(m_levels[depth + 1] - begin, [this, begin](const size_t first, const size_t last) {
+                propagate(begin + first, begin + last);
+            }, parallel_grain);
+        }
+        return collect_changed();
+    }
+
+    changed_range changed() const {
+        return changed_range(this);
+    }
+
+    // nodes of one depth occupy the slots [levels()[depth], levels()[depth + 1]),
+    // valid after update()
+    const std::vector<size_t>& levels() const {
+        return m_levels;
+    }
+
+    // world transforms in slot order, e.g. to upload the whole scene at once
+    const aligned_vector<mat4f>& world_transforms() const {
+        return m_world;
+    }
+
+    node_id node_at(const size_t slot) const {
+        return m_node[slot];
+    }
+
+private:
+
+    enum : uint8_t {
+        local_dirty   = 1 << 0,
+        world_changed = 1 << 1,
+        removed       = 1 << 2
+    };
+
+    // nodes per job of a parallel update, below that a level runs on the calling thread
+    static constexpr size_t parallel_grain = 1024;
+
+    // parents of the slots in [begin, end) are up to date
+    void propagate(const size_t begin, const size_t end) {
+        for (size_t slot = begin; slot < end; slot++) {
+            const uint32_t parent_slot = m_parent[slot];
+            const bool dirty = (m_flags[slot] & local_dirty) || (parent_slot != none && (m_flags[parent_slot] & world_changed));
+            if (!dirty) {
+                m_flags[slot] = 0;
+                continue;
+            }
+            if (parent_slot == none) {
+                m_world[slot] = m_local[slot];
+            } else {
+                m_world[slot] = m_local[slot] * m_world[parent_slot];
+            }
+            m_flags[slot] = world_changed;
+        }
+    }
+
+    size_t collect_changed() {
+        m_changed.clear();
+        for (size_t slot = 0; slot < m_flags.size(); slot++) {
+            if (m_flags[slot] & world_changed) {
+                m_changed.push_back(uint32_t(slot));
+            }
+        }
+        return m_changed.size();
+    }
+
+    // a node at the deepest level (or one below) appended at the end keeps the
+    // slots grouped by depth
+    void extend_levels(const uint32_t depth) {
+        if (m_levels.empty()) {
+            m_levels.push_back(0);
+        }
+        if (depth + 1 == m_levels.size()) {
+            m_levels.push_back(m_node.size());
+        } else {
+            m_levels.back() = m_node.size();
+        }
+    }
+
+    // drops removed subtrees and sorts the slots by depth, stable within a level
+    void restructure() {
+        const size_t count = m_node.size();
+        std::vector<uint32_t> new_slot(count, none);
+        m_levels.assign(1, 0);
+        for (size_t slot = 0; slot < count; slot++) {
+            const uint32_t parent_slot = m_parent[slot];
+            if (parent_slot != none && (m_flags[parent_slot] & removed)) {
+                m_flags[slot] |= removed;
+            }
+            if (m_flags[slot] & removed) {
+                m_slot[m_node[slot]] = none;
+                m_free.push_back(m_node[slot]);
+                continue;
+            }
+            if (m_depth[slot] + 2 > m_levels.size()) {
+                m_levels.resize(m_depth[slot] + 2, 0);
+            }
+            m_levels[m_depth[slot] + 1]++;
+        }
+        for (size_t depth = 1; depth < m_levels.size(); depth++) {
+            m_levels[depth] += m_levels[depth - 1];
+        }
+        std::vector<size_t> next(m_levels.begin(), m_levels.end() - 1);
+        for (size_t slot = 0; slot < count; slot++) {
+            if (!(m_flags[slot] & removed)) {
+                new_slot[slot] = uint32_t(next[m_depth[slot]]++);
+            }
+        }
+
+        const size_t kept = m_levels.back();
+        std::vector<node_id> node(kept);
+        std::vector<uint32_t> parent(kept), depth(kept);
+        std::vector<uint8_t> flags(kept);
+        aligned_vector<mat4f> local(kept), world(kept);
+        for (size_t slot = 0; slot < count; slot++) {
+            const uint32_t target = new_slot[slot];
+            if (target == none) {
+                continue;
+            }
+            node[target] = m_node[slot];
+            parent[target] = m_parent[slot] == none ? none : new_slot[m_parent[slot]];
+            depth[target] = m_depth[slot];
+            flags[target] = m_flags[slot];
+            local[target] = m_local[slot];
+            world[target] = m_world[slot];
+            m_slot[m_node[slot]] = target;
+        }
+        m_node.swap(node);
+        m_parent.swap(parent);
+        m_depth.swap(depth);
+        m_flags.swap(flags);
+        m_local.swap(local);
+        m_world.swap(world);
+        m_restructure = false;
+    }
+
+    // per slot
+    std::vector<node_id>  m_node;
+    std::vector<uint32_t> m_parent;
+    std::vector<uint32_t> m_depth;
+    std::vector<uint8_t>  m_flags;
+    aligned_vector<mat4f> m_local;
+    aligned_vector<mat4f> m_world;
+
+    // per node id
+    std::vector<uint32_t> m_slot;
+    std::vector<node_id>  m_free;
+
+    std::vector<size_t>   m_levels;
+    std::vector<uint32_t> m_changed;
+    bool                  m_restructure;
+};
+
+} // ns math
@@ -68,12 +68,14 @@ class gl_shader {
         return result == GL_TRUE;
     }
 
-    void dump_info_log(common::logger& logger) const {
+    template <typename logger_type>
+    void dump_info_log(logger_type& logger) const {
         int max_length = 2048;
         int actual_length = 0;
         char log[2048];
         glGetShaderInfoLog(m_id, max_length, &actual_length, log);
-        logger << "shader info log for GL index " << std::to_string(m_id) << ":\n" << log << "\n";
+        static const common::log_format info_log("shader info log for GL index {}:\n{}\n");
+        logger.record(info_log, m_id, log);
     }
 
     private:
@@ -128,25 +130,39 @@ class gl_shader_program {
         glBindAttribLocation(m_id, id, name.c_str());
     }
 
-    void dump_info_log(common::logger& logger) const {
+    template <typename logger_type>
+    void dump_info_log(logger_type& logger) const {
         int max_length = 2048;
         int actual_length = 0;
         char log[2048];
         glGetProgramInfoLog(m_id, max_length, &actual_length, log);
-        logger << "program info log for GL index " << std::to_string(m_id) << ":\n" << log << "\n";
+        static const common::log_format info_log("program info log for GL index {}:\n{}\n");
+        logger.record(info_log, m_id, log);
     }
 
-    void dump_details(common::logger& logger) const {
-        logger << "-----------------------------\ninformation for shader program " << std::to_string(m_id) << ":\n";
+    // debug output, the GL queries go away too where the logger drops debug lines
+    template <typename logger_type>
+    void dump_details(logger_type& logger) const {
+        if constexpr (!logger_type::enabled(common::log_level::debug)) {
+            return;
+        }
+        // formatted by the logger, binary logs keep only the values
+        static const common::log_format header("-----------------------------\ninformation for shader program {}:\n");
+        static const common::log_format link_status("GL_LINK_STATUS = {}\n");
+        static const common::log_format attached_shaders("GL_ATTACHED_SHADERS = {}\n");
+        static const common::log_format active_attributes("GL_ACTIVE_ATTRIBUTES = {}\n");
+        static const common::log_format active_uniforms("GL_ACTIVE_UNIFORMS = {}\n");
+        static const common::log_format variable(" {}) type: {} name: {} location: {}\n");
+        logger.record(header, m_id);
         int params = -1;
         glGetProgramiv(m_id, GL_LINK_STATUS, &params);
-        logger << "GL_LINK_STATUS = " << std::to_string(params) << "\n";
+        logger.record(link_status, params);
 
         glGetProgramiv(m_id, GL_ATTACHED_SHADERS, &params);
-        logger << "GL_ATTACHED_SHADERS = " << std::to_string(params) << "\n";
+        logger.record(attached_shaders, params);
 
         glGetProgramiv(m_id, GL_ACTIVE_ATTRIBUTES, &params);
-        logger << "GL_ACTIVE_ATTRIBUTES = " << std::to_string(params) << "\n";
+        logger.record(active_attributes, params);
         for (GLuint i = 0; i < (GLuint)params; i++) {
             char name[64];
             int max_length = 64;
@@ -159,16 +175,16 @@ class gl_shader_program {
                     char long_name[64];
                     sprintf(long_name, "%s[%i]", name, j);
                     int location = glGetAttribLocation(m_id, long_name);
-                    logger << " " << std::to_string(i) << ") type: " << GL_type_to_string(type) << " name: " << long_name << " location: " << std::to_string(location) << "\n";
+                    logger.record(variable, i, GL_type_to_string(type), long_name, location);
                 }
             } else {
                   int location = glGetAttribLocation(m_id, name);
-                  logger << " " << std::to_string(i) << ") type: " << GL_type_to_string(type) << " name: " << name << " location: " << std::to_string(location) << "\n";
+                  logger.record(variable, i, GL_type_to_string(type), name, location);
             }
         }
 
         glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &params);
-        logger << "GL_ACTIVE_UNIFORMS = " << std::to_string(params) << "\n";
+        logger.record(active_uniforms, params);
         for (GLuint i = 0; i < (GLuint)params; i++) {
             char name[64];
             int max_length = 64;
@@ -181,11 +197,11 @@ class gl_shader_program {
                     char long_name[64];
                     sprintf(long_name, "%s[%i]", name, j);
                     int location = glGetUniformLocation(m_id, long_name);
-                    logger << " " << std::to_string(i) << ") type: " << GL_type_to_string(type) << " name: " << long_name << " location: " << std::to_string(location) << "\n";
+                    logger.record(variable, i, GL_type_to_string(type), long_name, location);
                 }
             } else {
                 int location = glGetUniformLocation(m_id, name);
-                logger << " " << std::to_string(i) << ") type: " << GL_type_to_string(type) << " name: " << name << " location: " << std::to_string(location) << "\n";
+                logger.record(variable, i, GL_type_to_string(type), name, location);
             }
         }
         logger << "-----------------------------\n";
@@ -224,7 +240,8 @@ class gl_shader_loader {
 
         gl_shader shader(shader_kind_to_GLenum(kind), source);
         if (shader.compile()) {
-            m_logger << "shader " << std::to_string(shader.id()) << " compiled successfully\n";
+            static const common::log_format compiled("shader {} compiled successfully\n");
+            m_logger.record(compiled, shader.id());
             m_container.emplace(key, shader);
             return m_container.at(key);
         }
@@ -0,0 +1,50 @@
+#pragma once
+
+// compile-time SIMD level selection, define MATH_NO_SIMD to force scalar code paths
+#if !defined(MATH_NO_SIMD) && defined(__AVX__)
+#   define MATH_SIMD_AVX 1
+#   define MATH_SIMD_SSE 1
+#elif !defined(MATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#   define MATH_SIMD_SSE 1
+#endif
+
+// hardware half-float conversions, AVX capable CPUs almost always have them
+#if defined(MATH_SIMD_AVX) && defined(__F16C__)
+#   define MATH_SIMD_F16C 1
+#endif
+
+#if defined(MATH_SIMD_AVX)
+#   include <immintrin.h>
+#elif defined(MATH_SIMD_SSE)
+#   include <emmintrin.h>
+#endif
+
+// lets constexpr code fall back to scalar paths while being constant evaluated,
+// intrinsics are not usable there
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#   define MATH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#   define MATH_CONSTANT_EVALUATED() false
+#endif
+
+namespace math {
+namespace simd {
+
+#if defined(MATH_SIMD_AVX)
+static constexpr const char* level = "avx";
+#elif defined(MATH_SIMD_SSE)
+static constexpr const char* level = "sse";
+#else
+static constexpr const char* level = "scalar";
+#endif
+
+#if defined(MATH_SIMD_SSE)
+// lanes of when_set where mask is set, lanes of otherwise elsewhere. mask lanes
+// are all ones or all zeros, as comparisons return them
+inline __m128 select(const __m128 mask, const __m128 when_set, const __m128 otherwise) {
+    return _mm_or_ps(_mm_and_ps(mask, when_set), _mm_andnot_ps(mask, otherwise));
+}
+#endif
+
+} // ns simd
+} // ns math
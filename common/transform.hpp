@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include "matrix.hpp"
+#include "vector.hpp"
+
+namespace math {
+
+struct axis_angle {
+    vector::vec3 axis; // unit length
+    float angle;
+};
+
+namespace detail {
+
+// the compiler merges sin and cos of the same angle into a single sincos call
+inline void sincos(const float angle, float& sine, float& cosine) {
+    sine = std::sin(angle);
+    cosine = std::cos(angle);
+}
+
+// rotation block of rotate_x(x) * rotate_y(y) * rotate_z(z) in the matrix layout,
+// i.e. x is applied first and z last
+inline void euler_rotation(const float (&s)[3], const float (&c)[3], float (&r)[9]) {
+    r[0] = c[1] * c[2];
+    r[1] = c[1] * s[2];
+    r[2] = -s[1];
+    r[3] = s[0] * s[1] * c[2] - c[0] * s[2];
+    r[4] = s[0] * s[1] * s[2] + c[0] * c[2];
+    r[5] = s[0] * c[1];
+    r[6] = c[0] * s[1] * c[2] + s[0] * s[2];
+    r[7] = c[0] * s[1] * s[2] - s[0] * c[2];
+    r[8] = c[0] * c[1];
+}
+
+// same orientation convention as rotate_x/y/z for the coordinate axes
+inline void axis_angle_rotation(const axis_angle& rotation, float (&r)[9]) {
+    const float x = rotation.axis.data()[0];
+    const float y = rotation.axis.data()[1];
+    const float z = rotation.axis.data()[2];
+    float s, c;
+    sincos(rotation.angle, s, c);
+    const float t = 1 - c;
+
+    r[0] = c + t * x * x;
+    r[1] = t * x * y + s * z;
+    r[2] = t * x * z - s * y;
+    r[3] = t * x * y - s * z;
+    r[4] = c + t * y * y;
+    r[5] = t * y * z + s * x;
+    r[6] = t * x * z + s * y;
+    r[7] = t * y * z - s * x;
+    r[8] = c + t * z * z;
+}
+
+// scale(s) * rotation * translate(t) written out directly
+inline void compose(const float (&r)[9], const vector::vec3& translation, const vector::vec3& scale, float* m) {
+    for (size_t row = 0; row < 3; row++) {
+        const float factor = scale.data()[row];
+        m[row * 4 + 0] = r[row * 3 + 0] * factor;
+        m[row * 4 + 1] = r[row * 3 + 1] * factor;
+        m[row * 4 + 2] = r[row * 3 + 2] * factor;
+        m[row * 4 + 3] = 0;
+    }
+    m[12] = translation.data()[0];
+    m[13] = translation.data()[1];
+    m[14] = translation.data()[2];
+    m[15] = 1;
+}
+
+} // ns detail
+
+// model matrix equal to scale(s) * rotate_x(x) * rotate_y(y) * rotate_z(z) * translate(t):
+// scales first, then rotates around x, y, z, then translates
+inline mat4f trs(const vector::vec3& translation, const vector::vec3& euler, const vector::vec3& scale) {
+    float s[3], c[3], r[9];
+    for (size_t axis = 0; axis < 3; axis++) {
+        detail::sincos(euler.data()[axis], s[axis], c[axis]);
+    }
+    detail::euler_rotation(s, c, r);
+
+    mat4f::container_type data;
+    detail::compose(r, translation, scale, data.raw());
+    return mat4f{data};
+}
+
+inline mat4f trs(const vector::vec3& translation, const axis_angle& rotation, const vector::vec3& scale) {
+    float r[9];
+    detail::axis_angle_rotation(rotation, r);
+
+    mat4f::container_type data;
+    detail::compose(r, translation, scale, data.raw());
+    return mat4f{data};
+}
+
+// translation, euler rotation and scale of a model matrix; setters only mark what
+// changed, and matrix() redoes the trigonometry for changed rotation axes only
+class decomposed_transform {
+
+public:
+    decomposed_transform(const vector::vec3& translation, const vector::vec3& euler, const vector::vec3& scale):
+        m_translation(translation), m_euler(euler), m_scale(scale), m_dirty(all_dirty) {}
+
+    const vector::vec3& translation() const {
+        return m_translation;
+    }
+
+    const vector::vec3& rotation() const {
+        return m_euler;
+    }
+
+    const vector::vec3& scale() const {
+        return m_scale;
+    }
+
+    void set_translation(const vector::vec3& translation) {
+        m_translation = translation;
+        m_dirty |= translation_dirty;
+    }
+
+    void set_rotation(const vector::vec3& euler) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            if (euler.data()[axis] != m_euler.data()[axis]) {
+                m_dirty |= rotation_x_dirty << axis;
+            }
+        }
+        m_euler = euler;
+    }
+
+    void set_scale(const vector::vec3& scale) {
+        m_scale = scale;
+        m_dirty |= scale_dirty;
+    }
+
+    const mat4f& matrix() {
+        if (!m_dirty) {
+            return m_matrix;
+        }
+        float* m = m_matrix.container().raw();
+
+        const bool rotation_changed = m_dirty & (rotation_x_dirty | rotation_y_dirty | rotation_z_dirty);
+        for (size_t axis = 0; axis < 3; axis++) {
+            if (m_dirty & (rotation_x_dirty << axis)) {
+                detail::sincos(m_euler.data()[axis], m_sin[axis], m_cos[axis]);
+            }
+        }
+        if (rotation_changed) {
+            detail::euler_rotation(m_sin, m_cos, m_rotation);
+        }
+
+        if (rotation_changed || (m_dirty & scale_dirty)) {
+            detail::compose(m_rotation, m_translation, m_scale, m);
+        } else {
+            m[12] = m_translation.data()[0];
+            m[13] = m_translation.data()[1];
+            m[14] = m_translation.data()[2];
+        }
+        m_dirty = 0;
+        return m_matrix;
+    }
+
+private:
+
+    enum : uint8_t {
+        translation_dirty = 1 << 0,
+        rotation_x_dirty  = 1 << 1,
+        rotation_y_dirty  = 1 << 2,
+        rotation_z_dirty  = 1 << 3,
+        scale_dirty       = 1 << 4,
+        all_dirty         = 0x1f
+    };
+
+    vector::vec3 m_translation;
+    vector::vec3 m_euler;
+    vector::vec3 m_scale;
+
+    float        m_sin[3];
+    float        m_cos[3];
+    float        m_rotation[9];
+    mat4f        m_matrix;
+    uint8_t      m_dirty;
+};
+
+// inverse of trs() for matrices without shear; a mirroring transform gets a negative x scale
+inline decomposed_transform decompose(const mat4f& matrix) {
+    const float* m = matrix.container().raw();
+
+    float scale[3], r[9];
+    for (size_t row = 0; row < 3; row++) {
+        const float* source = m + row * 4;
+        scale[row] = std::sqrt(source[0] * source[0] + source[1] * source[1] + source[2] * source[2]);
+        for (size_t col = 0; col < 3; col++) {
+            r[row * 3 + col] = scale[row] ? source[col] / scale[row] : 0;
+        }
+    }
+
+    const float det = r[0] * (r[4] * r[8] - r[5] * r[7])
+                    - r[1] * (r[3] * r[8] - r[5] * r[6])
+                    + r[2] * (r[3] * r[7] - r[4] * r[6]);
+    if (det < 0) {
+        scale[0] = -scale[0];
+        r[0] = -r[0];
+        r[1] = -r[1];
+        r[2] = -r[2];
+    }
+
+    // r[2] == -sin(y), r[5] == sin(x) cos(y), r[8] == cos(x) cos(y), r[1] / r[0] == tan(z)
+    const float y = std::asin(std::fmax(-1.f, std::fmin(1.f, -r[2])));
+    float x, z;
+    if (std::fabs(r[2]) < 0.9999f) {
+        x = std::atan2(r[5], r[8]);
+        z = std::atan2(r[1], r[0]);
+    } else {
+        // gimbal lock: only x - z (or x + z) is defined, keep z at zero
+        x = std::atan2(-r[7], r[4]);
+        z = 0;
+    }
+
+    return decomposed_transform{vector::vec3({m[12], m[13], m[14]}),
+                                vector::vec3({x, y, z}),
+                                vector::vec3({scale[0], scale[1], scale[2]})};
+}
+
+} // ns math
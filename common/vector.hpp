@@ -1,35 +1,584 @@
 #pragma once
 
 #include <array>
+#include <cmath>
+#include <ostream>
+#include "simd.hpp"
 
 namespace vector {
 
+namespace detail {
+
 template <typename value_type, size_t size>
-class vector {
+struct storage {
+    static constexpr size_t length = size;
+    static constexpr size_t alignment = alignof(value_type);
+};
+
+// float vec3 gets a padding lane, so float vec3 and vec4 both fill exactly one SSE register
+template <> struct storage<float, 3> {
+    static constexpr size_t length = 4;
+    static constexpr size_t alignment = 16;
+};
+
+template <> struct storage<float, 4> {
+    static constexpr size_t length = 4;
+    static constexpr size_t alignment = 16;
+};
+
+// element-wise operations run over the padding lane as well, only dot() has to skip it
+template <typename value_type, size_t size>
+struct scalar_arithmetic {
+    static constexpr size_t length = storage<value_type, size>::length;
+    using data_type = std::array<value_type, length>;
+
+    static constexpr data_type add(const data_type& lhs, const data_type& rhs) {
+        data_type result{};
+        for (size_t i = 0; i < length; i++) {
+            result[i] = lhs[i] + rhs[i];
+        }
+        return result;
+    }
+
+    static constexpr data_type subtract(const data_type& lhs, const data_type& rhs) {
+        data_type result{};
+        for (size_t i = 0; i < length; i++) {
+            result[i] = lhs[i] - rhs[i];
+        }
+        return result;
+    }
+
+    static constexpr data_type multiply(const data_type& lhs, const data_type& rhs) {
+        data_type result{};
+        for (size_t i = 0; i < length; i++) {
+            result[i] = lhs[i] * rhs[i];
+        }
+        return result;
+    }
+
+    static constexpr data_type multiply(const data_type& lhs, const value_type rhs) {
+        data_type result{};
+        for (size_t i = 0; i < length; i++) {
+            result[i] = lhs[i] * rhs;
+        }
+        return result;
+    }
+
+    static constexpr data_type divide(const data_type& lhs, const value_type rhs) {
+        data_type result{};
+        for (size_t i = 0; i < length; i++) {
+            result[i] = lhs[i] / rhs;
+        }
+        return result;
+    }
+
+    static constexpr data_type min(const data_type& lhs, const data_type& rhs) {
+        data_type result{};
+        for (size_t i = 0; i < length; i++) {
+            result[i] = rhs[i] < lhs[i] ? rhs[i] : lhs[i];
+        }
+        return result;
+    }
+
+    static constexpr data_type max(const data_type& lhs, const data_type& rhs) {
+        data_type result{};
+        for (size_t i = 0; i < length; i++) {
+            result[i] = lhs[i] < rhs[i] ? rhs[i] : lhs[i];
+        }
+        return result;
+    }
+
+    static constexpr value_type dot(const data_type& lhs, const data_type& rhs) {
+        value_type result{};
+        for (size_t i = 0; i < size; i++) {
+            result += lhs[i] * rhs[i];
+        }
+        return result;
+    }
+
+    static constexpr data_type cross(const data_type& lhs, const data_type& rhs) {
+        static_assert(size == 3, "cross product is defined for 3 dimensional vectors only");
+        data_type result{};
+        result[0] = lhs[1] * rhs[2] - lhs[2] * rhs[1];
+        result[1] = lhs[2] * rhs[0] - lhs[0] * rhs[2];
+        result[2] = lhs[0] * rhs[1] - lhs[1] * rhs[0];
+        return result;
+    }
+};
+
+// vector operators dispatch here, the specializations below replace the generic loops
+template <typename value_type, size_t size>
+struct arithmetic : scalar_arithmetic<value_type, size> {};
+
+#if defined(MATH_SIMD_SSE)
+inline __m128 horizontal_sum(const __m128 value) {
+    const __m128 swapped = _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1));
+    const __m128 pairs = _mm_add_ps(value, swapped);
+    return _mm_add_ss(pairs, _mm_movehl_ps(swapped, pairs));
+}
+
+template <size_t size>
+struct register_arithmetic {
+    using data_type = std::array<float, 4>;
+
+    static __m128 load(const data_type& value) {
+        return _mm_loadu_ps(value.data());
+    }
+
+    static data_type store(const __m128 value) {
+        data_type result;
+        _mm_storeu_ps(result.data(), value);
+        return result;
+    }
+
+    static data_type add(const data_type& lhs, const data_type& rhs) {
+        return store(_mm_add_ps(load(lhs), load(rhs)));
+    }
+
+    static data_type subtract(const data_type& lhs, const data_type& rhs) {
+        return store(_mm_sub_ps(load(lhs), load(rhs)));
+    }
+
+    static data_type multiply(const data_type& lhs, const data_type& rhs) {
+        return store(_mm_mul_ps(load(lhs), load(rhs)));
+    }
+
+    static data_type multiply(const data_type& lhs, const float rhs) {
+        return store(_mm_mul_ps(load(lhs), _mm_set1_ps(rhs)));
+    }
+
+    static data_type divide(const data_type& lhs, const float rhs) {
+        return store(_mm_div_ps(load(lhs), _mm_set1_ps(rhs)));
+    }
+
+    static data_type min(const data_type& lhs, const data_type& rhs) {
+        return store(_mm_min_ps(load(lhs), load(rhs)));
+    }
+
+    static data_type max(const data_type& lhs, const data_type& rhs) {
+        return store(_mm_max_ps(load(lhs), load(rhs)));
+    }
+
+    static float dot(const data_type& lhs, const data_type& rhs) {
+        __m128 product = _mm_mul_ps(load(lhs), load(rhs));
+        if (size == 3) {
+            product = _mm_and_ps(product, _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+        }
+        return _mm_cvtss_f32(horizontal_sum(product));
+    }
+
+    // lhs * rhs.yzx - lhs.yzx * rhs gives the cross product in zxy order
+    static data_type cross(const data_type& lhs, const data_type& rhs) {
+        static_assert(size == 3, "cross product is defined for 3 dimensional vectors only");
+        const __m128 a = load(lhs);
+        const __m128 b = load(rhs);
+        const __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        const __m128 zxy = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+        return store(_mm_shuffle_ps(zxy, zxy, _MM_SHUFFLE(3, 0, 2, 1)));
+    }
+};
+
+template <> struct arithmetic<float, 3> : register_arithmetic<3> {};
+template <> struct arithmetic<float, 4> : register_arithmetic<4> {};
+#endif
+
+} // ns detail
+
+template <typename value_type, size_t size>
+class alignas(detail::storage<value_type, size>::alignment) vector {
 public:
-    static const size_t dimensions = size;
-    using data_type = std::array<value_type, dimensions>;
+    static constexpr size_t dimensions = size;
+    // number of stored elements, may exceed dimensions by zero padding
+    static constexpr size_t storage_size = detail::storage<value_type, size>::length;
+    using data_type = std::array<value_type, storage_size>;
     data_type m_data;
 
-    vector() {
-        m_data.fill(0);
-    }
+    constexpr vector():
+        m_data{} {}
 
-    vector(const data_type& data):
+    constexpr vector(const data_type& data):
         m_data(data) {}
 
-    const data_type& data() const {
+    constexpr const data_type& data() const {
         return m_data;
     }
 
     const value_type* raw_data() {
         return m_data.data();
     }
+
+    constexpr value_type x() const { return m_data[0]; }
+    constexpr value_type y() const { static_assert(dimensions > 1, "vector has no y component"); return m_data[1]; }
+    constexpr value_type z() const { static_assert(dimensions > 2, "vector has no z component"); return m_data[2]; }
+    constexpr value_type w() const { static_assert(dimensions > 3, "vector has no w component"); return m_data[3]; }
+
+    constexpr value_type& operator[](const size_t index) {
+        return m_data[index];
+    }
+
+    constexpr const value_type& operator[](const size_t index) const {
+        return m_data[index];
+    }
+
+    constexpr bool operator==(const vector& other) const {
+        for (size_t i = 0; i < dimensions; i++) {
+            if (m_data[i] != other.m_data[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool operator!=(const vector& other) const {
+        return !(*this == other);
+    }
+
+    constexpr vector operator+(const vector& rhs) const {
+        return MATH_CONSTANT_EVALUATED() ? scalar_arithmetic::add(m_data, rhs.m_data)
+                                         : arithmetic::add(m_data, rhs.m_data);
+    }
+
+    constexpr vector operator-(const vector& rhs) const {
+        return MATH_CONSTANT_EVALUATED() ? scalar_arithmetic::subtract(m_data, rhs.m_data)
+                                         : arithmetic::subtract(m_data, rhs.m_data);
+    }
+
+    constexpr vector operator-() const {
+        return MATH_CONSTANT_EVALUATED() ? scalar_arithmetic::subtract(data_type{}, m_data)
+                                         : arithmetic::subtract(data_type{}, m_data);
+    }
+
+    // component-wise product
+    constexpr vector operator*(const vector& rhs) const {
+        return MATH_CONSTANT_EVALUATED() ? scalar_arithmetic::multiply(m_data, rhs.m_data)
+                                         : arithmetic::multiply(m_data, rhs.m_data);
+    }
+
+    constexpr vector operator*(const value_type rhs) const {
+        return MATH_CONSTANT_EVALUATED() ? scalar_arithmetic::multiply(m_data, rhs)
+                                         : arithmetic::multiply(m_data, rhs);
+    }
+
+    constexpr vector operator/(const value_type rhs) const {
+        return MATH_CONSTANT_EVALUATED() ? scalar_arithmetic::divide(m_data, rhs)
+                                         : arithmetic::divide(m_data, rhs);
+    }
+
+    constexpr vector& operator+=(const vector& rhs) {
+        return *this = *this + rhs;
+    }
+
+    constexpr vector& operator-=(const vector& rhs) {
+        return *this = *this - rhs;
+    }
+
+    constexpr vector& operator*=(const vector& rhs) {
+        return *this = *this * rhs;
+    }
+
+    constexpr vector& operator*=(const value_type rhs) {
+        return *this = *this * rhs;
+    }
+
+    constexpr vector& operator/=(const value_type rhs) {
+        return *this = *this / rhs;
+    }
+
+private:
+    using scalar_arithmetic = detail::scalar_arithmetic<value_type, size>;
+    using arithmetic = detail::arithmetic<value_type, size>;
 };
 
+template <typename value_type, size_t size>
+constexpr vector<value_type, size> operator*(const value_type lhs, const vector<value_type, size>& rhs) {
+    return rhs * lhs;
+}
+
+template <typename value_type, size_t size>
+constexpr value_type dot(const vector<value_type, size>& lhs, const vector<value_type, size>& rhs) {
+    return MATH_CONSTANT_EVALUATED() ? detail::scalar_arithmetic<value_type, size>::dot(lhs.data(), rhs.data())
+                                     : detail::arithmetic<value_type, size>::dot(lhs.data(), rhs.data());
+}
+
+template <typename value_type>
+constexpr vector<value_type, 3> cross(const vector<value_type, 3>& lhs, const vector<value_type, 3>& rhs) {
+    return MATH_CONSTANT_EVALUATED() ? detail::scalar_arithmetic<value_type, 3>::cross(lhs.data(), rhs.data())
+                                     : detail::arithmetic<value_type, 3>::cross(lhs.data(), rhs.data());
+}
+
+// component-wise minimum and maximum
+template <typename value_type, size_t size>
+constexpr vector<value_type, size> min(const vector<value_type, size>& lhs, const vector<value_type, size>& rhs) {
+    return MATH_CONSTANT_EVALUATED() ? detail::scalar_arithmetic<value_type, size>::min(lhs.data(), rhs.data())
+                                     : detail::arithmetic<value_type, size>::min(lhs.data(), rhs.data());
+}
+
+template <typename value_type, size_t size>
+constexpr vector<value_type, size> max(const vector<value_type, size>& lhs, const vector<value_type, size>& rhs) {
+    return MATH_CONSTANT_EVALUATED() ? detail::scalar_arithmetic<value_type, size>::max(lhs.data(), rhs.data())
+                                     : detail::arithmetic<value_type, size>::max(lhs.data(), rhs.data());
+}
+
+template <typename value_type, size_t size>
+constexpr value_type length_squared(const vector<value_type, size>& value) {
+    return dot(value, value);
+}
+
+template <typename value_type, size_t size>
+value_type length(const vector<value_type, size>& value) {
+    return std::sqrt(dot(value, value));
+}
+
+template <typename value_type, size_t size>
+value_type distance(const vector<value_type, size>& lhs, const vector<value_type, size>& rhs) {
+    return length(lhs - rhs);
+}
+
+// zero length vectors are returned unchanged
+template <typename value_type, size_t size>
+vector<value_type, size> normalize(const vector<value_type, size>& value) {
+    const value_type magnitude = length(value);
+    return magnitude ? value / magnitude : value;
+}
+
+template <typename value_type, size_t size>
+constexpr vector<value_type, size> lerp(const vector<value_type, size>& from, const vector<value_type, size>& to, const value_type t) {
+    return from + (to - from) * t;
+}
+
+// span versions operate on count contiguous vectors; result may alias an input
+template <typename value_type, size_t size>
+void add(const vector<value_type, size>* lhs, const vector<value_type, size>* rhs, vector<value_type, size>* result, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        result[i] = lhs[i] + rhs[i];
+    }
+}
+
+template <typename value_type, size_t size>
+void subtract(const vector<value_type, size>* lhs, const vector<value_type, size>* rhs, vector<value_type, size>* result, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        result[i] = lhs[i] - rhs[i];
+    }
+}
+
+template <typename value_type, size_t size>
+void scale(const vector<value_type, size>* values, const value_type factor, vector<value_type, size>* result, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        result[i] = values[i] * factor;
+    }
+}
+
+// result += values * factor, the usual integration step
+template <typename value_type, size_t size>
+void multiply_add(const vector<value_type, size>* values, const value_type factor, vector<value_type, size>* result, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        result[i] += values[i] * factor;
+    }
+}
+
+// component-wise bounds of a non-empty span
+template <typename value_type, size_t size>
+void bounds(const vector<value_type, size>* values, const size_t count, vector<value_type, size>& lower, vector<value_type, size>& upper) {
+    lower = values[0];
+    upper = values[0];
+    for (size_t i = 1; i < count; i++) {
+        lower = min(lower, values[i]);
+        upper = max(upper, values[i]);
+    }
+}
+
+namespace detail {
+
+template <typename value_type, size_t size>
+struct scalar_span {
+    using vector_type = vector<value_type, size>;
+
+    static void dot(const vector_type* lhs, const vector_type* rhs, value_type* result, const size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            result[i] = ::vector::dot(lhs[i], rhs[i]);
+        }
+    }
+
+    static void normalize(const vector_type* values, vector_type* result, const size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            result[i] = ::vector::normalize(values[i]);
+        }
+    }
+};
+
+template <typename value_type, size_t size>
+struct span : scalar_span<value_type, size> {};
+
+#if defined(MATH_SIMD_SSE)
+// four vectors per iteration: products are transposed so that every lane sums
+// the components of one vector, in the same order as the single vector dot()
+template <size_t size>
+struct register_span {
+    using vector_type = vector<float, size>;
+
+    static __m128 dot4(const vector_type* lhs, const vector_type* rhs) {
+        __m128 p0 = _mm_mul_ps(_mm_load_ps(lhs[0].data().data()), _mm_load_ps(rhs[0].data().data()));
+        __m128 p1 = _mm_mul_ps(_mm_load_ps(lhs[1].data().data()), _mm_load_ps(rhs[1].data().data()));
+        __m128 p2 = _mm_mul_ps(_mm_load_ps(lhs[2].data().data()), _mm_load_ps(rhs[2].data().data()));
+        __m128 p3 = _mm_mul_ps(_mm_load_ps(lhs[3].data().data()), _mm_load_ps(rhs[3].data().data()));
+        _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+        if (size == 3) {
+            return _mm_add_ps(_mm_add_ps(p0, p1), p2);
+        }
+        return _mm_add_ps(_mm_add_ps(p0, p1), _mm_add_ps(p2, p3));
+    }
+
+    static void dot(const vector_type* lhs, const vector_type* rhs, float* result, const size_t count) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(result + i, dot4(lhs + i, rhs + i));
+        }
+        scalar_span<float, size>::dot(lhs + i, rhs + i, result + i, count - i);
+    }
+
+    static void normalize(const vector_type* values, vector_type* result, const size_t count) {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128 magnitude = _mm_sqrt_ps(dot4(values + i, values + i));
+            const __m128 is_zero = _mm_cmpeq_ps(magnitude, _mm_setzero_ps());
+            alignas(16) float lengths[4];
+            _mm_store_ps(lengths, math::simd::select(is_zero, _mm_set1_ps(1), magnitude));
+            for (size_t lane = 0; lane < 4; lane++) {
+                const __m128 value = _mm_load_ps(values[i + lane].data().data());
+                _mm_store_ps(result[i + lane].m_data.data(), _mm_div_ps(value, _mm_set1_ps(lengths[lane])));
+            }
+        }
+        scalar_span<float, size>::normalize(values + i, result + i, count - i);
+    }
+};
+
+template <> struct span<float, 3> : register_span<3> {};
+template <> struct span<float, 4> : register_span<4> {};
+#endif
+
+} // ns detail
+
+template <typename value_type, size_t size>
+void dot(const vector<value_type, size>* lhs, const vector<value_type, size>* rhs, value_type* result, const size_t count) {
+    detail::span<value_type, size>::dot(lhs, rhs, result, count);
+}
+
+template <typename value_type, size_t size>
+void length(const vector<value_type, size>* values, value_type* result, const size_t count) {
+    detail::span<value_type, size>::dot(values, values, result, count);
+    for (size_t i = 0; i < count; i++) {
+        result[i] = std::sqrt(result[i]);
+    }
+}
+
+template <typename value_type, size_t size>
+void normalize(const vector<value_type, size>* values, vector<value_type, size>* result, const size_t count) {
+    detail::span<value_type, size>::normalize(values, result, count);
+}
+
+// non-owning view of size packed elements in external memory, e.g. a vertex
+// attribute in a mapped buffer; loads into and stores from the padded vector
+template <typename value_type, size_t size>
+class const_vector_ref {
+public:
+    using vector_type = vector<value_type, size>;
+
+    constexpr explicit const_vector_ref(const value_type* data):
+        m_data(data) {}
+    constexpr const_vector_ref(const vector_type& vec):
+        m_data(vec.data().data()) {}
+    const_vector_ref(const vector_type&&) = delete;
+
+    constexpr const value_type* raw() const {
+        return m_data;
+    }
+
+    constexpr const value_type& operator[](const size_t index) const {
+        return m_data[index];
+    }
+
+    constexpr vector_type load() const {
+        typename vector_type::data_type data{};
+        for (size_t i = 0; i < size; i++) {
+            data[i] = m_data[i];
+        }
+        return vector_type{data};
+    }
+
+    constexpr operator vector_type() const {
+        return load();
+    }
+
+    constexpr bool operator==(const vector_type& rhs) const {
+        return load() == rhs;
+    }
+
+protected:
+    const value_type* m_data;
+};
+
+// assignment writes through the view instead of rebinding it
+template <typename value_type, size_t size>
+class vector_ref : public const_vector_ref<value_type, size> {
+public:
+    using vector_type = vector<value_type, size>;
+
+    constexpr explicit vector_ref(value_type* data):
+        const_vector_ref<value_type, size>(data) {}
+    constexpr vector_ref(vector_type& vec):
+        vector_ref(vec.m_data.data()) {}
+    constexpr vector_ref(const vector_ref&) = default;
+
+    // constructed from a mutable pointer, constness is the view's
+    constexpr value_type* raw() const {
+        return const_cast<value_type*>(this->m_data);
+    }
+
+    constexpr value_type& operator[](const size_t index) const {
+        return raw()[index];
+    }
+
+    constexpr vector_ref& operator=(const vector_type& rhs) {
+        for (size_t i = 0; i < size; i++) {
+            raw()[i] = rhs[i];
+        }
+        return *this;
+    }
+
+    constexpr vector_ref& operator=(const vector_ref& rhs) {
+        return *this = rhs.load();
+    }
+
+    constexpr vector_ref& operator+=(const vector_type& rhs) {
+        return *this = this->load() + rhs;
+    }
+
+    constexpr vector_ref& operator-=(const vector_type& rhs) {
+        return *this = this->load() - rhs;
+    }
+
+    constexpr vector_ref& operator*=(const value_type rhs) {
+        return *this = this->load() * rhs;
+    }
+};
+
+template <typename value_type, size_t size> std::ostream& operator<<(std::ostream& out, const vector<value_type, size>& rhs) {
+    out << "(";
+    for (size_t i = 0; i < size; i++) {
+        out << (i ? ", " : "") << rhs.data()[i];
+    }
+    out << ")";
+    return out;
+}
+
+template <typename value_type, size_t size> std::ostream& operator<<(std::ostream& out, const const_vector_ref<value_type, size>& rhs) {
+    out << rhs.load();
+    return out;
+}
+
 using vec2 = vector<float, 2>;
 using vec3 = vector<float, 3>;
 using vec4 = vector<float, 4>;
 
 } // ns vector
-
@@ -0,0 +1,61 @@
+#include <common/matrix.hpp>
+#include "benchmark.hpp"
+#include <vector>
+
+// the determinant before the closed forms: Laplace expansion along the first row,
+// recursing through submatrices down to 1x1
+template <size_t dimensions>
+float recursive_determinant(const math::matrix<dimensions, float>& src) {
+    if constexpr (dimensions == 1) {
+        return src.container().at({0, 0});
+    } else {
+        float result = 0;
+        for (size_t col = dimensions; col--;) {
+            result += src.container().at({0, col}) * (col % 2 ? -1 : 1) * recursive_determinant(src.submatrix(0, col));
+        }
+        return result;
+    }
+}
+
+// the previous adjugate: every cofactor through a recursive submatrix determinant,
+// then a transpose
+template <size_t dimensions>
+math::matrix<dimensions, float> runtime_adjugate(const math::matrix<dimensions, float>& src) {
+    typename math::matrix<dimensions, float>::container_type data;
+    for (size_t row = 0; row < dimensions; row++) {
+        for (size_t col = 0; col < dimensions; col++) {
+            data[{row, col}] = ((row + col) % 2 ? -1 : 1) * recursive_determinant(src.submatrix(row, col));
+        }
+    }
+    return math::matrix<dimensions, float>{data}.transpose();
+}
+
+int main() {
+    const size_t count = 1024;
+    const size_t iterations = 1000000;
+
+    std::vector<math::mat4f> transforms;
+    std::vector<math::mat3f> linear;
+    for (size_t i = 0; i < count; i++) {
+        const float angle = i * .01f;
+        transforms.push_back(math::rotate_z(angle) * math::rotate_x(angle * .5f)
+                           * math::translate(angle, 1, -angle) * math::scale(1 + angle, 2, .5f));
+        linear.push_back(transforms.back().submatrix(3, 3));
+    }
+
+    const double runtime3 = benchmark::measure("mat3f runtime adjugate", iterations, [&](size_t i) {
+        benchmark::do_not_optimize(runtime_adjugate(linear[i % count]));
+    });
+    const double generated3 = benchmark::measure("mat3f generated adjugate", iterations, [&](size_t i) {
+        benchmark::do_not_optimize(linear[i % count].adjugate());
+    });
+    const double runtime4 = benchmark::measure("mat4f runtime adjugate", iterations, [&](size_t i) {
+        benchmark::do_not_optimize(runtime_adjugate(transforms[i % count]));
+    });
+    const double generated4 = benchmark::measure("mat4f generated adjugate", iterations, [&](size_t i) {
+        benchmark::do_not_optimize(transforms[i % count].adjugate());
+    });
+
+    std::cout << "generated speedup: mat3f " << runtime3 / generated3 << "x, mat4f " << runtime4 / generated4 << "x\n";
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <common/bvh.hpp>
+#include "benchmark.hpp"
+#include <cmath>
+#include <string>
+#include <vector>
+
+// objects scattered through a volume that grows with their count, at roughly
+// constant density
+std::vector<math::aabb> make_boxes(const size_t count, const float time) {
+    const float extent = std::cbrt(float(count)) * 4;
+    std::vector<math::aabb> result;
+    for (size_t i = 0; i < count; i++) {
+        const vector::vec3 center({std::sin(i * 1.37f + time) * extent, std::sin(i * .713f) * extent * .2f, std::sin(i * .377f) * extent});
+        result.push_back(math::aabb{center - vector::vec3({1, 1, 1}), center + vector::vec3({1, 1, 1})});
+    }
+    return result;
+}
+
+int main() {
+    std::cout << "simd: " << math::simd::level << "\n";
+
+    for (const size_t count : {10000, 100000, 1000000}) {
+        const std::string size = std::to_string(count / 1000) + "k";
+        const std::vector<math::aabb> boxes = make_boxes(count, 0);
+        const std::vector<math::aabb> moved = make_boxes(count, .001f);
+        const size_t iterations = std::max<size_t>(1, 1000000 / count);
+        math::bvh tree;
+
+        const double build = benchmark::measure(size + " build", iterations, [&](size_t) {
+            tree.build(boxes.data(), count);
+        }, 3);
+        std::cout << "  " << build / count << " ns per object, " << tree.nodes().size() << " nodes, cost " << tree.cost() << "\n";
+
+        const double refit = benchmark::measure(size + " refit, all moved", iterations, [&](size_t iteration) {
+            tree.refit(iteration % 2 ? boxes.data() : moved.data());
+        });
+        std::cout << "  " << build / refit << "x faster than a rebuild\n";
+
+        // 1% of the objects move
+        benchmark::measure(size + " update, 1% moved", iterations, [&](size_t iteration) {
+            const std::vector<math::aabb>& source = iteration % 2 ? boxes : moved;
+            for (uint32_t object = 0; object < count; object += 100) {
+                tree.update(object, source[object]);
+            }
+        });
+        tree.build(boxes.data(), count);
+
+        const float extent = std::cbrt(float(count)) * 4;
+        const math::mat4f projection = math::perspective(.6f, 1.5f, 1, extent);
+        std::vector<uint32_t> visible(count), found;
+        size_t hits = 0;
+        const size_t query_count = 16;
+        const double linear = benchmark::measure(size + " frustum, linear cull", iterations, [&](size_t) {
+            for (size_t query = 0; query < query_count; query++) {
+                const math::frustum view(math::mat4f(math::look_at(vector::vec3({0, 10, 0}), vector::vec3({std::sin(query * .4f), 0, std::cos(query * .4f)}), vector::vec3({0, 1, 0})) * projection));
+                hits = view.cull(boxes.data(), count, visible.data());
+            }
+        }) / query_count;
+        const double hierarchy = benchmark::measure(size + " frustum, bvh", iterations, [&](size_t) {
+            for (size_t query = 0; query < query_count; query++) {
+                const math::frustum view(math::mat4f(math::look_at(vector::vec3({0, 10, 0}), vector::vec3({std::sin(query * .4f), 0, std::cos(query * .4f)}), vector::vec3({0, 1, 0})) * projection));
+                found.clear();
+                tree.query(view, found);
+            }
+        }) / query_count;
+        std::cout << "  " << hits << " visible, " << 1e9 / hierarchy << " queries/s, " << linear / hierarchy << "x over the linear cull\n";
+
+        const size_t ray_count = 1000;
+        const double rays = benchmark::measure(size + " ray picks", iterations, [&](size_t) {
+            for (size_t i = 0; i < ray_count; i++) {
+                const math::ray line{vector::vec3({0, 0, 0}), vector::vec3({std::sin(i * .1f), std::sin(i * .037f) * .2f, std::cos(i * .1f)})};
+                float distance = extent * 2;
+                benchmark::do_not_optimize(tree.raycast(line, distance));
+            }
+        }) / ray_count;
+        std::cout << "  " << 1e9 / rays << " rays/s\n";
+
+        const double spheres = benchmark::measure(size + " sphere queries", iterations, [&](size_t) {
+            for (size_t i = 0; i < ray_count; i++) {
+                found.clear();
+                tree.query(math::sphere(vector::vec3({std::sin(i * .1f) * extent, 0, std::cos(i * .13f) * extent}), 5), found);
+            }
+        }) / ray_count;
+        std::cout << "  " << 1e9 / spheres << " queries/s\n";
+    }
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <common/dynamic_matrix.hpp>
+#include "benchmark.hpp"
+#include <string>
+#include <thread>
+
+// textbook triple loop, strides through rhs a column at a time
+math::dynamic_matrixf naive_product(const math::dynamic_matrixf& lhs, const math::dynamic_matrixf& rhs) {
+    const size_t dimensions = lhs.dimensions();
+    math::dynamic_matrixf result(dimensions);
+    for (size_t row = 0; row < dimensions; row++) {
+        for (size_t col = 0; col < dimensions; col++) {
+            float sum = 0;
+            for (size_t i = 0; i < dimensions; i++) {
+                sum += lhs.at(row, i) * rhs.at(i, col);
+            }
+            result.element(row, col) = sum;
+        }
+    }
+    return result;
+}
+
+int main() {
+    const size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "simd: " << math::simd::level << ", hardware threads: " << hardware_threads << "\n";
+
+    for (const size_t dimensions : {64, 128, 256, 512}) {
+        math::dynamic_matrixf lhs(dimensions), rhs(dimensions);
+        for (size_t i = 0; i < dimensions * dimensions; i++) {
+            lhs.container()[i] = float(i % 7) - 3;
+            rhs.container()[i] = float(i % 5) * .5f;
+        }
+        const size_t iterations = std::max<size_t>(1, (size_t(1) << 26) / (dimensions * dimensions * dimensions));
+        const double flops = 2. * dimensions * dimensions * dimensions;
+        const std::string size = std::to_string(dimensions) + "x" + std::to_string(dimensions);
+
+        const double naive = benchmark::measure(size + " naive", iterations, [&](size_t) {
+            benchmark::do_not_optimize(naive_product(lhs, rhs));
+        }, 3);
+        std::cout << "  " << flops / naive << " GFLOP/s\n";
+        for (size_t threads = 1; threads <= std::max<size_t>(4, hardware_threads); threads *= 2) {
+            const double blocked = benchmark::measure(size + " blocked, " + std::to_string(threads) + " threads", iterations, [&](size_t) {
+                benchmark::do_not_optimize(lhs.multiply(rhs, threads));
+            });
+            std::cout << "  " << flops / blocked << " GFLOP/s, " << naive / blocked << "x over naive\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include <common/frustum.hpp>
+#include "benchmark.hpp"
+#include <cmath>
+#include <vector>
+
+int main() {
+    std::cout << "simd: " << math::simd::level << "\n";
+
+    const math::mat4f view = math::look_at(vector::vec3({0, 2, 10}), vector::vec3({0, 0, 0}), vector::vec3({0, 1, 0}));
+    const math::frustum camera(math::mat4f(view * math::perspective(1, 1.5f, .1f, 200)));
+    const size_t count = 10000;
+    std::vector<math::sphere> spheres;
+    std::vector<math::aabb> boxes;
+    for (size_t i = 0; i < count; i++) {
+        const vector::vec3 center({std::sin(i * 1.3f) * 100, std::cos(i * .7f) * 20, std::sin(i * .37f) * 150});
+        spheres.push_back(math::sphere(center, 1));
+        boxes.push_back(math::aabb{center - vector::vec3({1, 1, 1}), center + vector::vec3({1, 1, 1})});
+    }
+    std::vector<uint32_t> visible(count);
+    const size_t iterations = 500;
+
+    const double sphere_scalar = benchmark::measure("spheres, one at a time", iterations, [&](size_t) {
+        size_t result = 0;
+        for (size_t i = 0; i < count; i++) {
+            visible[result] = uint32_t(i);
+            result += camera.intersects(spheres[i]);
+        }
+        benchmark::do_not_optimize(result);
+    });
+    const double sphere_batch = benchmark::measure("spheres, batch", iterations, [&](size_t) {
+        benchmark::do_not_optimize(camera.cull(spheres.data(), count, visible.data()));
+    });
+    std::cout << "  " << sphere_batch / count << " ns per sphere, " << sphere_scalar / sphere_batch << "x, "
+              << camera.cull(spheres.data(), count, visible.data()) << " of " << count << " visible\n";
+
+    const double box_scalar = benchmark::measure("boxes, one at a time", iterations, [&](size_t) {
+        size_t result = 0;
+        for (size_t i = 0; i < count; i++) {
+            visible[result] = uint32_t(i);
+            result += camera.intersects(boxes[i]);
+        }
+        benchmark::do_not_optimize(result);
+    });
+    const double box_batch = benchmark::measure("boxes, batch", iterations, [&](size_t) {
+        benchmark::do_not_optimize(camera.cull(boxes.data(), count, visible.data()));
+    });
+    std::cout << "  " << box_batch / count << " ns per box, " << box_scalar / box_batch << "x\n";
+    return 0;
+}
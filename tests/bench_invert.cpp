@@ -0,0 +1,60 @@
+#include <common/matrix.hpp>
+#include <common/matrix_group.hpp>
+#include "benchmark.hpp"
+#include <vector>
+
+int main() {
+    const size_t count = 1024;
+    const size_t iterations = 1000000;
+    // invert_rigid() asserts is_rigid() unless NDEBUG is defined
+    std::cout << "build: " << benchmark::build << "\n";
+
+    std::vector<math::mat4f> transforms;
+    for (size_t i = 0; i < count; i++) {
+        const float angle = i * .01f;
+        transforms.push_back(math::rotate_z(angle) * math::rotate_x(angle * .5f)
+                           * math::translate(angle, 1, -angle) * math::scale(1 + angle, 2, .5f));
+    }
+
+    const double adjugate = benchmark::measure("adjugate / determinant", iterations / 10, [&](size_t i) {
+        const math::mat4f& transform = transforms[i % count];
+        benchmark::do_not_optimize(transform.adjugate() * (1 / transform.determinant()));
+    });
+    const double generic = benchmark::measure("invert", iterations, [&](size_t i) {
+        benchmark::do_not_optimize(transforms[i % count].invert());
+    });
+    const double affine = benchmark::measure("invert_affine", iterations, [&](size_t i) {
+        benchmark::do_not_optimize(transforms[i % count].invert_affine());
+    });
+    // rotations and translations only, invert_rigid() requires them
+    std::vector<math::mat4f> rigid_transforms;
+    for (size_t i = 0; i < count; i++) {
+        const float angle = i * .01f;
+        rigid_transforms.push_back(math::rotate_z(angle) * math::rotate_x(angle * .5f) * math::translate(angle, 1, -angle));
+    }
+    const double rigid = benchmark::measure("invert_rigid", iterations, [&](size_t i) {
+        benchmark::do_not_optimize(rigid_transforms[i % count].invert_rigid());
+    });
+
+    // per matrix cost of the lane-wise inverse, the groups are packed once up front
+    std::vector<math::mat4f_group<4>> groups4(count / 4), inverse4(count / 4);
+    std::vector<math::mat4f_group<8>> groups8(count / 8), inverse8(count / 8);
+    math::pack(transforms.data(), count, groups4.data());
+    math::pack(transforms.data(), count, groups8.data());
+    const double batch4 = benchmark::measure("batch invert, group of 4", iterations / 4, [&](size_t i) {
+        benchmark::do_not_optimize(math::invert(groups4[i % groups4.size()], inverse4[i % groups4.size()]));
+    }) / 4;
+    const double batch8 = benchmark::measure("batch invert, group of 8", iterations / 8, [&](size_t i) {
+        benchmark::do_not_optimize(math::invert(groups8[i % groups8.size()], inverse8[i % groups8.size()]));
+    }) / 8;
+
+    std::cout << "batch invert speedup: " << generic / batch4 << "x (4 lanes), "
+              << generic / batch8 << "x (8 lanes, " << math::simd::level << ") over invert\n";
+    // invert() is closed form already, the specialized inverses save the 4x4
+    // cofactors but not the per call overhead
+    std::cout << "invert_affine speedup: " << generic / affine << "x over invert, "
+              << adjugate / affine << "x over adjugate\n";
+    std::cout << "invert_rigid speedup: " << generic / rigid << "x over invert, "
+              << adjugate / rigid << "x over adjugate\n";
+    return 0;
+}
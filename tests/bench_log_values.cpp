@@ -0,0 +1,93 @@
+#include <common/logger.hpp>
+#include "benchmark.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+
+// heap allocations of the calling thread, the asynchronous writer grows its
+// own buffers now and then
+thread_local size_t g_allocations = 0;
+
+void* operator new(const size_t size) {
+    g_allocations++;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+// times one value per line, reports and counts the allocations per line
+template <typename function_type>
+double measure(const std::string& name, const size_t iterations, function_type&& body, size_t& allocated) {
+    const size_t before = g_allocations;
+    const double nanoseconds = benchmark::measure(name, iterations, body);
+    allocated += g_allocations - before;
+    std::cout << "  " << double(g_allocations - before) / (iterations * 5) << " allocations/op\n";
+    return nanoseconds;
+}
+
+int main() {
+    const size_t iterations = 50000;
+    const vector::vec3 position({1.5f, -2.25f, 0.125f});
+    const math::matrix<4, float> transform{1, 0, 0, 4.5f, 0, 1, 0, -2, 0, 0, 1, 0.75f, 0, 0, 0, 1};
+    size_t allocated = 0, baseline = 0;
+
+    for (const bool async : {false, true}) {
+        const std::string mode = async ? "asynchronous, " : "synchronous, ";
+        common::logger log = async ? common::logger("bench", common::logger::async_options{1 << 14, common::logger::overflow_policy::block}, false, "bench_log_values.log")
+                                   : common::logger("bench", false, "bench_log_values.log");
+        // warm up whatever the logger keeps around between lines
+        log << "location " << 0 << " " << 0.5f << "\n";
+        log.flush();
+
+        // 64 bit handles, too long for the small string buffer of std::string
+        const double to_string = measure(mode + "integer, std::to_string", iterations, [&](size_t i) {
+            log << "handle " << std::to_string(i * 0x9E3779B97F4A7C15) << "\n";
+        }, baseline);
+        const double integer = measure(mode + "integer", iterations, [&](size_t i) {
+            log << "handle " << i * 0x9E3779B97F4A7C15 << "\n";
+        }, allocated);
+        std::cout << "  " << to_string / integer << "x faster than std::to_string\n";
+        const double float_to_string = measure(mode + "float, std::to_string", iterations, [&](size_t i) {
+            log << "aspect " << std::to_string(float(i) * 0.001f) << "\n";
+        }, baseline);
+        const double floating = measure(mode + "float", iterations, [&](size_t i) {
+            log << "aspect " << float(i) * 0.001f << "\n";
+        }, allocated);
+        std::cout << "  " << float_to_string / floating << "x faster than std::to_string\n";
+        measure(mode + "gl_enum", iterations, [&](size_t i) {
+            log << "type " << common::gl_enum{unsigned(0x8B50 + i % 16)} << "\n";
+        }, allocated);
+        const double vec3_stream = measure(mode + "vec3, std::ostringstream", iterations, [&](size_t) {
+            std::ostringstream text;
+            text << position;
+            log << "position " << text.str() << "\n";
+        }, baseline);
+        const double vec3 = measure(mode + "vec3", iterations, [&](size_t) {
+            log << "position " << position << "\n";
+        }, allocated);
+        std::cout << "  " << vec3_stream / vec3 << "x faster than std::ostringstream\n";
+        const double mat4_stream = measure(mode + "mat4, std::ostringstream", iterations, [&](size_t) {
+            std::ostringstream text;
+            text << transform;
+            log << "transform " << text.str() << "\n";
+        }, baseline);
+        const double mat4 = measure(mode + "mat4", iterations, [&](size_t) {
+            log << "transform " << transform << "\n";
+        }, allocated);
+        std::cout << "  " << mat4_stream / mat4 << "x faster than std::ostringstream\n";
+    }
+    std::remove("bench_log_values.log");
+    // logged values must not allocate
+    return allocated == 0 ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include <common/logger.hpp>
+#include "benchmark.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// a typical line of the frame loop
+void log_line(common::logger& log, const std::string& frame) {
+    log << common::logger::message_type::notice << "frame " << frame << " uploaded 1024 transforms\n";
+}
+
+// latency of single lines as the caller sees it, including the rare slow ones
+void report_latency(const std::string& name, common::logger& log, const size_t lines) {
+    const std::string frame = "1234";
+    std::vector<double> latency(lines);
+    for (size_t i = 0; i < lines; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        log_line(log, frame);
+        latency[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    std::sort(latency.begin(), latency.end());
+    std::cout << "  " << name << " latency: median " << latency[lines / 2] << " ns, 99% " << latency[lines * 99 / 100]
+              << " ns, 99.9% " << latency[lines * 999 / 1000] << " ns, max " << latency.back() << " ns\n";
+}
+
+int main() {
+    const size_t iterations = 20000;
+    const std::string frame = "1234";
+    // mirrored lines go nowhere, a terminal would only be slower
+    if (!std::freopen("/dev/null", "w", stderr)) {
+        return 1;
+    }
+
+    for (const bool mirror : {false, true}) {
+        const std::string mode = mirror ? ", mirrored" : "";
+        double synchronous;
+        {
+            common::logger log("bench", mirror, "bench_logger_sync.log");
+            synchronous = benchmark::measure("synchronous" + mode, iterations, [&](size_t) {
+                log_line(log, frame);
+            });
+            report_latency("synchronous" + mode, log, iterations);
+        }
+
+        // a ring large enough for the bursts, the writer catches up in between
+        {
+            common::logger log("bench", common::logger::async_options{1 << 14, common::logger::overflow_policy::block}, mirror, "bench_logger_async.log");
+            const double asynchronous = benchmark::measure("asynchronous" + mode, iterations, [&](size_t) {
+                log_line(log, frame);
+            });
+            std::cout << "  " << synchronous / asynchronous << "x faster than synchronous\n";
+            log.flush();
+            report_latency("asynchronous" + mode, log, iterations);
+        }
+    }
+
+    // a ring smaller than the bursts: blocking producers wait for the writer,
+    // dropping producers never do
+    for (const auto policy : {common::logger::overflow_policy::block, common::logger::overflow_policy::count_drops}) {
+        const std::string name = policy == common::logger::overflow_policy::block ? "small ring, block" : "small ring, count drops";
+        common::logger log("bench", common::logger::async_options{1024, policy}, false, "bench_logger_small.log");
+        benchmark::measure(name, iterations, [&](size_t) {
+            log_line(log, frame);
+        });
+        report_latency(name, log, iterations);
+        std::cout << "  " << log.dropped() << " records dropped\n";
+    }
+
+    // one line per shader attribute as dump_details() writes it: formatted by
+    // the caller, by the logger, or left to log_decode
+    static const common::log_format variable(" {}) type: {} name: {} location: {}\n");
+    const char* name = "vertex_position";
+    double concatenated;
+    {
+        common::logger log("bench", false, "bench_logger_details.log");
+        concatenated = benchmark::measure("attribute line, to_string and <<", iterations, [&](size_t i) {
+            log << " " << std::to_string(i % 16) << ") type: " << "vec3" << " name: " << name << " location: " << std::to_string(i % 16) << "\n";
+        });
+    }
+    {
+        common::logger log("bench", false, "bench_logger_details.log");
+        const double text = benchmark::measure("attribute line, record() to text", iterations, [&](size_t i) {
+            log.record(variable, i % 16, "vec3", name, int(i % 16));
+        });
+        std::cout << "  " << concatenated / text << "x faster than to_string and <<\n";
+    }
+    const size_t text_size = std::ifstream("bench_logger_details.log", std::ios::binary | std::ios::ate).tellg();
+    {
+        common::logger log("bench", false, "bench_logger_details.blog", common::logger::output_format::binary);
+        const double binary = benchmark::measure("attribute line, record() to binary", iterations, [&](size_t i) {
+            log.record(variable, i % 16, "vec3", name, int(i % 16));
+        });
+        std::cout << "  " << concatenated / binary << "x faster than to_string and <<\n";
+    }
+    const size_t binary_size = std::ifstream("bench_logger_details.blog", std::ios::binary | std::ios::ate).tellg();
+    std::cout << "  " << text_size << " bytes as text, " << binary_size << " bytes binary\n";
+
+    // a debug line with a vector, logged by a debug build and compiled out of a
+    // release build
+    const vector::vec3 position({1.5f, -2.25f, 0.125f});
+    {
+        common::basic_logger<common::log_level::debug, common::file_sink> log("bench", false, "bench_logger_levels.log");
+        benchmark::measure("debug line, debug build", iterations, [&](size_t i) {
+            log.at<common::log_level::debug>() << "node " << i << " at " << position << "\n";
+        });
+    }
+    {
+        common::basic_logger<common::log_level::notice, common::file_sink> log("bench", false, "bench_logger_levels.log");
+        benchmark::measure("debug line, release build", iterations, [&](size_t i) {
+            log.at<common::log_level::debug>() << "node " << i << " at " << position << "\n";
+            benchmark::do_not_optimize(i);
+        });
+    }
+
+    for (const char* filename : {"bench_logger_sync.log", "bench_logger_async.log", "bench_logger_small.log",
+                                 "bench_logger_details.log", "bench_logger_details.blog", "bench_logger_levels.log"}) {
+        std::remove(filename);
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <common/packed_transform.hpp>
+#include "benchmark.hpp"
+#include <vector>
+
+int main() {
+    std::cout << "simd: " << math::simd::level << "\n";
+
+    const size_t count = 4096;
+    const math::quantization_range range{vector::vec3({-100, -100, -100}), vector::vec3({200, 200, 200})};
+    std::vector<vector::vec3> translations(count), scales(count);
+    std::vector<math::quat> rotations(count);
+    std::vector<math::mat4f> matrices(count);
+    for (size_t i = 0; i < count; i++) {
+        translations[i] = vector::vec3({float(i % 100) - 50, float(i % 37), -float(i % 13)});
+        rotations[i] = math::quat::from_axis_angle({vector::normalize(vector::vec3({1, float(i % 5), 2})), i * .01f});
+        scales[i] = vector::vec3({1, 1 + (i % 3) * .5f, 1});
+        matrices[i] = math::packed_trs{translations[i], rotations[i], scales[i], range}.unpack(range);
+    }
+    std::vector<math::packed_affine> affine(count);
+    std::vector<math::packed_half_affine> half(count);
+    std::vector<math::packed_trs> trs(count);
+    std::vector<math::mat4f> unpacked(count);
+    const size_t iterations = 200;
+
+    const double half_scalar = benchmark::measure("half affine pack, scalar", iterations, [&](size_t) {
+        for (size_t i = 0; i < count; i++) {
+            half[i] = math::packed_half_affine{matrices[i]};
+        }
+        benchmark::do_not_optimize(half);
+    }) / count;
+    const double half_batch = benchmark::measure("half affine pack, batch", iterations, [&](size_t) {
+        math::pack(matrices.data(), half.data(), count);
+        benchmark::do_not_optimize(half);
+    }) / count;
+    std::cout << "  " << half_scalar << " vs " << half_batch << " ns per instance\n";
+
+    const double trs_scalar = benchmark::measure("trs pack, scalar", iterations, [&](size_t) {
+        for (size_t i = 0; i < count; i++) {
+            trs[i] = math::packed_trs{translations[i], rotations[i], scales[i], range};
+        }
+        benchmark::do_not_optimize(trs);
+    }) / count;
+    const double trs_batch = benchmark::measure("trs pack, batch", iterations, [&](size_t) {
+        math::pack(translations.data(), rotations.data(), scales.data(), trs.data(), count, range);
+        benchmark::do_not_optimize(trs);
+    }) / count;
+    std::cout << "  " << trs_scalar << " vs " << trs_batch << " ns per instance\n";
+
+    const double unpack_scalar = benchmark::measure("trs unpack, scalar", iterations, [&](size_t) {
+        for (size_t i = 0; i < count; i++) {
+            unpacked[i] = trs[i].unpack(range);
+        }
+        benchmark::do_not_optimize(unpacked);
+    }) / count;
+    const double unpack_batch = benchmark::measure("trs unpack, batch", iterations, [&](size_t) {
+        math::unpack(trs.data(), unpacked.data(), count, range);
+        benchmark::do_not_optimize(unpacked);
+    }) / count;
+    std::cout << "  " << unpack_scalar << " vs " << unpack_batch << " ns per instance\n";
+
+    std::cout << "upload bytes per instance: mat4f " << sizeof(math::mat4f) << ", affine " << sizeof(math::packed_affine)
+              << ", half affine " << sizeof(math::packed_half_affine) << ", trs " << sizeof(math::packed_trs) << "\n";
+    return 0;
+}
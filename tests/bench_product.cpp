@@ -0,0 +1,49 @@
+#include <common/matrix.hpp>
+#include "benchmark.hpp"
+#include <vector>
+
+int main() {
+    const size_t count = 1024;
+    const size_t iterations = 1000000;
+
+    std::vector<math::mat4f> rotations_z, rotations_x, translations, scales;
+    for (size_t i = 0; i < count; i++) {
+        const float position = i * .001f;
+        rotations_z.push_back(math::rotate_z(position));
+        rotations_x.push_back(math::rotate_x(position));
+        translations.push_back(math::translate(position, 0, 0));
+        scales.push_back(math::scale(position, position, 1));
+    }
+
+    // every product stored into a matrix before the next one starts
+    const double eager = benchmark::measure("eager chain", iterations, [&](size_t i) {
+        const size_t index = i % count;
+        const math::mat4f rz_rx = rotations_z[index] * rotations_x[index];
+        const math::mat4f rz_rx_t = rz_rx * translations[index];
+        const math::mat4f result = rz_rx_t * scales[index];
+        benchmark::do_not_optimize(result);
+    });
+    const double fused = benchmark::measure("fused chain", iterations, [&](size_t i) {
+        const size_t index = i % count;
+        const math::mat4f result = rotations_z[index] * rotations_x[index] * translations[index] * scales[index];
+        benchmark::do_not_optimize(result);
+    });
+    std::cout << "fused speedup: " << eager / fused << "x\n";
+
+    // the tutorials build all factors in place every frame
+    const double eager_frame = benchmark::measure("eager frame transform", iterations, [&](size_t i) {
+        const float position = (i % count) * .001f;
+        const math::mat4f rz_rx = math::rotate_z(position) * math::rotate_x(position);
+        const math::mat4f rz_rx_t = rz_rx * math::translate(position, 0, 0);
+        const math::mat4f result = rz_rx_t * math::scale(position, position, 1);
+        benchmark::do_not_optimize(result);
+    });
+    const double fused_frame = benchmark::measure("fused frame transform", iterations, [&](size_t i) {
+        const float position = (i % count) * .001f;
+        const math::mat4f result = math::rotate_z(position) * math::rotate_x(position)
+                                 * math::translate(position, 0, 0) * math::scale(position, position, 1);
+        benchmark::do_not_optimize(result);
+    });
+    std::cout << "fused frame speedup: " << eager_frame / fused_frame << "x\n";
+    return 0;
+}
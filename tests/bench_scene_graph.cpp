@@ -0,0 +1,57 @@
+#include <common/scene_graph.hpp>
+#include <common/transform.hpp>
+#include "benchmark.hpp"
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    const size_t count = 100000;
+    math::scene_graph scene;
+    std::vector<math::scene_graph::node_id> nodes;
+    std::vector<math::mat4f> locals;
+    for (size_t i = 0; i < count; i++) {
+        locals.push_back(math::trs(vector::vec3({float(i % 10), 0, 1}), vector::vec3({0, i * .01f, 0}), vector::vec3({1, 1, 1})));
+        // wide shallow trees of about 8 children per node
+        nodes.push_back(scene.add(locals.back(), i < 16 ? math::scene_graph::none : nodes[i / 8]));
+    }
+    scene.update();
+
+    const size_t iterations = 50;
+    const double full = benchmark::measure("all nodes dirty", iterations, [&](size_t) {
+        for (size_t i = 0; i < count; i++) {
+            scene.set_local(nodes[i], locals[i]);
+        }
+        benchmark::do_not_optimize(scene.update());
+    });
+
+    // 5% of the leaves animate, the rest of the scene is static
+    size_t recomputed = 0;
+    const double incremental = benchmark::measure("5% of the leaves dirty", iterations, [&](size_t iteration) {
+        for (size_t i = count - count / 20 * 2 + iteration % 2; i < count; i += 2) {
+            scene.set_local(nodes[i], locals[i]);
+        }
+        recomputed = scene.update();
+    });
+    std::cout << "  " << recomputed << " of " << count << " recomputed, " << full / incremental << "x faster\n";
+
+    const double idle = benchmark::measure("nothing dirty", iterations, [&](size_t) {
+        benchmark::do_not_optimize(scene.update());
+    });
+    std::cout << "  " << idle / count << " ns per node to skip\n";
+
+    // every node dirty, levels split across the jobs
+    const size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "hardware threads: " << hardware_threads << "\n";
+    for (size_t threads = 1; threads <= std::max<size_t>(4, hardware_threads); threads *= 2) {
+        common::job_system jobs(threads);
+        const double parallel = benchmark::measure("all nodes dirty, " + std::to_string(threads) + " threads", iterations, [&](size_t) {
+            for (size_t i = 0; i < count; i++) {
+                scene.set_local(nodes[i], locals[i]);
+            }
+            benchmark::do_not_optimize(scene.update(jobs));
+        });
+        std::cout << "  " << full / parallel << "x over serial\n";
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <common/batch_transform.hpp>
+#include <common/transform.hpp>
+#include "benchmark.hpp"
+#include <thread>
+#include <vector>
+
+int main() {
+    const size_t count = 1 << 20;
+    const size_t iterations = 20;
+    const math::mat4f model = math::trs(vector::vec3({1, -2, 3}), vector::vec3({.3f, -.7f, 1.1f}), vector::vec3({2, .5f, 3}));
+
+    std::vector<float> packed(count * 3), packed_result(count * 3);
+    std::vector<vector::vec3> points(count), points_result(count);
+    std::vector<float> x(count), y(count), z(count), tx(count), ty(count), tz(count);
+    for (size_t i = 0; i < count; i++) {
+        points[i] = vector::vec3({i * .001f, i * -.002f, i * .003f});
+        for (size_t axis = 0; axis < 3; axis++) {
+            packed[i * 3 + axis] = points[i][axis];
+        }
+        x[i] = points[i][0];
+        y[i] = points[i][1];
+        z[i] = points[i][2];
+    }
+
+    // one point at a time through the row vector product
+    const double single = benchmark::measure("vec4 * mat4f per point", iterations, [&](size_t) {
+        for (size_t i = 0; i < count; i++) {
+            const vector::vec4 result = vector::vec4({packed[i * 3], packed[i * 3 + 1], packed[i * 3 + 2], 1}) * model;
+            packed_result[i * 3] = result[0];
+            packed_result[i * 3 + 1] = result[1];
+            packed_result[i * 3 + 2] = result[2];
+        }
+        benchmark::do_not_optimize(packed_result[0]);
+    }) / count;
+    const double packed_batch = benchmark::measure("packed xyz batch", iterations, [&](size_t) {
+        math::transform_points(model, packed.data(), packed_result.data(), count);
+        benchmark::do_not_optimize(packed_result[0]);
+    }) / count;
+    const double aos_batch = benchmark::measure("vec3 batch", iterations, [&](size_t) {
+        math::transform_points(model, points.data(), points_result.data(), count);
+        benchmark::do_not_optimize(points_result[0]);
+    }) / count;
+    const double soa_batch = benchmark::measure("soa batch", iterations, [&](size_t) {
+        math::transform_points(model, math::const_soa_points{x.data(), y.data(), z.data()},
+                               math::soa_points{tx.data(), ty.data(), tz.data()}, count);
+        benchmark::do_not_optimize(tx[0]);
+    }) / count;
+    const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    const double threaded = benchmark::measure("packed xyz batch, all cores", iterations, [&](size_t) {
+        math::transform_points(model, packed.data(), packed_result.data(), count, threads);
+        benchmark::do_not_optimize(packed_result[0]);
+    }) / count;
+
+    std::cout << "ns per point: single " << single << ", packed " << packed_batch << ", vec3 " << aos_batch
+              << ", soa " << soa_batch << ", " << threads << " threads " << threaded << "\n";
+    return 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace benchmark {
+
+// the build the numbers come from, asserts cost time
+#ifdef NDEBUG
+constexpr const char* build = "NDEBUG, asserts off";
+#else
+constexpr const char* build = "asserts on";
+#endif
+
+// keeps the optimizer from dropping computations whose results are otherwise unused
+template <typename value_type>
+inline void do_not_optimize(const value_type& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// runs body iterations times per repetition and reports the best average time
+// per call, returns nanoseconds
+template <typename function_type>
+double measure(const std::string& name, const size_t iterations, function_type&& body, const size_t repetitions = 5) {
+    double nanoseconds = 0;
+    for (size_t repetition = 0; repetition < repetitions; repetition++) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++) {
+            body(i);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const double average = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+        if (!repetition || average < nanoseconds) {
+            nanoseconds = average;
+        }
+    }
+
+    std::cout << name << ": " << nanoseconds << " ns/op (" << iterations << " iterations)\n";
+    return nanoseconds;
+}
+
+} // ns benchmark
@@ -0,0 +1,43 @@
+#include <deps/testing.h/testing.h>
+#include <common/aligned_arena.hpp>
+#include <common/matrix.hpp>
+#include <cstdint>
+
+bool is_aligned(const void* pointer, const size_t alignment) {
+    return !(reinterpret_cast<uintptr_t>(pointer) % alignment);
+}
+
+BEGIN_TEST()
+    math::aligned_arena<math::mat4f> arena(16);
+
+    math::mat4f* first = arena.allocate(3);
+    math::mat4f* second = arena.allocate(5);
+    EXPECT_TRUE(second == first + 3);
+    // does not fit the rest of the first block
+    math::mat4f* third = arena.allocate(9);
+    EXPECT_TRUE(is_aligned(first, 64) && is_aligned(third, 64));
+    EXPECT_EQUAL(first[2], math::mat4f{});
+    first[2] = math::translate(1, 2, 3);
+    EXPECT_EQUAL(first[2], math::translate(1, 2, 3));
+    EXPECT_EQUAL(arena.capacity(), 2 * 16 * sizeof(math::mat4f));
+
+    // larger than a block: gets a dedicated one
+    math::mat4f* large = arena.allocate(40);
+    EXPECT_TRUE(is_aligned(large, 64));
+    EXPECT_EQUAL(arena.capacity(), (2 * 16 + 40) * sizeof(math::mat4f));
+
+    // reset recycles the memory
+    arena.reset();
+    EXPECT_TRUE(arena.allocate(3) == first);
+    EXPECT_EQUAL(arena.capacity(), (2 * 16 + 40) * sizeof(math::mat4f));
+
+    // 36 byte matrices: every array still starts on a cache line
+    math::aligned_arena<math::mat3f> small_arena;
+    math::mat3f* odd = small_arena.allocate(3);
+    math::mat3f* next = small_arena.allocate(1);
+    EXPECT_TRUE(is_aligned(odd, 64) && is_aligned(next, 64));
+    EXPECT_TRUE(reinterpret_cast<char*>(next) - reinterpret_cast<char*>(odd) == 128);
+
+    math::aligned_vector<math::mat3f, 32> matrices(9);
+    EXPECT_TRUE(is_aligned(matrices.data(), 32));
+END_TEST()
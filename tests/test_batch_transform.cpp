@@ -0,0 +1,95 @@
+#include <deps/testing.h/testing.h>
+#include <common/batch_transform.hpp>
+#include <common/transform.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+template <typename vector_type>
+bool nearly_equal(const vector_type& a, const vector_type& b, const float epsilon = 1e-4f) {
+    for (size_t i = 0; i < vector_type::dimensions; i++) {
+        if (std::fabs(a[i] - b[i]) > epsilon * (1 + std::fabs(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// reference: the row vector product, one point at a time
+vector::vec3 reference(const math::mat4f& matrix, const vector::vec3& point) {
+    const vector::vec4 result = vector::vec4({point[0], point[1], point[2], 1}) * matrix;
+    return vector::vec3({result[0], result[1], result[2]});
+}
+
+BEGIN_TEST()
+    // row vector products follow the shader convention: translations move points
+    const math::mat4f moved = math::translate(1, 2, 3);
+    EXPECT_EQUAL(vector::vec4({1, 1, 1, 1}) * moved, vector::vec4({2, 3, 4, 1}));
+    EXPECT_EQUAL(vector::vec4({1, 1, 1, 0}) * moved, vector::vec4({1, 1, 1, 0}));
+    const math::mat4f model = math::trs(vector::vec3({1, -2, 3}), vector::vec3({.3f, -.7f, 1.1f}), vector::vec3({2, .5f, 3}));
+    const vector::vec4 probe({.5f, -1, 2, 1});
+    EXPECT_TRUE(nearly_equal(probe * model, model.transpose() * probe));
+
+    // 40003 points: SIMD blocks, scalar tails and several threads worth of chunks
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<float> distribution(-100.f, 100.f);
+    const size_t count = 40003;
+    std::vector<float> packed(count * 3);
+    std::vector<vector::vec3> points(count);
+    std::vector<float> x(count), y(count), z(count);
+    for (size_t i = 0; i < count; i++) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            packed[i * 3 + axis] = points[i][axis] = distribution(generator);
+        }
+        x[i] = points[i][0];
+        y[i] = points[i][1];
+        z[i] = points[i][2];
+    }
+
+    for (const size_t threads : {size_t(1), size_t(4)}) {
+        std::vector<float> packed_result(count * 3);
+        math::transform_points(model, packed.data(), packed_result.data(), count, threads);
+        std::vector<vector::vec3> aos_result(count);
+        math::transform_points(model, points.data(), aos_result.data(), count, threads);
+        std::vector<float> tx(count), ty(count), tz(count);
+        math::transform_points(model, math::const_soa_points{x.data(), y.data(), z.data()},
+                               math::soa_points{tx.data(), ty.data(), tz.data()}, count, threads);
+
+        bool all_match = true;
+        for (size_t i = 0; i < count; i++) {
+            const vector::vec3 expected = reference(model, points[i]);
+            all_match &= nearly_equal(vector::vec3({packed_result[i * 3], packed_result[i * 3 + 1], packed_result[i * 3 + 2]}), expected);
+            all_match &= nearly_equal(aos_result[i], expected);
+            all_match &= aos_result[i].data()[3] == 0;
+            all_match &= nearly_equal(vector::vec3({tx[i], ty[i], tz[i]}), expected);
+        }
+        EXPECT_TRUE(all_match);
+    }
+
+    // in place
+    std::vector<float> in_place(packed.begin(), packed.begin() + 30);
+    math::transform_points(model, in_place.data(), in_place.data(), 10);
+    EXPECT_TRUE(nearly_equal(vector::vec3({in_place[27], in_place[28], in_place[29]}), reference(model, points[9])));
+
+    // directions ignore translation
+    std::vector<vector::vec3> directions(points.begin(), points.begin() + 7);
+    math::transform_directions(moved, directions.data(), directions.data(), directions.size());
+    EXPECT_EQUAL(directions[6], points[6]);
+
+    // full 4 component vectors, by one matrix and by one matrix each
+    std::vector<vector::vec4> homogeneous(101);
+    std::vector<math::mat4f> matrices(101);
+    for (size_t i = 0; i < homogeneous.size(); i++) {
+        homogeneous[i] = vector::vec4({points[i][0], points[i][1], points[i][2], i % 2 ? 1.f : 0.f});
+        matrices[i] = math::trs(points[i], vector::vec3({i * .1f, 0, 0}), vector::vec3({1, 2, 1}));
+    }
+    std::vector<vector::vec4> single(homogeneous.size()), each(homogeneous.size());
+    math::transform(model, homogeneous.data(), single.data(), homogeneous.size());
+    math::transform(matrices.data(), homogeneous.data(), each.data(), homogeneous.size());
+    bool vectors_match = true;
+    for (size_t i = 0; i < homogeneous.size(); i++) {
+        vectors_match &= nearly_equal(single[i], homogeneous[i] * model);
+        vectors_match &= nearly_equal(each[i], homogeneous[i] * matrices[i]);
+    }
+    EXPECT_TRUE(vectors_match);
+END_TEST()
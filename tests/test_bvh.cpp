@@ -0,0 +1,148 @@
+#include <deps/testing.h/testing.h>
+#include <common/bvh.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+std::vector<math::aabb> make_boxes(const size_t count, const float offset) {
+    std::vector<math::aabb> result;
+    for (size_t i = 0; i < count; i++) {
+        const vector::vec3 center({std::sin(i * 1.3f + offset) * 100, std::cos(i * .7f) * 30, std::sin(i * .37f) * 150});
+        const float size = .5f + (i % 7) * .5f;
+        result.push_back(math::aabb{center - vector::vec3({size, size * 2, size}), center + vector::vec3({size, size, size * .5f})});
+    }
+    return result;
+}
+
+// inner nodes bound their children, leaves stay small and every object is reachable
+bool valid(const math::bvh& tree) {
+    const auto& nodes = tree.nodes();
+    bool result = true;
+    for (const math::bvh::node& current : nodes) {
+        if (current.leaf()) {
+            result &= current.count <= math::bvh::max_leaf_size;
+        } else {
+            math::aabb expected = math::aabb::empty();
+            expected.extend(nodes[current.first].bounds);
+            expected.extend(nodes[current.first + 1].bounds);
+            result &= current.bounds == expected;
+        }
+    }
+    for (uint32_t object = 0; object < tree.size(); object++) {
+        std::vector<uint32_t> found;
+        tree.query(math::sphere(tree.bounds(object).center(), 0), found);
+        result &= std::count(found.begin(), found.end(), object) == 1;
+    }
+    return result;
+}
+
+std::vector<uint32_t> sorted(std::vector<uint32_t> values) {
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+BEGIN_TEST()
+    math::bvh empty_tree(nullptr, 0);
+    std::vector<uint32_t> found;
+    const math::frustum camera(math::mat4f(math::look_at(vector::vec3({0, 10, 200}), vector::vec3({0, 0, 0}), vector::vec3({0, 1, 0}))
+                                           * math::perspective(.8f, 1.5f, 1, 300)));
+    empty_tree.query(camera, found);
+    EXPECT_TRUE(found.empty());
+    float distance = 1000;
+    EXPECT_EQUAL(empty_tree.raycast(math::ray{vector::vec3({0, 0, 0}), vector::vec3({1, 0, 0})}, distance), math::bvh::none);
+
+    std::vector<math::aabb> boxes = make_boxes(5000, 0);
+    math::bvh tree(boxes.data(), boxes.size());
+    EXPECT_TRUE(valid(tree));
+    // a good tree tests far fewer boxes than there are objects
+    EXPECT_TRUE(tree.cost() < 200);
+
+    // frustum and sphere queries give the brute force results
+    bool queries_match = true;
+    for (size_t round = 0; round < 3; round++) {
+        found.clear();
+        tree.query(camera, found);
+        std::vector<uint32_t> expected(boxes.size());
+        expected.resize(camera.cull(boxes.data(), boxes.size(), expected.data()));
+        queries_match &= sorted(found) == expected;
+
+        for (size_t i = 0; i < 20; i++) {
+            const math::sphere volume(vector::vec3({i * 10.f - 100, i * 3.f - 30, 50 - i * 7.f}), 5 + i * 2.f);
+            found.clear();
+            tree.query(volume, found);
+            expected.clear();
+            for (uint32_t object = 0; object < boxes.size(); object++) {
+                if (boxes[object].intersects(volume)) {
+                    expected.push_back(object);
+                }
+            }
+            queries_match &= sorted(found) == expected;
+        }
+
+        // rays: nearest box entry against brute force
+        for (size_t i = 0; i < 50; i++) {
+            const math::ray line{vector::vec3({i * 4.f - 100, 0, 200}), vector::vec3({std::sin(i * .3f) * .2f, std::cos(i * .5f) * .1f, -1})};
+            float nearest = std::numeric_limits<float>::infinity();
+            for (const math::aabb& box : boxes) {
+                float entry = 0, exit = std::numeric_limits<float>::infinity();
+                for (size_t axis = 0; axis < 3; axis++) {
+                    float a = (box.min[axis] - line.origin[axis]) / line.direction[axis];
+                    float b = (box.max[axis] - line.origin[axis]) / line.direction[axis];
+                    entry = std::max(entry, std::min(a, b));
+                    exit = std::min(exit, std::max(a, b));
+                }
+                if (entry <= exit) {
+                    nearest = std::min(nearest, entry);
+                }
+            }
+            float hit = 1000;
+            const uint32_t object = tree.raycast(line, hit);
+            queries_match &= nearest > 1000 ? object == math::bvh::none : std::fabs(hit - nearest) < 1e-3f && object != math::bvh::none;
+            float unlimited = std::numeric_limits<float>::infinity();
+            const uint32_t unlimited_object = tree.raycast(line, unlimited);
+            queries_match &= std::isinf(nearest) ? unlimited_object == math::bvh::none : std::fabs(unlimited - nearest) < 1e-3f;
+        }
+
+        // moving objects one by one or all at once keeps the tree valid
+        if (round == 0) {
+            for (uint32_t object = 0; object < boxes.size(); object += 3) {
+                boxes[object].min += vector::vec3({5, -3, 20});
+                boxes[object].max += vector::vec3({5, -3, 20});
+                tree.update(object, boxes[object]);
+            }
+        } else {
+            boxes = make_boxes(boxes.size(), round * .01f);
+            tree.refit(boxes.data());
+        }
+        queries_match &= valid(tree);
+    }
+    EXPECT_TRUE(queries_match);
+
+    // exact hit tests: skip every even object
+    const math::ray line{vector::vec3({-300, 0, 0}), vector::vec3({1, 0, 0})};
+    float box_distance = 1000, odd_distance = 1000;
+    const uint32_t first = tree.raycast(line, box_distance);
+    const uint32_t odd = tree.raycast(line, odd_distance, [](const uint32_t object, const float entry) {
+        return object % 2 ? entry : std::numeric_limits<float>::infinity();
+    });
+    EXPECT_TRUE(first != math::bvh::none && odd != math::bvh::none && odd % 2 == 1);
+    EXPECT_TRUE(odd_distance >= box_distance);
+
+    // an infinite limit still reports misses, of the boxes and of the exact test
+    const math::ray away{vector::vec3({-300, 0, 0}), vector::vec3({-1, 0, 0})};
+    float away_distance = std::numeric_limits<float>::infinity();
+    EXPECT_EQUAL(tree.raycast(away, away_distance), math::bvh::none);
+    float rejected_distance = std::numeric_limits<float>::infinity();
+    EXPECT_EQUAL(tree.raycast(line, rejected_distance, [](const uint32_t, const float) {
+        return std::numeric_limits<float>::infinity();
+    }), math::bvh::none);
+
+    // coincident objects still split into bounded leaves
+    std::vector<math::aabb> stacked(1000, math::aabb{vector::vec3({0, 0, 0}), vector::vec3({1, 1, 1})});
+    math::bvh stacked_tree(stacked.data(), stacked.size());
+    found.clear();
+    stacked_tree.query(math::sphere(vector::vec3({.5f, .5f, .5f}), .1f), found);
+    EXPECT_EQUAL(found.size(), 1000u);
+    EXPECT_TRUE(valid(stacked_tree));
+END_TEST()
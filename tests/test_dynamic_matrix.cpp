@@ -0,0 +1,137 @@
+#include <deps/testing.h/testing.h>
+#include <common/dynamic_matrix.hpp>
+#include <cmath>
+
+using dmat = math::dynamic_matrixf;
+using dmatd = math::dynamic_matrixd;
+using vec = std::vector<double>;
+
+template <typename value_type>
+math::dynamic_matrix<value_type> make_matrix(const size_t dimensions, const size_t seed) {
+    math::dynamic_matrix<value_type> result(dimensions);
+    for (size_t row = 0; row < dimensions; row++) {
+        for (size_t col = 0; col < dimensions; col++) {
+            result.element(row, col) = value_type((row * 7 + col * 13 + seed) % 17) / 8 - 1 + (row == col) * value_type(dimensions);
+        }
+    }
+    return result;
+}
+
+template <typename value_type>
+math::dynamic_matrix<value_type> naive_product(const math::dynamic_matrix<value_type>& lhs, const math::dynamic_matrix<value_type>& rhs) {
+    const size_t dimensions = lhs.dimensions();
+    math::dynamic_matrix<value_type> result(dimensions);
+    for (size_t row = 0; row < dimensions; row++) {
+        for (size_t col = 0; col < dimensions; col++) {
+            double sum = 0;
+            for (size_t i = 0; i < dimensions; i++) {
+                sum += double(lhs.at(row, i)) * rhs.at(i, col);
+            }
+            result.element(row, col) = value_type(sum);
+        }
+    }
+    return result;
+}
+
+template <typename value_type>
+bool nearly_equal(const math::dynamic_matrix<value_type>& a, const math::dynamic_matrix<value_type>& b, const double epsilon) {
+    if (a.dimensions() != b.dimensions()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.container().size(); i++) {
+        if (std::fabs(a.container()[i] - b.container()[i]) > epsilon * (1 + std::fabs(b.container()[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BEGIN_TEST()
+    // same results as the fixed size matrices
+    const math::mat4f fixed = math::rotate_z(.4f) * math::translate(1, 2, 3) * math::scale(2, 1, .5f);
+    const math::mat4f other = math::rotate_x(-.3f) * math::scale(1, 3, 1);
+    const dmat dynamic(fixed);
+    EXPECT_EQUAL(dynamic.dimensions(), 4u);
+    EXPECT_EQUAL(dynamic.at(3, 1), fixed.container().at({3, 1}));
+    EXPECT_EQUAL(dynamic * dmat(other), dmat(math::mat4f(fixed * other)));
+    EXPECT_EQUAL(dynamic.transpose(), dmat(fixed.transpose()));
+    EXPECT_EQUAL(dynamic * 2.f, dmat(fixed * 2.f));
+    EXPECT_TRUE(nearly_equal(dynamic.invert(), dmat(fixed.invert()), 1e-5));
+    EXPECT_TRUE(nearly_equal(dynamic.adjugate(), dmat(fixed.adjugate()), 1e-5));
+    EXPECT_TRUE(std::fabs(dynamic.determinant() - fixed.determinant()) < 1e-5f);
+    EXPECT_EQUAL(dynamic.submatrix(1, 2), dmat(fixed.submatrix(1, 2)));
+    EXPECT_EQUAL(dynamic.identity(), dmat(math::mat4f::make_identity()));
+
+    const vector::vec4 point({1, -2, 3, 1});
+    const std::vector<float> dynamic_point = {1, -2, 3, 1};
+    const vector::vec4 column = fixed * point;
+    const vector::vec4 row = point * fixed;
+    const std::vector<float> dynamic_column = dynamic * dynamic_point;
+    const std::vector<float> dynamic_row = dynamic_point * dynamic;
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT_TRUE(std::fabs(dynamic_column[i] - column[i]) < 1e-5f);
+        EXPECT_TRUE(std::fabs(dynamic_row[i] - row[i]) < 1e-5f);
+    }
+
+    // sizes around the register blocks and the cache tiles
+    bool products_match = true;
+    for (const size_t dimensions : {1, 3, 7, 8, 17, 64, 129, 300}) {
+        const dmat lhs = make_matrix<float>(dimensions, 1);
+        const dmat rhs = make_matrix<float>(dimensions, 5);
+        const dmat expected = naive_product(lhs, rhs);
+        products_match &= nearly_equal(lhs * rhs, expected, 1e-5);
+        products_match &= nearly_equal(lhs.multiply(rhs, 4), expected, 1e-5);
+        const dmatd lhs_double = make_matrix<double>(dimensions, 2);
+        products_match &= nearly_equal(lhs_double.multiply(lhs_double, 3), naive_product(lhs_double, lhs_double), 1e-12);
+    }
+    EXPECT_TRUE(products_match);
+
+    // threaded products give the single threaded results exactly
+    const dmat large = make_matrix<float>(257, 3);
+    EXPECT_EQUAL(large.multiply(large, 8), large * large);
+    EXPECT_EQUAL(large.transpose().transpose(), large);
+
+    // least squares sized systems
+    const dmatd system = make_matrix<double>(96, 4);
+    vec expected(96);
+    for (size_t i = 0; i < expected.size(); i++) {
+        expected[i] = std::sin(double(i));
+    }
+    const vec solution = system.solve(system * expected);
+    double error = 0;
+    for (size_t i = 0; i < expected.size(); i++) {
+        error = std::max(error, std::fabs(solution[i] - expected[i]));
+    }
+    EXPECT_TRUE(error < 1e-10);
+    EXPECT_TRUE(nearly_equal(system * system.invert(), dmatd::make_identity(96), 1e-10));
+
+    // singular matrices
+    const dmatd singular(3, {1, 2, 3, 2, 4, 6, 0, 1, 1});
+    EXPECT_EQUAL(singular.determinant(), 0.);
+    EXPECT_EXCEPTION(singular.invert(), math::matrix_error);
+    EXPECT_TRUE(nearly_equal(singular.adjugate(), dmatd(math::matrix<3, double>{1, 2, 3, 2, 4, 6, 0, 1, 1}.adjugate()), 1e-12));
+
+    // rank n - 1 against the cofactors, lower ranks have a zero adjugate
+    dmatd rank_deficient = make_matrix<double>(7, 5);
+    for (size_t col = 0; col < 7; col++) {
+        rank_deficient.element(4, col) = 2 * rank_deficient.at(1, col);
+    }
+    dmatd cofactors(7);
+    for (size_t row = 0; row < 7; row++) {
+        for (size_t col = 0; col < 7; col++) {
+            cofactors.element(col, row) = rank_deficient.cofactor(row, col);
+        }
+    }
+    EXPECT_EQUAL(rank_deficient.determinant(), 0.);
+    EXPECT_TRUE(nearly_equal(rank_deficient.adjugate(), cofactors, 1e-9));
+    for (size_t col = 0; col < 7; col++) {
+        rank_deficient.element(6, col) = rank_deficient.at(2, col);
+    }
+    EXPECT_EQUAL(rank_deficient.adjugate(), dmatd(7));
+    EXPECT_EQUAL(dmatd(1).adjugate(), dmatd::make_identity(1));
+
+    using list = std::initializer_list<float>;
+    EXPECT_EXCEPTION(dmat(2, list{1, 2, 3}), math::matrix_error);
+    EXPECT_EXCEPTION(dmat(2) * dmat(3), math::matrix_error);
+    EXPECT_EXCEPTION(dmat(2) * std::vector<float>(3), math::matrix_error);
+END_TEST()
@@ -0,0 +1,91 @@
+#include <deps/testing.h/testing.h>
+#include <common/frustum.hpp>
+#include <cmath>
+#include <vector>
+
+// clip space point divided by w
+vector::vec3 project(const vector::vec3& point, const math::mat4f& matrix) {
+    const vector::vec4 clip = vector::vec4({point[0], point[1], point[2], 1}) * matrix;
+    return vector::vec3({clip[0] / clip[3], clip[1] / clip[3], clip[2] / clip[3]});
+}
+
+bool nearly_equal(const vector::vec3& a, const vector::vec3& b) {
+    return std::fabs(a[0] - b[0]) < 1e-4f && std::fabs(a[1] - b[1]) < 1e-4f && std::fabs(a[2] - b[2]) < 1e-4f;
+}
+
+BEGIN_TEST()
+    // depth runs from -1 at the near plane to 1 at the far plane
+    const math::mat4f projection = math::perspective(1.2f, 16.f / 9, .5f, 100);
+    EXPECT_TRUE(nearly_equal(project(vector::vec3({0, 0, -.5f}), projection), vector::vec3({0, 0, -1})));
+    EXPECT_TRUE(nearly_equal(project(vector::vec3({0, 0, -100}), projection), vector::vec3({0, 0, 1})));
+    const float edge = std::tan(.6f) * 10;
+    EXPECT_TRUE(std::fabs(project(vector::vec3({0, edge, -10}), projection)[1] - 1) < 1e-4f);
+    EXPECT_TRUE(std::fabs(project(vector::vec3({edge * 16 / 9, 0, -10}), projection)[0] - 1) < 1e-4f);
+
+    const math::mat4f ortho = math::orthographic(-4, 2, -1, 3, 1, 11);
+    EXPECT_TRUE(nearly_equal(project(vector::vec3({-4, -1, -1}), ortho), vector::vec3({-1, -1, -1})));
+    EXPECT_TRUE(nearly_equal(project(vector::vec3({2, 3, -11}), ortho), vector::vec3({1, 1, 1})));
+
+    // the eye moves to the origin, the target onto the -z axis
+    const vector::vec3 eye({3, 4, 5});
+    const math::mat4f view = math::look_at(eye, vector::vec3({3, 4, -5}), vector::vec3({0, 1, 0}));
+    EXPECT_TRUE(nearly_equal(project(eye, view), vector::vec3({0, 0, 0})));
+    EXPECT_TRUE(nearly_equal(project(vector::vec3({3, 4, -5}), view), vector::vec3({0, 0, -10})));
+    EXPECT_TRUE(nearly_equal(project(vector::vec3({4, 5, 5}), view), vector::vec3({1, 1, 0})));
+    const math::mat4f tilted = math::look_at(vector::vec3({1, 2, 3}), vector::vec3({-2, 0, 1}), vector::vec3({0, 1, 0}));
+    EXPECT_TRUE(std::fabs(tilted.determinant() - 1) < 1e-5f);
+    EXPECT_TRUE(nearly_equal(project(vector::vec3({-2, 0, 1}), tilted), vector::vec3({0, 0, -std::sqrt(17.f)})));
+
+    // planes of the view projection
+    const math::frustum camera(math::mat4f(view * projection));
+    EXPECT_TRUE(std::fabs(camera.plane(math::frustum::near_plane)[3] - (5 - .5f)) < 1e-3f);
+    EXPECT_TRUE(camera.intersects(math::sphere(vector::vec3({3, 4, -20}), 1)));
+    EXPECT_TRUE(!camera.intersects(math::sphere(vector::vec3({3, 4, 10}), 1)));
+    EXPECT_TRUE(camera.intersects(math::sphere(vector::vec3({3, 4, 5.5f}), 1)));
+    EXPECT_TRUE(!camera.intersects(math::sphere(vector::vec3({3, 4, -200}), 50)));
+    EXPECT_TRUE(camera.intersects(math::sphere(vector::vec3({3, 4, -200}), 150)));
+    EXPECT_TRUE(!camera.intersects(math::sphere(vector::vec3({3 - 20, 4, -10}), 1)));
+    EXPECT_TRUE(camera.intersects(math::aabb{vector::vec3({-100, 3, -10}), vector::vec3({-90, 5, -9})}) == false);
+    EXPECT_TRUE(camera.intersects(math::aabb{vector::vec3({-100, 3, -10}), vector::vec3({100, 5, -9})}));
+    EXPECT_TRUE(camera.intersects(math::aabb{vector::vec3({2, 3, -10}), vector::vec3({4, 5, -9})}));
+    EXPECT_TRUE(!camera.intersects(math::aabb{vector::vec3({2, 3, 6}), vector::vec3({4, 5, 7})}));
+
+    // orthographic frustums are boxes, the box tests are exact there
+    const math::frustum box(ortho);
+    EXPECT_TRUE(box.intersects(math::aabb{vector::vec3({1.9f, 2.9f, -2}), vector::vec3({5, 5, 5})}));
+    EXPECT_TRUE(!box.intersects(math::aabb{vector::vec3({2.1f, 0, -2}), vector::vec3({5, 1, -1})}));
+    EXPECT_TRUE(!box.intersects(math::aabb{vector::vec3({0, 0, -13}), vector::vec3({1, 1, -11.5f})}));
+
+    // batches give the single volume results, counts cover the 8, 4 and scalar paths
+    std::vector<math::sphere> spheres;
+    std::vector<math::aabb> boxes;
+    for (size_t i = 0; i < 1003; i++) {
+        const vector::vec3 center({std::sin(i * 1.3f) * 60, std::cos(i * .7f) * 40, std::sin(i * .37f) * 120 - 40});
+        const float size = 1 + (i % 11);
+        spheres.push_back(math::sphere(center, size));
+        boxes.push_back(math::aabb{center - vector::vec3({size, size * .5f, size}), center + vector::vec3({size * .5f, size, size * 2})});
+    }
+    bool batches_match = true;
+    size_t visible_spheres = 0;
+    for (const size_t count : {0, 1, 3, 4, 7, 8, 13, 1003}) {
+        std::vector<uint32_t> sphere_indices(count), box_indices(count);
+        const size_t sphere_count = camera.cull(spheres.data(), count, sphere_indices.data());
+        const size_t box_count = camera.cull(boxes.data(), count, box_indices.data());
+        std::vector<uint32_t> expected_spheres, expected_boxes;
+        for (uint32_t i = 0; i < count; i++) {
+            if (camera.intersects(spheres[i])) {
+                expected_spheres.push_back(i);
+            }
+            if (camera.intersects(boxes[i])) {
+                expected_boxes.push_back(i);
+            }
+        }
+        sphere_indices.resize(sphere_count);
+        box_indices.resize(box_count);
+        batches_match &= sphere_indices == expected_spheres && box_indices == expected_boxes;
+        visible_spheres = sphere_count;
+    }
+    EXPECT_TRUE(batches_match);
+    // both outcomes occur
+    EXPECT_TRUE(visible_spheres > 50 && visible_spheres < 950);
+END_TEST()
@@ -0,0 +1,121 @@
+#include <deps/testing.h/testing.h>
+#include <common/job_system.hpp>
+#include <common/scene_graph.hpp>
+#include <common/transform.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+math::mat4f local_transform(const size_t seed) {
+    return math::trs(vector::vec3({float(seed % 5), 1, float(seed % 3)}), vector::vec3({seed * .01f, seed * .02f, 0}), vector::vec3({1, 1, 1}));
+}
+
+BEGIN_TEST()
+    // more threads than cores, every item exactly once
+    common::job_system jobs(8);
+    EXPECT_EQUAL(jobs.concurrency(), 8u);
+    bool covered = true;
+    for (size_t round = 0; round < 200; round++) {
+        const size_t count = round * 37 + 1;
+        std::vector<std::atomic<int>> visits(count);
+        jobs.parallel_for(count, [&visits](const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                visits[i]++;
+            }
+        });
+        for (const auto& visit : visits) {
+            covered &= visit == 1;
+        }
+    }
+    EXPECT_TRUE(covered);
+
+    // nested loops wait by running jobs, they cannot starve the pool
+    std::atomic<size_t> nested(0);
+    jobs.parallel_for(64, [&](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            jobs.parallel_for(100, [&nested](const size_t first, const size_t last) {
+                nested += last - first;
+            });
+        }
+    });
+    EXPECT_EQUAL(nested.load(), 6400u);
+
+    // several threads outside the pool submitting at once
+    std::atomic<size_t> submitted(0);
+    std::vector<std::thread> producers;
+    for (size_t producer = 0; producer < 4; producer++) {
+        producers.emplace_back([&] {
+            for (size_t round = 0; round < 100; round++) {
+                common::job_counter counter;
+                for (size_t job = 0; job < 50; job++) {
+                    jobs.submit([&submitted] { submitted++; }, counter);
+                }
+                jobs.wait(counter);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    EXPECT_EQUAL(submitted.load(), 4u * 100 * 50);
+
+    // exceptions reach the waiting thread
+    EXPECT_EXCEPTION(jobs.parallel_for(1000, [](const size_t begin, const size_t) {
+        if (begin) {
+            throw std::runtime_error("job failed");
+        }
+    }), std::runtime_error);
+
+    // dependency graph: a diamond per stage, stages chained
+    common::job_graph graph;
+    std::vector<size_t> finished(400, 0);
+    std::atomic<size_t> clock(0);
+    std::vector<common::job_graph::job_id> ids;
+    for (size_t i = 0; i < finished.size(); i++) {
+        ids.push_back(graph.add([&finished, &clock, i] { finished[i] = ++clock; }));
+        if (i % 4 == 1 || i % 4 == 2) {
+            graph.depend(ids[i], ids[i - i % 4]);
+        } else if (i % 4 == 3) {
+            graph.depend(ids[i], ids[i - 1]);
+            graph.depend(ids[i], ids[i - 2]);
+        } else if (i) {
+            graph.depend(ids[i], ids[i - 1]);
+        }
+    }
+    bool ordered = true;
+    for (size_t run = 0; run < 20; run++) {
+        graph.run(jobs);
+        for (size_t i = 4; i < finished.size(); i++) {
+            const size_t stage = i - i % 4;
+            ordered &= finished[i] > finished[stage - 1];
+            ordered &= i % 4 == 0 || finished[i] > finished[stage];
+            ordered &= i % 4 != 3 || (finished[i] > finished[i - 1] && finished[i] > finished[i - 2]);
+        }
+    }
+    EXPECT_TRUE(ordered);
+    EXPECT_EQUAL(clock.load(), 20u * 400);
+
+    // parallel scene updates give the serial results exactly
+    math::scene_graph serial, parallel;
+    std::vector<math::scene_graph::node_id> nodes;
+    for (size_t i = 0; i < 20000; i++) {
+        const math::scene_graph::node_id parent = i < 4 ? math::scene_graph::none : nodes[(i * 7919) % i];
+        nodes.push_back(serial.add(local_transform(i), parent));
+        parallel.add(local_transform(i), parent);
+    }
+    bool scenes_match = true;
+    for (size_t frame = 0; frame < 30; frame++) {
+        for (size_t i = frame; i < nodes.size(); i += 50 + frame) {
+            serial.set_local(nodes[i], local_transform(i + frame));
+            parallel.set_local(nodes[i], local_transform(i + frame));
+        }
+        scenes_match &= serial.update() == parallel.update(jobs);
+        scenes_match &= serial.world_transforms() == parallel.world_transforms();
+        auto changed = parallel.changed().begin();
+        for (const math::scene_graph::changed_transform transform : serial.changed()) {
+            scenes_match &= transform.node == (*changed++).node;
+        }
+    }
+    EXPECT_TRUE(scenes_match);
+END_TEST()
@@ -1,6 +1,11 @@
 #include <deps/testing.h/testing.h>
 #include <common/linear_square_array.hpp>
 
+static_assert(alignof(math::linear_square_array<4, float>) == 16, "mat4f storage is SSE aligned");
+static_assert(alignof(math::linear_square_array<4, float, math::aligned_layout<32>>) == 32, "AVX aligned layout");
+static_assert(sizeof(math::linear_square_array<3, float>) == 36, "no padding by default");
+static_assert(sizeof(math::linear_square_array<3, float, math::std140_layout<>>) == 48, "std140 rows are vec4");
+
 BEGIN_TEST()
     using lsa3 = math::linear_square_array<3, uint8_t>;
     lsa3 data = {
@@ -18,4 +23,26 @@ BEGIN_TEST()
         7, 8, 1
     };
     EXPECT_EQUAL(data, after_swap);
+
+    // padded rows: indexing skips the padding, raw() exposes it
+    using lsa3f = math::linear_square_array<3, float>;
+    using std140_lsa3f = math::linear_square_array<3, float, math::std140_layout<>>;
+    const lsa3f dense = {
+        1, 2, 3,
+        4, 5, 6,
+        7, 8, 9
+    };
+    const std140_lsa3f padded(dense);
+    EXPECT_EQUAL(padded.at({2, 1}), 8.f);
+    EXPECT_EQUAL(padded.at(5), 6.f);
+    EXPECT_EQUAL(padded.raw()[4], 4.f);
+    EXPECT_EQUAL(padded.raw()[3], 0.f);
+    EXPECT_EQUAL(padded.raw()[8], 7.f);
+    EXPECT_EQUAL(lsa3f(padded), dense);
+    const std140_lsa3f listed = {
+        1, 2, 3,
+        4, 5, 6,
+        7, 8, 9
+    };
+    EXPECT_EQUAL(listed, padded);
 END_TEST()
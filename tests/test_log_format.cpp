@@ -0,0 +1,135 @@
+#include <deps/testing.h/testing.h>
+#include <common/log_format.hpp>
+#include <common/logger.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+std::string read_file(const char* filename) {
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+std::string decode_file(const char* filename, bool& decoded) {
+    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    std::stringstream text;
+    decoded = common::binary_log::decode(file, text);
+    return text.str();
+}
+
+template <typename... argument_types>
+std::string rendered(const char* format, const argument_types&... arguments) {
+    std::string text;
+    common::binary_log::render(format, text, arguments...);
+    return text;
+}
+
+// the same as rendered(), through the encoded arguments
+template <typename... argument_types>
+std::string round_trip(const char* format, const argument_types&... arguments) {
+    common::binary_log::bytes payload;
+    (common::binary_log::encode(payload, arguments), ...);
+    common::binary_log::reader reader(payload.data(), payload.size());
+    std::string text;
+    return common::binary_log::render_encoded(format, reader, text) ? text : "malformed";
+}
+
+// what dump_details() logs for a small program
+void log_session(common::logger& log) {
+    static const common::log_format header("-----------------------------\ninformation for shader program {}:\n");
+    static const common::log_format active_attributes("GL_ACTIVE_ATTRIBUTES = {}\n");
+    static const common::log_format variable(" {}) type: {} name: {} location: {}\n");
+    log.record(header, 3u);
+    log.record(active_attributes, 40);
+    for (unsigned i = 0; i < 40; i++) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "vertex_attribute_%u", i);
+        log.record(variable, i, "vec3", name, int(i) - 1);
+    }
+    log << common::logger::message_type::warning;
+    log.record(active_attributes, -1);
+    // too long for a record of the asynchronous logger, stored as text there
+    log.record(header, std::string(300, 'x'));
+    log << "-----------------------------\n";
+}
+
+BEGIN_TEST()
+    // placeholders take the arguments in order
+    EXPECT_EQUAL(rendered("{} + {} = {}\n", -7, 12u, 5L), "-7 + 12 = 5\n");
+    EXPECT_EQUAL(rendered("{} and {}", 0.5f, 2.25), "0.5 and 2.25");
+    EXPECT_EQUAL(rendered("{}{}{}", "const char*", std::string(" string "), 'c'), "const char* string c");
+    EXPECT_EQUAL(rendered("{} {}", 1), "1 {}");
+    EXPECT_EQUAL(rendered("{} {}", common::gl_enum{0x8B31}, common::gl_enum{0x8B8A}), "GL_VERTEX_SHADER 0x8b8a");
+    EXPECT_EQUAL(rendered("{}", 1, 2), "1");
+    EXPECT_EQUAL(rendered("no placeholders"), "no placeholders");
+
+    // encoded arguments render the same
+    EXPECT_EQUAL(round_trip("{} + {} = {}\n", -7, 12u, 5L), "-7 + 12 = 5\n");
+    EXPECT_EQUAL(round_trip("{} {} {} {}", std::numeric_limits<int64_t>::min(), ~uint64_t(0), int8_t(-128), true), "-9223372036854775808 18446744073709551615 -128 1");
+    EXPECT_EQUAL(round_trip("{} and {}", 0.5f, 2.25), "0.5 and 2.25");
+    EXPECT_EQUAL(round_trip("{}{}{}", "const char*", std::string(" string "), 'c'), "const char* string c");
+    EXPECT_EQUAL(round_trip("{} {}", 1), "1 {}");
+    EXPECT_EQUAL(round_trip("{} {}", common::gl_enum{0x8B31}, common::gl_enum{0x8B8A}), "GL_VERTEX_SHADER 0x8b8a");
+    EXPECT_EQUAL(round_trip("{}", 1, 2), "1");
+
+    // a binary log decodes to the text log, in both modes
+    {
+        common::logger log("test", false, "test_log_format.log");
+        log_session(log);
+    }
+    const std::string text = read_file("test_log_format.log");
+    bool decoded = false;
+    {
+        common::logger log("test", false, "test_log_format.blog", common::logger::output_format::binary);
+        log_session(log);
+    }
+    EXPECT_EQUAL(decode_file("test_log_format.blog", decoded), text);
+    EXPECT_TRUE(decoded);
+    const size_t binary_size = read_file("test_log_format.blog").size();
+    EXPECT_TRUE(binary_size < text.size() * 3 / 4);
+    {
+        common::logger log("test", common::logger::async_options{8, common::logger::overflow_policy::block}, false, "test_log_format_async.blog", common::logger::output_format::binary);
+        log_session(log);
+    }
+    EXPECT_EQUAL(decode_file("test_log_format_async.blog", decoded), text);
+    EXPECT_TRUE(decoded);
+
+    // mirrored lines are rendered as text
+    for (const bool async : {false, true}) {
+        std::stringstream mirror;
+        std::streambuf* error_buffer = std::cerr.rdbuf(mirror.rdbuf());
+        {
+            common::logger log = async ? common::logger("test", common::logger::async_options{8, common::logger::overflow_policy::block}, true, "test_log_format_mirror.blog", common::logger::output_format::binary)
+                                       : common::logger("test", true, "test_log_format_mirror.blog", common::logger::output_format::binary);
+            log_session(log);
+        }
+        std::cerr.rdbuf(error_buffer);
+        EXPECT_EQUAL(mirror.str(), text);
+    }
+
+    // anything else is refused
+    {
+        std::stringstream input("default.log text"), output;
+        EXPECT_TRUE(!common::binary_log::decode(input, output));
+    }
+    {
+        const std::string binary = read_file("test_log_format.blog");
+        std::stringstream input(binary.substr(0, binary.size() - 3)), output;
+        EXPECT_TRUE(!common::binary_log::decode(input, output));
+    }
+    {
+        // a corrupt size far beyond the input ends the decoding instead of allocating it
+        const std::string binary = read_file("test_log_format.blog");
+        std::stringstream input(binary.substr(0, 8) + "\x01\xff\xff\xff\xff\xff\xff\xff\xff\x7f" + std::string(100, 'x')), output;
+        EXPECT_TRUE(!common::binary_log::decode(input, output));
+    }
+
+    for (const char* filename : {"test_log_format.log", "test_log_format.blog", "test_log_format_async.blog", "test_log_format_mirror.blog"}) {
+        std::remove(filename);
+    }
+END_TEST()
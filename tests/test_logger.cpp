@@ -0,0 +1,245 @@
+#include <deps/testing.h/testing.h>
+#include <common/logger.hpp>
+#include <common/record_ring.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// every log is read back once and then deleted, so that runs leave nothing behind
+std::string read_file(const char* filename) {
+    std::stringstream text;
+    {
+        std::ifstream file(filename);
+        text << file.rdbuf();
+    }
+    std::remove(filename);
+    return text.str();
+}
+
+std::vector<std::string> read_lines(const char* filename) {
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(filename);
+        std::string line;
+        while (std::getline(file, line)) {
+            lines.push_back(line);
+        }
+    }
+    std::remove(filename);
+    return lines;
+}
+
+// the same messages through any logger
+void log_session(common::logger& log) {
+    log << common::logger::message_type::warning << "texture " << std::string("grass.png") << " missing\n";
+    log << common::logger::message_type::error << "could not link shader program\n";
+    log << std::string(1000, 'x') << "\n";
+    log << reinterpret_cast<const unsigned char*>("GL_VERSION 4.5\n");
+}
+
+BEGIN_TEST()
+    // records come out in order, full rings refuse further records
+    common::record_ring ring(3);
+    EXPECT_EQUAL(ring.capacity(), 4u);
+    size_t position = 0;
+    bool pushed = true;
+    for (size_t i = 0; i < 4; i++) {
+        const std::string text = "record " + std::to_string(i);
+        pushed &= ring.try_push(text.data(), text.size(), uint32_t(i), &position);
+        pushed &= position == i;
+    }
+    EXPECT_TRUE(pushed);
+    EXPECT_TRUE(!ring.try_push("full", 4, 0));
+    std::vector<std::string> records;
+    bool tagged = true;
+    EXPECT_EQUAL(ring.consume([&](const char* data, const size_t size, const uint32_t tag) {
+        tagged &= tag == records.size();
+        records.emplace_back(data, size);
+    }), 4u);
+    EXPECT_TRUE(tagged);
+    EXPECT_EQUAL(records.front(), "record 0");
+    EXPECT_EQUAL(records.back(), "record 3");
+    EXPECT_TRUE(ring.try_push("again", 5, 0));
+    EXPECT_EQUAL(ring.pushed(), 5u);
+    EXPECT_EQUAL(ring.consumed(), 4u);
+
+    // numbers, vectors and matrices look the same as through std::ostream
+    {
+        const vector::vec3 position({1.5f, -2, 0.1f});
+        const math::matrix<4, float> transform{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16.25f};
+        std::stringstream expected;
+        expected << -42 << " " << 42u << " " << int64_t(-9000000000) << " " << uint16_t(65535) << " " << int(int8_t(-5)) << " " << 'c' << "\n"
+                 << 0.1f << " " << 1e-7 << " " << 123456789.0 << " " << -0.0 << " " << 1.0f / 3 << " " << 2.0e20f << "\n"
+                 << position << " " << transform << "\n";
+        {
+            common::logger log("test", false, "test_logger_values.log");
+            log << -42 << " " << 42u << " " << int64_t(-9000000000) << " " << uint16_t(65535) << " " << int8_t(-5) << " " << 'c' << "\n"
+                << 0.1f << " " << 1e-7 << " " << 123456789.0 << " " << -0.0 << " " << 1.0f / 3 << " " << 2.0e20f << "\n"
+                << position << " " << transform << "\n"
+                << common::gl_enum{0x8B51} << " " << common::gl_enum{0x8B82} << " " << common::gl_enum{0x1234} << "\n";
+        }
+        const std::string text = read_file("test_logger_values.log");
+        EXPECT_TRUE(text.find(expected.str()) != std::string::npos);
+        EXPECT_TRUE(text.find("GL_FLOAT_VEC3 GL_LINK_STATUS 0x1234\n") != std::string::npos);
+    }
+
+    // memory sinks keep the last bytes written
+    {
+        common::memory_sink<8> sink;
+        sink.write("0123", 4);
+        EXPECT_EQUAL(sink.text(), "0123");
+        sink.write("456789", 6);
+        EXPECT_EQUAL(sink.text(), "23456789");
+        sink.write("abcdefghijklmnopqrst", 20);
+        EXPECT_EQUAL(sink.text(), "mnopqrst");
+        EXPECT_EQUAL(sink.written(), 30u);
+    }
+
+    // lines below the minimum level are dropped without being formatted, the
+    // counters see the rest
+    {
+        using quiet_logger = common::basic_logger<common::log_level::warning, common::memory_sink<4096>>;
+        static_assert(!quiet_logger::enabled(common::log_level::notice) && quiet_logger::enabled(common::log_level::error), "levels below the minimum are disabled");
+        static_assert(std::is_same<decltype(std::declval<quiet_logger&>().at<common::log_level::debug>()), common::disabled_log>::value, "disabled lines compile to nothing");
+        static_assert(!common::basic_logger<common::log_level::debug, common::null_sink>::enabled(common::log_level::error), "null sinks disable every level");
+        static const common::log_format link_error("could not link shader program {}\n");
+        for (const bool async : {false, true}) {
+            quiet_logger log = async ? quiet_logger("test", quiet_logger::async_options{16, quiet_logger::overflow_policy::block}) : quiet_logger("test");
+            log.at<common::log_level::debug>() << "uniform " << vector::vec3({1, 2, 3}) << "\n";
+            log.at<common::log_level::notice>().record(link_error, 2);
+            log.at<common::log_level::warning>() << "texture " << std::string("grass.png") << " missing\n";
+            log.at<common::log_level::error>().record(link_error, 3);
+            log.flush();
+            EXPECT_EQUAL(log.sink<common::memory_sink<4096>>().text(), "[INFO] starting build version 'test'...\n[WARNING] texture grass.png missing\n[ERROR] could not link shader program 3\n");
+            EXPECT_EQUAL(log.warnings(), 1u);
+            EXPECT_EQUAL(log.errors(), 1u);
+        }
+    }
+
+    // long texts span several records, the output matches the synchronous logger
+    {
+        common::logger log("test", false, "test_logger_sync.log");
+        log_session(log);
+    }
+    const std::string synchronous = read_file("test_logger_sync.log");
+    EXPECT_TRUE(synchronous.find("1 warnings\n1 errors\n") != std::string::npos);
+    {
+        common::logger log("test", common::logger::async_options{4, common::logger::overflow_policy::block}, false, "test_logger_async.log");
+        log_session(log);
+        EXPECT_EQUAL(log.dropped(), 0u);
+    }
+    EXPECT_EQUAL(read_file("test_logger_async.log"), synchronous);
+
+    // flush() waits for the writer
+    {
+        common::logger log("test", common::logger::async_options{64, common::logger::overflow_policy::block}, false, "test_logger_flush.log");
+        log << "flushed\n";
+        log.flush();
+        EXPECT_TRUE(read_file("test_logger_flush.log").find("flushed\n") != std::string::npos);
+    }
+
+    // more producers than a chunk of staging buffers in both modes, through a small
+    // ring: lines built from several texts stay whole, also those longer than a
+    // record, nothing is lost and the lines of every thread keep their order and
+    // their stamps. Short lived threads before them reuse their indices
+    const size_t threads = 80, lines = 400, short_lived = 100;
+    for (const bool async : {false, true}) {
+        {
+            common::logger log = async ? common::logger("test", common::logger::async_options{16, common::logger::overflow_policy::block}, false, "test_logger_threads.log")
+                                       : common::logger("test", false, "test_logger_threads.log");
+            log.stamp_lines(true);
+            for (size_t thread = 0; thread < short_lived; thread++) {
+                std::thread([&log, thread] {
+                    log << "short lived " << thread << "\n";
+                }).join();
+            }
+            std::vector<std::thread> producers;
+            for (size_t thread = 0; thread < threads; thread++) {
+                producers.emplace_back([&log, thread] {
+                    for (size_t line = 0; line < lines; line++) {
+                        if (line % 100 == 0) {
+                            log << common::logger::message_type::warning;
+                        }
+                        log << "thread " << thread << " line " << line << " " << std::string(line % 7 * 60, char('a' + thread % 26)) << "\n";
+                    }
+                });
+            }
+            for (auto& producer : producers) {
+                producer.join();
+            }
+            EXPECT_EQUAL(log.warnings(), threads * lines / 100);
+        }
+        std::vector<size_t> next(threads, 0), index(threads, 0);
+        std::vector<double> stamp(threads, 0);
+        size_t short_lived_lines = 0, short_lived_index = 0;
+        bool whole = true;
+        for (const std::string& line : read_lines("test_logger_threads.log")) {
+            double seconds;
+            size_t thread_index, thread, number;
+            int payload = 0;
+            const size_t start = line.find("thread ");
+            if (line.find("short lived ") != std::string::npos) {
+                // every one of them exited before the next started, so all had the same index
+                whole &= std::sscanf(line.c_str(), "[%lf #%zu] short lived %zu", &seconds, &thread_index, &number) == 3 && number == short_lived_lines++
+                         && (!number || thread_index == short_lived_index);
+                short_lived_index = thread_index;
+                continue;
+            }
+            if (std::sscanf(line.c_str(), "[%lf #%zu] ", &seconds, &thread_index) != 2 || start == std::string::npos) {
+                continue;
+            }
+            whole &= std::sscanf(line.c_str() + start, "thread %zu line %zu %n", &thread, &number, &payload) == 2 && thread < threads;
+            if (!whole) {
+                break;
+            }
+            whole &= number == next[thread]++ && seconds >= stamp[thread] && (!number || thread_index == index[thread]);
+            whole &= line.substr(start + size_t(payload)) == std::string(number % 7 * 60, char('a' + thread % 26));
+            stamp[thread] = seconds;
+            index[thread] = thread_index;
+        }
+        EXPECT_TRUE(whole);
+        EXPECT_EQUAL(short_lived_lines, short_lived);
+        EXPECT_TRUE(next == std::vector<size_t>(threads, lines));
+
+        // the unfinished line of an exited thread is written before the next thread
+        // with its index starts a line
+        {
+            common::logger log = async ? common::logger("test", common::logger::async_options{16, common::logger::overflow_policy::block}, false, "test_logger_threads.log")
+                                       : common::logger("test", false, "test_logger_threads.log");
+            std::thread([&log] {
+                log << "unfinished " << std::string(300, 'u');
+            }).join();
+            std::thread([&log] {
+                log << "next\n";
+            }).join();
+        }
+        EXPECT_TRUE(read_file("test_logger_threads.log").find("unfinished " + std::string(300, 'u') + "next\n") != std::string::npos);
+    }
+
+    // dropped records are counted and reported in the log
+    const size_t burst = 20000;
+    size_t dropped = 0;
+    {
+        common::logger log("test", common::logger::async_options{4, common::logger::overflow_policy::count_drops}, false, "test_logger_drops.log");
+        for (size_t line = 0; line < burst; line++) {
+            log << "burst\n";
+        }
+        dropped = log.dropped();
+    }
+    size_t written = 0, reported = 0;
+    for (const std::string& line : read_lines("test_logger_drops.log")) {
+        size_t count;
+        if (line == "burst") {
+            written++;
+        } else if (std::sscanf(line.c_str(), "[WARNING] %zu log records dropped", &count) == 1) {
+            reported += count;
+        }
+    }
+    EXPECT_EQUAL(written + dropped, burst);
+    EXPECT_EQUAL(reported, dropped);
+END_TEST()
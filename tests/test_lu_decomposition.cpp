@@ -0,0 +1,81 @@
+#include <deps/testing.h/testing.h>
+#include <common/matrix.hpp>
+#include <cmath>
+
+template <size_t dimensions>
+bool nearly_equal(const math::matrix<dimensions, double>& a, const math::matrix<dimensions, double>& b, const double epsilon = 1e-9) {
+    for (size_t i = 0; i < dimensions * dimensions; i++) {
+        if (std::fabs(a.container().at(i) - b.container().at(i)) > epsilon) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t dimensions>
+math::matrix<dimensions, double> test_matrix() {
+    typename math::matrix<dimensions, double>::container_type data;
+    for (size_t row = 0; row < dimensions; row++) {
+        for (size_t col = 0; col < dimensions; col++) {
+            // diagonally dominant, but not symmetric and with a zero on the diagonal start
+            data[{row, col}] = row == col ? (row ? dimensions * 2. : 0.) : 1. / (row + 2 * col + 1);
+        }
+    }
+    return math::matrix<dimensions, double>{data};
+}
+
+BEGIN_TEST()
+    // decomposition with pivoting
+    math::matrix<3, double> m3 = {
+        0, 2, 1,
+        1, 1, 1,
+        2, 1, 0
+    };
+    auto lu = m3.lu();
+    EXPECT_FALSE(lu.singular());
+    EXPECT_EQUAL(lu.permutation()[0], 2u);
+    EXPECT_EQUAL(lu.determinant(), m3.determinant());
+    EXPECT_TRUE(nearly_equal(math::matrix<3, double>{lu.invert()}, m3.invert()));
+
+    // solving
+    vector::vector<double, 3> x({1, 2, 3});
+    auto b = m3 * x;
+    auto solved = m3.solve(b);
+    for (size_t i = 0; i < 3; i++) {
+        EXPECT_TRUE(std::fabs(solved.data()[i] - x.data()[i]) < 1e-12);
+    }
+
+    // singular systems
+    math::matrix<3, double> singular = {
+        1, 2, 3,
+        2, 4, 6,
+        7, 8, 9
+    };
+    EXPECT_TRUE(singular.lu().singular());
+    EXPECT_EQUAL(singular.lu().determinant(), 0);
+    EXPECT_EXCEPTION(singular.solve(x), math::matrix_error);
+
+    // closed forms agree with the decomposition
+    auto m4 = test_matrix<4>();
+    EXPECT_TRUE(std::fabs(m4.determinant() - m4.lu().determinant()) < 1e-9);
+    EXPECT_TRUE(nearly_equal(m4.invert(), math::matrix<4, double>{m4.lu().invert()}));
+    EXPECT_TRUE(nearly_equal((m4 * m4.invert()).evaluate(), m4.identity()));
+
+    math::mat4f transform = math::rotate_z(.3f) * math::translate(1, 2, 3) * math::scale(2, 3, 4);
+    EXPECT_TRUE(std::fabs(transform.determinant() - 24) < 1e-4);
+    math::mat4f roundtrip = transform * transform.invert();
+    for (size_t i = 0; i < 16; i++) {
+        EXPECT_TRUE(std::fabs(roundtrip.container().at(i) - transform.identity().container().at(i)) < 1e-5);
+    }
+
+    // large matrices
+    auto m8 = test_matrix<8>();
+    EXPECT_TRUE(nearly_equal((m8 * m8.invert()).evaluate(), m8.identity()));
+    EXPECT_TRUE(std::fabs(m8.determinant() - m8.transpose().determinant()) < 1e-6);
+
+    auto m16 = test_matrix<16>();
+    EXPECT_TRUE(nearly_equal((m16.invert() * m16).evaluate(), m16.identity()));
+
+    using mat5d = math::matrix<5, double>;
+    EXPECT_EXCEPTION(mat5d{}.invert(), math::matrix_error);
+END_TEST()
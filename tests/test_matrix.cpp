@@ -1,5 +1,31 @@
 #include <deps/testing.h/testing.h>
 #include <common/matrix.hpp>
+#include <cmath>
+
+// compile-time transforms
+constexpr math::mat2f constant_m2 = {
+    1, 2,
+    3, 4
+};
+static_assert(constant_m2.transpose() == math::mat2f{1, 3, 2, 4}, "constexpr transpose");
+static_assert(constant_m2 * constant_m2 == math::mat2f{7, 10, 15, 22}, "constexpr product");
+static_assert(constant_m2 * 2 == math::mat2f{2, 4, 6, 8}, "constexpr scalar product");
+static_assert(constant_m2 * vector::vec2({1, 1}) == vector::vec2({3, 7}), "constexpr vector product");
+static_assert(constant_m2.adjugate() == math::mat2f{4, -2, -3, 1}, "constexpr adjugate");
+static_assert(constant_m2.cofactor<0, 1>() == -3, "compile-time cofactor");
+
+constexpr math::mat4f constant_identity = math::identity4f{};
+static_assert(constant_identity == math::mat4f::make_identity(), "constexpr identity");
+static_assert(constant_identity.identity().container().at({3, 3}) == 1, "constexpr identity");
+
+constexpr math::mat4f constant_model = math::translate(1, 2, 3) * math::scale(2, 4, 8);
+static_assert(constant_model == math::mat4f{
+    2, 0, 0, 0,
+    0, 4, 0, 0,
+    0, 0, 8, 0,
+    2, 8, 24, 1
+}, "constexpr model transform");
+static_assert(constant_model * vector::vec4({1, 0, 0, 0}) == vector::vec4({2, 0, 0, 2}), "constexpr mat4f vector product");
 
 BEGIN_TEST()
     math::identity4f identity;
@@ -72,6 +98,40 @@ BEGIN_TEST()
     };
     EXPECT_EQUAL(m3.adjugate(), m3a);
 
+    // generated cofactors match the submatrix determinants, 5x5 takes the runtime path
+    const math::mat4f m4 = {
+        2, 0, 1, 3,
+        1, 3, 0, 1,
+        1, 0, 4, 2,
+        5, 1, 0, 2
+    };
+    using mat5d = math::matrix<5, double>;
+    const mat5d m5 = {
+        2, 1, 0, 0, 3,
+        1, 4, 1, 0, 0,
+        0, 1, 5, 2, 0,
+        0, 0, 2, 6, 1,
+        1, 0, 0, 1, 7
+    };
+    bool cofactors_match = true;
+    for (size_t row = 0; row < 4; row++) {
+        for (size_t col = 0; col < 4; col++) {
+            const float expected = ((row + col) % 2 ? -1 : 1) * m4.submatrix(row, col).determinant();
+            cofactors_match &= m4.cofactor(row, col) == expected;
+            cofactors_match &= m4.adjugate().container().at({col, row}) == expected;
+        }
+    }
+    EXPECT_TRUE(cofactors_match);
+    const float static_cofactor = m4.cofactor<2, 1>();
+    EXPECT_EQUAL(static_cofactor, m4.cofactor(2, 1));
+    EXPECT_EQUAL(m4 * m4.adjugate(), m4.identity() * m4.determinant());
+    const mat5d m5_scaled_identity = m5 * m5.adjugate();
+    bool scaled_identity = true;
+    for (size_t i = 0; i < 25; i++) {
+        scaled_identity &= std::fabs(m5_scaled_identity.container().at(i) - (i % 6 ? 0 : 871)) < 1e-9;
+    }
+    EXPECT_TRUE(scaled_identity);
+
     // invertions
     math::mat2f m2i = {
         -2, 1,
@@ -98,7 +158,9 @@ BEGIN_TEST()
     };
     EXPECT_EQUAL(m3 * 3, m3x3);
 
-    // TODO: vector
+    vector::vec3 v3({1, 2, 3});
+    EXPECT_EQUAL(m3 * v3, vector::vec3({14, 32, 50}));
+    EXPECT_EQUAL(identity * vector::vec4({1, 2, 3, 4}), vector::vec4({1, 2, 3, 4}));
 
     math::mat2f m2mult = {
         7, 10,
@@ -113,5 +175,33 @@ BEGIN_TEST()
     };
     EXPECT_EQUAL(m3 * m3, m3mult);
 
+    // a held product keeps the operands it was built from
+    math::mat3f m3_operand = m3;
+    auto m3_product = m3_operand * m3;
+    m3_operand = m3x3;
+    EXPECT_EQUAL(m3_product, m3mult);
+
+    // affine inversions
+    math::mat4f rigid = math::rotate_z(.5f) * math::rotate_x(.25f) * math::translate(1, 2, 3);
+    math::mat4f affine = rigid * math::scale(2, .5f, 4);
+    EXPECT_TRUE(rigid.is_affine());
+    EXPECT_TRUE(affine.is_affine());
+    EXPECT_FALSE(m2.is_affine());
+    // invert_rigid() needs an orthonormal linear part
+    EXPECT_TRUE(rigid.is_rigid());
+    EXPECT_FALSE(affine.is_rigid());
+    EXPECT_FALSE(m2.is_rigid());
+
+    math::mat4f affine_inverse = affine.invert_affine();
+    math::mat4f general_inverse = affine.invert();
+    math::mat4f rigid_inverse = rigid.invert_rigid();
+    math::mat4f rigid_general_inverse = rigid.invert();
+    for (size_t i = 0; i < 16; i++) {
+        EXPECT_TRUE(fabs(affine_inverse.container().at(i) - general_inverse.container().at(i)) < 1e-5);
+        EXPECT_TRUE(fabs(rigid_inverse.container().at(i) - rigid_general_inverse.container().at(i)) < 1e-5);
+    }
+    // non-affine input falls back to the generic inversion
+    EXPECT_EQUAL(m2.invert_affine(), m2.invert());
+
     // TODO: special matrices
 END_TEST()
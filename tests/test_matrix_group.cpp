@@ -0,0 +1,101 @@
+#include <deps/testing.h/testing.h>
+#include <common/matrix_group.hpp>
+#include <cmath>
+#include <vector>
+
+template <size_t lanes>
+bool inverts(const std::vector<math::mat4f>& matrices, const bool transposed) {
+    std::vector<math::mat4f_group<lanes>> groups((matrices.size() + lanes - 1) / lanes);
+    math::pack(matrices.data(), matrices.size(), groups.data());
+    bool match = true;
+    for (size_t i = 0; i < groups.size(); i++) {
+        math::mat4f_group<lanes> inverse;
+        const unsigned singular = transposed ? math::invert_transpose(groups[i], inverse) : math::invert(groups[i], inverse);
+        match &= !singular;
+        for (size_t lane = 0; lane < lanes && i * lanes + lane < matrices.size(); lane++) {
+            const math::mat4f expected = transposed ? matrices[i * lanes + lane].invert().transpose() : matrices[i * lanes + lane].invert();
+            for (size_t index = 0; index < 16; index++) {
+                match &= std::fabs(inverse.get(lane).container().at(index) - expected.container().at(index)) < 1e-5f;
+            }
+        }
+    }
+    return match;
+}
+
+static_assert(alignof(math::mat4f_group<4>) == 16 && alignof(math::mat4f_group<8>) == 32, "one register per element");
+
+BEGIN_TEST()
+    std::vector<math::mat4f> lhs, rhs;
+    for (size_t i = 0; i < 11; i++) {
+        lhs.push_back(math::rotate_z(i * .1f) * math::translate(i, 2, 3));
+        rhs.push_back(math::scale(1, i + 1.f, 2) * math::rotate_x(i * -.2f));
+    }
+
+    // element {row, col} of all lanes is contiguous
+    math::mat4f_group<4> group;
+    group.set(2, lhs[5]);
+    EXPECT_EQUAL(group.element(3, 0)[2], lhs[5].container().at({3, 0}));
+    EXPECT_EQUAL(group.raw()[12 * 4 + 2], 5.f);
+    EXPECT_EQUAL(group.get(2), lhs[5]);
+
+    // 11 matrices: two full groups of 4 and an identity padded one
+    std::vector<math::mat4f_group<4>> lhs_groups(3), rhs_groups(3), product_groups(3);
+    math::pack(lhs.data(), lhs.size(), lhs_groups.data());
+    math::pack(rhs.data(), rhs.size(), rhs_groups.data());
+    EXPECT_EQUAL(lhs_groups[2].get(3), math::identity4f{});
+    for (size_t i = 0; i < product_groups.size(); i++) {
+        math::multiply(lhs_groups[i], rhs_groups[i], product_groups[i]);
+    }
+    std::vector<math::mat4f> products(lhs.size());
+    math::unpack(product_groups.data(), products.size(), products.data());
+
+    bool products_match = true;
+    for (size_t i = 0; i < products.size(); i++) {
+        products_match &= products[i] == math::scalar_multiplicator<4, float>::compute(lhs[i].container(), rhs[i].container());
+    }
+    EXPECT_TRUE(products_match);
+
+    // batch inverse, SIMD for 4 and 8 lanes, generic lane loops otherwise
+    EXPECT_TRUE(inverts<4>(lhs, false));
+    EXPECT_TRUE(inverts<8>(rhs, false));
+    EXPECT_TRUE(inverts<2>(lhs, true));
+    EXPECT_TRUE(inverts<8>(rhs, true));
+
+    // singular lanes are zeroed and reported instead of throwing
+    math::mat4f_group<8> mixed;
+    for (size_t lane = 0; lane < 8; lane++) {
+        mixed.set(lane, lane % 3 ? lhs[lane] : math::scale(1, 0, 1) * lhs[lane]);
+    }
+    EXPECT_EQUAL(math::invert(mixed, mixed), 0x49u);
+    EXPECT_EQUAL(mixed.get(3), math::mat4f{});
+    EXPECT_TRUE(std::fabs(mixed.get(1).container().at(5) - lhs[1].invert().container().at(5)) < 1e-5f);
+
+    // a denormal determinant overflows the reciprocal, the inverse is infinite but not NaN
+    const math::mat4f dense = math::mat4f{
+        2, 1, .5f, .25f,
+        1, 3, 1, .5f,
+        .5f, 1, 4, 1,
+        .25f, .5f, 1, 5
+    } * 1e-11f;
+    math::mat4f_group<4> tiny4;
+    math::mat4f_group<8> tiny8;
+    for (size_t lane = 0; lane < 8; lane++) {
+        tiny4.set(lane % 4, dense);
+        tiny8.set(lane, dense);
+    }
+    EXPECT_EQUAL(math::invert(tiny4, tiny4), 0u);
+    EXPECT_EQUAL(math::invert(tiny8, tiny8), 0u);
+    bool infinite = true;
+    for (size_t i = 0; i < 16; i++) {
+        infinite &= std::isinf(tiny4.get(3).container().at(i)) && std::isinf(tiny8.get(7).container().at(i));
+    }
+    EXPECT_TRUE(infinite);
+
+    // whole arrays
+    std::vector<math::mat4f_group<4>> inverse_groups(3);
+    unsigned masks[3];
+    lhs_groups[1].set(2, math::mat4f{});
+    EXPECT_EQUAL(math::invert(lhs_groups.data(), inverse_groups.data(), 3, masks), 1u);
+    EXPECT_TRUE(!masks[0] && masks[1] == 4u && !masks[2]);
+    EXPECT_EQUAL(inverse_groups[2].get(3), math::identity4f{});
+END_TEST()
@@ -0,0 +1,110 @@
+#include <deps/testing.h/testing.h>
+#include <common/matrix_ref.hpp>
+#include <cmath>
+
+using cmat4f = math::column_major_mat4f;
+using cmat4f_ref = math::matrix_ref<4, float, math::storage_order::column_major>;
+using vec3_ref = vector::vector_ref<float, 3>;
+using const_vec3_ref = vector::const_vector_ref<float, 3>;
+
+template <typename lhs_type, typename rhs_type>
+bool nearly_equal(const lhs_type& a, const rhs_type& b, const float epsilon = 1e-5f) {
+    for (size_t index = 0; index < 16; index++) {
+        if (std::fabs(a.raw()[index] - b.container().raw()[index]) > epsilon) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BEGIN_TEST()
+    const math::mat4f view = math::rotate_y(.3f) * math::translate(0, -2, 5);
+    const math::mat4f models[3] = {
+        math::translate(1, 2, 3),
+        math::rotate_x(.7f) * math::scale(2, 2, 2),
+        math::scale(1, .5f, 3) * math::rotate_z(-1.2f) * math::translate(-4, 0, 1)
+    };
+
+    // stream products straight into an upload buffer
+    float buffer[3 * 16] = {};
+    for (size_t i = 0; i < 3; i++) {
+        math::mat4f_ref(buffer + i * 16) = view * models[i];
+    }
+    for (size_t i = 0; i < 3; i++) {
+        EXPECT_EQUAL(math::const_mat4f_ref(buffer + i * 16).evaluate(), view * models[i]);
+    }
+
+    // views take part in product chains and vector products like matrices
+    const math::const_mat4f_ref first(buffer);
+    const math::const_mat4f_ref second(buffer + 16);
+    const math::mat4f first_product = view * models[0];
+    const math::mat4f second_product = view * models[1];
+    EXPECT_EQUAL(math::mat4f(first * second * models[2]), first_product * second_product * models[2]);
+    const vector::vec4 point({1, -2, 3, 1});
+    EXPECT_EQUAL(first * point, (view * models[0]) * point);
+    EXPECT_EQUAL(point * first, point * (view * models[0]).evaluate());
+    EXPECT_EQUAL(first.at(3, 2), buffer[14]);
+    EXPECT_TRUE(first.is_affine());
+
+    // in place on the viewed storage, the destination may be an operand
+    math::mat4f owned = models[1];
+    math::mat4f_ref target(owned);
+    target *= models[2];
+    EXPECT_EQUAL(owned, models[1] * models[2]);
+    target = target * target;
+    EXPECT_EQUAL(owned, (models[1] * models[2]).evaluate() * (models[1] * models[2]).evaluate());
+    target = models[1];
+    target.transpose();
+    EXPECT_EQUAL(owned, models[1].transpose());
+    target.transpose();
+    target.invert();
+    EXPECT_TRUE(nearly_equal(target, models[1].invert()));
+    target = models[2];
+    target.invert_affine();
+    EXPECT_TRUE(nearly_equal(target, models[2].invert_affine()));
+    target = models[1];
+    target.adjugate();
+    EXPECT_TRUE(nearly_equal(target, models[1].adjugate()));
+    target *= 2.f;
+    EXPECT_TRUE(nearly_equal(target, models[1].adjugate() * 2.f));
+
+    // copying a view rebinds nothing, assigning writes the elements
+    float other[16] = {};
+    math::mat4f_ref copy(other);
+    copy = target;
+    EXPECT_TRUE(nearly_equal(copy, models[1].adjugate() * 2.f));
+    copy.element(3, 0) = 7;
+    EXPECT_EQUAL(other[12], 7.f);
+    EXPECT_TRUE(owned.container().raw()[12] != 7.f);
+
+    // results into a separate destination
+    float result[16];
+    const math::const_mat4f_ref source(models[2]);
+    source.transpose(result);
+    EXPECT_EQUAL(math::const_mat4f_ref(result).evaluate(), models[2].transpose());
+    source.adjugate(result);
+    EXPECT_TRUE(nearly_equal(math::const_mat4f_ref(result), models[2].adjugate()));
+    math::const_mat4f_ref(view).invert_rigid(result);
+    EXPECT_TRUE(nearly_equal(math::const_mat4f_ref(result), view.invert_rigid()));
+    EXPECT_TRUE(std::fabs(source.determinant() - models[2].determinant()) < 1e-5f);
+
+    // column-major views
+    cmat4f column_owned;
+    cmat4f_ref column_target(column_owned);
+    column_target = cmat4f(view) * cmat4f(models[0]);
+    EXPECT_EQUAL(math::mat4f(column_owned), view * models[0]);
+    EXPECT_EQUAL(column_target.at(3, 0), (view * models[0]).evaluate().container().at({3, 0}));
+    EXPECT_EQUAL(column_target * point, (view * models[0]) * point);
+
+    // packed vec3 attributes
+    float positions[6] = {1, 2, 3, 4, 5, 6};
+    vec3_ref second_position(positions + 3);
+    EXPECT_EQUAL(const_vec3_ref(positions).load(), vector::vec3({1, 2, 3}));
+    second_position += vector::vec3({1, 1, 1});
+    EXPECT_EQUAL(positions[5], 7.f);
+    vector::vec4 transformed = point * math::const_mat4f_ref(models[0]);
+    second_position = vector::vec3({transformed.x(), transformed.y(), transformed.z()});
+    EXPECT_EQUAL(second_position, vector::vec3({2, 0, 6}));
+    second_position = vec3_ref(positions);
+    EXPECT_EQUAL(positions[3], 1.f);
+END_TEST()
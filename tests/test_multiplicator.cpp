@@ -0,0 +1,70 @@
+#include <deps/testing.h/testing.h>
+#include <common/matrix.hpp>
+#include <cmath>
+#include <limits>
+#include <random>
+
+// both paths accumulate in the same order, so they only differ when the compiler
+// contracts mul+add into FMA: allow a few ULPs of the summed terms magnitude
+template <typename container_type>
+bool nearly_equal(const container_type& a, const container_type& b, const container_type& magnitude, const size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        if (std::fabs(a.at(i) - b.at(i)) > 4 * std::numeric_limits<float>::epsilon() * magnitude.at(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename container_type>
+container_type absolute(container_type data, const size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        data[i] = std::fabs(data[i]);
+    }
+    return data;
+}
+
+BEGIN_TEST()
+    using generic = math::scalar_multiplicator<4, float>;
+    using specialized = math::multiplicator<4, float>;
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-100.f, 100.f);
+
+    bool matrices_match = true;
+    bool vectors_match = true;
+
+    for (size_t iteration = 0; iteration < 1000; iteration++) {
+        math::mat4f::container_type lhs, rhs;
+        vector::vec4 vec;
+        for (size_t i = 0; i < 16; i++) {
+            lhs[i] = distribution(generator);
+            rhs[i] = distribution(generator);
+        }
+        for (size_t i = 0; i < 4; i++) {
+            vec.m_data[i] = distribution(generator);
+        }
+
+        const auto matrix_magnitude = generic::compute(absolute(lhs, 16), absolute(rhs, 16));
+        matrices_match &= nearly_equal(generic::compute(lhs, rhs), specialized::compute(lhs, rhs), matrix_magnitude, 16);
+
+        const vector::vec4 vec_abs{absolute(vec.data(), 4)};
+        const auto vector_magnitude = generic::compute(absolute(lhs, 16), vec_abs).data();
+        vectors_match &= nearly_equal(generic::compute(lhs, vec).data(), specialized::compute(lhs, vec).data(), vector_magnitude, 4);
+    }
+    EXPECT_TRUE(matrices_match);
+    EXPECT_TRUE(vectors_match);
+
+    // transforms chain
+    math::mat4f chain = math::rotate_z(.5f) * math::rotate_x(.25f) * math::translate(1, 2, 3) * math::scale(2, 2, 2);
+    math::mat4f reference{generic::compute(generic::compute(generic::compute(
+        math::rotate_z(.5f).container(), math::rotate_x(.25f).container()),
+        math::translate(1, 2, 3).container()), math::scale(2, 2, 2).container())};
+    const math::mat4f::container_type chain_magnitude{
+        8, 8, 8, 8,
+        8, 8, 8, 8,
+        8, 8, 8, 8,
+        8, 8, 8, 8
+    };
+    EXPECT_TRUE(nearly_equal(chain.container(), reference.container(), chain_magnitude, 16));
+END_TEST()
@@ -0,0 +1,143 @@
+#include <deps/testing.h/testing.h>
+#include <common/packed_transform.hpp>
+#include <cmath>
+#include <vector>
+
+bool nearly_equal(const math::mat4f& a, const math::mat4f& b, const float epsilon) {
+    for (size_t index = 0; index < 16; index++) {
+        if (std::fabs(a.container().at(index) - b.container().at(index)) > epsilon) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BEGIN_TEST()
+    // every half survives the round trip, NaNs stay NaN
+    bool halves_match = true;
+    for (uint32_t bits = 0; bits < 0x10000; bits++) {
+        const float value = math::detail::half_to_float(uint16_t(bits));
+        halves_match &= std::isnan(value) ? (bits & 0x7c00) == 0x7c00 && (bits & 0x3ff)
+                                          : math::detail::float_to_half(value) == bits;
+    }
+    EXPECT_TRUE(halves_match);
+    EXPECT_EQUAL(math::detail::half_to_float(0x3c00), 1.f);
+    EXPECT_EQUAL(math::detail::float_to_half(-2.f), 0xc000);
+    EXPECT_EQUAL(math::detail::float_to_half(1e6f), 0x7c00);
+    EXPECT_EQUAL(math::detail::float_to_half(1 + 1.f / 4096), 0x3c00);
+    EXPECT_EQUAL(math::detail::float_to_half(1 + 3.f / 2048), 0x3c02);
+
+    // relative error bound of rounding to nearest
+    bool rounding_bounded = true;
+    for (float value = 1e-4f; value < 6e4f; value *= 1.0137f) {
+        for (const float signed_value : {value, -value}) {
+            const float half = math::detail::half_to_float(math::detail::float_to_half(signed_value));
+            rounding_bounded &= std::fabs(half - signed_value) <= std::fabs(signed_value) * (1.f / 2048) + 3e-8f;
+        }
+    }
+    EXPECT_TRUE(rounding_bounded);
+
+#if defined(MATH_SIMD_SSE)
+    // the SSE conversions agree with the scalar ones
+    bool lanes_match = true;
+    for (uint32_t bits = 0; bits < 0x10000; bits += 4) {
+        const __m128i halves = _mm_set_epi16(0, 0, 0, 0, short(bits + 3), short(bits + 2), short(bits + 1), short(bits));
+        float values[4];
+        _mm_storeu_ps(values, math::detail::half_to_float(halves));
+        uint16_t back[8];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(back), math::detail::float_to_half(_mm_loadu_ps(values)));
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            const float expected = math::detail::half_to_float(uint16_t(bits + lane));
+            if (!std::isnan(expected)) {
+                lanes_match &= values[lane] == expected && back[lane] == math::detail::float_to_half(expected);
+            }
+        }
+    }
+    EXPECT_TRUE(lanes_match);
+#endif
+
+    const math::quantization_range range{vector::vec3({-100, -10, -100}), vector::vec3({200, 20, 200})};
+    std::vector<vector::vec3> translations, scales;
+    std::vector<math::quat> rotations;
+    std::vector<math::mat4f> matrices;
+    for (size_t i = 0; i < 11; i++) {
+        const float angle = i * .61f;
+        translations.push_back(vector::vec3({i * 17.3f - 90, std::sin(angle) * 9, 80 - i * 11.1f}));
+        rotations.push_back(math::quat::from_axis_angle({vector::normalize(vector::vec3({1, float(i) - 5, 2})), angle * 2 - 3}));
+        scales.push_back(vector::vec3({1 + i * .1f, .5f, 2 - i * .05f}));
+        float r[9];
+        rotations.back().rotation(r);
+        math::mat4f::container_type data;
+        math::detail::compose(r, translations.back(), scales.back(), data.raw());
+        matrices.push_back(math::mat4f{data});
+    }
+
+    // rotation matrices back to quaternions
+    bool rotations_match = true;
+    for (const math::quat& rotation : rotations) {
+        float r[9];
+        rotation.rotation(r);
+        const math::quat back = math::quat::from_rotation(r);
+        const float sign = back.dot(rotation) < 0 ? -1.f : 1.f;
+        for (size_t component = 0; component < 4; component++) {
+            rotations_match &= std::fabs(back.data()[component] * sign - rotation.data()[component]) < 1e-5f;
+        }
+    }
+    EXPECT_TRUE(rotations_match);
+
+    // 3x4 affine: exact
+    std::vector<math::packed_affine> affine(matrices.size());
+    std::vector<math::mat4f> unpacked(matrices.size());
+    math::pack(matrices.data(), affine.data(), matrices.size());
+    math::unpack(affine.data(), unpacked.data(), matrices.size());
+    bool affine_exact = true;
+    for (size_t i = 0; i < matrices.size(); i++) {
+        affine_exact &= unpacked[i] == matrices[i] && math::packed_affine{matrices[i]}.unpack() == matrices[i];
+        affine_exact &= affine[i].data() == math::packed_affine{matrices[i]}.data();
+    }
+    EXPECT_TRUE(affine_exact);
+    EXPECT_EQUAL(affine[3].data()[3], matrices[3].container().at({3, 0}));
+
+    // half 3x4: relative error per element
+    std::vector<math::packed_half_affine> half(matrices.size());
+    math::pack(matrices.data(), half.data(), matrices.size());
+    math::unpack(half.data(), unpacked.data(), matrices.size());
+    bool half_bounded = true;
+    for (size_t i = 0; i < matrices.size(); i++) {
+        half_bounded &= half[i].data() == math::packed_half_affine{matrices[i]}.data();
+        for (size_t index = 0; index < 16; index++) {
+            const float expected = matrices[i].container().at(index);
+            half_bounded &= std::fabs(unpacked[i].container().at(index) - expected) <= std::fabs(expected) / 2048 + 1e-7f;
+        }
+    }
+    EXPECT_TRUE(half_bounded);
+
+    // quantized rotation, translation and scale
+    std::vector<math::packed_trs> trs(matrices.size());
+    math::pack(translations.data(), rotations.data(), scales.data(), trs.data(), matrices.size(), range);
+    math::unpack(trs.data(), unpacked.data(), matrices.size(), range);
+    bool trs_bounded = true;
+    for (size_t i = 0; i < matrices.size(); i++) {
+        const math::packed_trs single{translations[i], rotations[i], scales[i], range};
+        const math::quat rotation = single.rotation();
+        // q and -q are the same rotation
+        const float sign = rotation.dot(rotations[i]) < 0 ? -1.f : 1.f;
+        for (size_t component = 0; component < 4; component++) {
+            trs_bounded &= std::fabs(rotation.data()[component] * sign - rotations[i].data()[component]) < 1.5e-3f;
+        }
+        for (size_t axis = 0; axis < 3; axis++) {
+            trs_bounded &= std::fabs(single.translation(range)[axis] - translations[i][axis]) <= range.extent[axis] / 65535 * .5f + 1e-5f;
+            trs_bounded &= std::fabs(single.scale()[axis] - scales[i][axis]) <= scales[i][axis] / 2048;
+        }
+        trs_bounded &= nearly_equal(unpacked[i], matrices[i], 5e-3f);
+        trs_bounded &= nearly_equal(unpacked[i], single.unpack(range), 1e-5f);
+        trs_bounded &= nearly_equal(math::packed_trs{matrices[i], range}.unpack(range), matrices[i], 5e-3f);
+    }
+    EXPECT_TRUE(trs_bounded);
+
+    // translations outside the range clamp to it
+    const math::packed_trs outside{vector::vec3({500, -500, 0}), math::quat{}, vector::vec3({1, 1, 1}), range};
+    EXPECT_EQUAL(outside.translation(range)[0], 100.f);
+    EXPECT_EQUAL(outside.translation(range)[1], -10.f);
+    EXPECT_TRUE(nearly_equal(outside.unpack(range), math::translate(100, -10, 0), 5e-3f));
+END_TEST()
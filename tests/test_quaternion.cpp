@@ -0,0 +1,85 @@
+#include <deps/testing.h/testing.h>
+#include <common/quaternion.hpp>
+#include <cmath>
+#include <vector>
+
+bool nearly_equal(const math::mat4f& a, const math::mat4f& b, const float epsilon = 1e-5f) {
+    for (size_t i = 0; i < 16; i++) {
+        if (std::fabs(a.container().at(i) - b.container().at(i)) > epsilon) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool nearly_equal(const math::quat& a, const math::quat& b, const float epsilon = 1e-5f) {
+    for (size_t i = 0; i < 4; i++) {
+        if (std::fabs(a.data()[i] - b.data()[i]) > epsilon) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BEGIN_TEST()
+    const vector::vec3 x_axis({1, 0, 0});
+    const vector::vec3 y_axis({0, 1, 0});
+    const vector::vec3 z_axis({0, 0, 1});
+
+    // conversion matches the rotation matrices
+    const math::quat qx = math::quat::from_axis_angle({x_axis, .3f});
+    const math::quat qy = math::quat::from_axis_angle({y_axis, -.8f});
+    const math::quat qz = math::quat::from_axis_angle({z_axis, 1.2f});
+    EXPECT_TRUE(nearly_equal(qx.to_mat4(), math::rotate_x(.3f)));
+    EXPECT_TRUE(nearly_equal(qy.to_mat4(), math::rotate_y(-.8f)));
+    EXPECT_TRUE(nearly_equal(qz.to_mat4(), math::rotate_z(1.2f)));
+    EXPECT_EQUAL(math::quat{}.to_mat4(), math::identity4f{});
+    EXPECT_EQUAL(qx.to_mat3(), qx.to_mat4().submatrix(3, 3));
+
+    // products compose in reverse matrix order
+    const math::quat composed = qz * qy * qx;
+    const math::mat4f composed_matrix = math::rotate_x(.3f) * math::rotate_y(-.8f) * math::rotate_z(1.2f);
+    EXPECT_TRUE(nearly_equal(composed.to_mat4(), composed_matrix));
+    EXPECT_TRUE(nearly_equal(composed * composed.conjugate(), math::quat{}));
+    EXPECT_TRUE(std::fabs(math::quat(1, 2, 3, 4).normalize().length() - 1) < 1e-6f);
+
+    // interpolation
+    const math::quat from = math::quat::from_axis_angle({z_axis, .2f});
+    const math::quat to = math::quat::from_axis_angle({z_axis, 1.4f});
+    const math::quat middle = math::quat::from_axis_angle({z_axis, .8f});
+    EXPECT_TRUE(nearly_equal(math::slerp(from, to, 0), from));
+    EXPECT_TRUE(nearly_equal(math::slerp(from, to, 1), to));
+    EXPECT_TRUE(nearly_equal(math::slerp(from, to, .5f), middle));
+    EXPECT_TRUE(nearly_equal(math::slerp(from, to, .25f), math::quat::from_axis_angle({z_axis, .5f})));
+    EXPECT_TRUE(nearly_equal(math::nlerp(from, to, .5f), middle));
+    // shorter arc: -to is the same rotation
+    const math::quat negated{-to.x(), -to.y(), -to.z(), -to.w()};
+    EXPECT_TRUE(nearly_equal(math::slerp(from, negated, .5f), middle));
+
+    // batches agree with the scalar versions, including the non-multiple-of-4 tail
+    const size_t count = 103;
+    std::vector<math::quat> sources, targets, nlerped(count), slerped(count);
+    std::vector<float> weights;
+    for (size_t i = 0; i < count; i++) {
+        const float angle = i * .05f;
+        const vector::vec3 axis({std::sin(angle), std::cos(angle), 0});
+        sources.push_back(math::quat::from_axis_angle({axis, angle}));
+        // every seventh pair is (nearly) parallel, every fifth needs a sign flip
+        const float target_angle = i % 7 ? angle * 1.7f + 1 : angle + 1e-4f;
+        math::quat target = math::quat::from_axis_angle({axis, target_angle});
+        if (i % 5 == 0) {
+            target = math::quat{-target.x(), -target.y(), -target.z(), -target.w()};
+        }
+        targets.push_back(target);
+        weights.push_back((i % 11) / 10.f);
+    }
+    math::nlerp(sources.data(), targets.data(), weights.data(), nlerped.data(), count);
+    math::slerp(sources.data(), targets.data(), weights.data(), slerped.data(), count);
+
+    bool batches_match = true;
+    for (size_t i = 0; i < count; i++) {
+        batches_match &= nearly_equal(nlerped[i], math::nlerp(sources[i], targets[i], weights[i]));
+        batches_match &= nearly_equal(slerped[i], math::slerp(sources[i], targets[i], weights[i]));
+    }
+    EXPECT_TRUE(batches_match);
+END_TEST()
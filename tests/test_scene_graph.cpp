@@ -0,0 +1,125 @@
+#include <deps/testing.h/testing.h>
+#include <common/scene_graph.hpp>
+#include <common/transform.hpp>
+#include <cmath>
+#include <vector>
+
+using graph = math::scene_graph;
+
+math::mat4f local_transform(const size_t seed) {
+    return math::trs(vector::vec3({float(seed % 7), float(seed % 3) - 1, .5f}),
+                     vector::vec3({seed * .1f, seed * .2f, seed * .3f}),
+                     vector::vec3({1, 1 + seed % 2 * .5f, 1}));
+}
+
+// world transform by walking up the hierarchy
+math::mat4f expected_world(const graph& scene, graph::node_id node) {
+    math::mat4f result = scene.local(node);
+    while ((node = scene.parent(node)) != graph::none) {
+        result = result * scene.local(node);
+    }
+    return result;
+}
+
+bool nearly_equal(const math::mat4f& a, const math::mat4f& b) {
+    for (size_t index = 0; index < 16; index++) {
+        if (std::fabs(a.container().at(index) - b.container().at(index)) > 1e-4f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool worlds_match(const graph& scene, const std::vector<graph::node_id>& nodes) {
+    bool result = true;
+    for (const graph::node_id node : nodes) {
+        result &= !scene.contains(node) || nearly_equal(scene.world(node), expected_world(scene, node));
+    }
+    return result;
+}
+
+BEGIN_TEST()
+    graph scene;
+    const graph::node_id root = scene.add(math::translate(10, 0, 0));
+    const graph::node_id arm = scene.add(math::rotate_z(.5f), root);
+    const graph::node_id hand = scene.add(math::translate(0, 2, 0), arm);
+    EXPECT_EQUAL(scene.update(), 3u);
+    EXPECT_EQUAL(scene.world(hand), math::mat4f(math::translate(0, 2, 0) * math::rotate_z(.5f) * math::translate(10, 0, 0)));
+    EXPECT_EQUAL(scene.parent(hand), arm);
+    EXPECT_EQUAL(scene.parent(root), graph::none);
+
+    // nothing changed, nothing recomputed
+    EXPECT_EQUAL(scene.update(), 0u);
+    EXPECT_TRUE(scene.changed().empty());
+
+    // a changed node recomputes its subtree only
+    const graph::node_id other = scene.add(math::scale(2, 2, 2), root);
+    scene.update();
+    scene.set_local(arm, math::rotate_z(1));
+    EXPECT_EQUAL(scene.update(), 2u);
+    std::vector<graph::node_id> changed;
+    for (const graph::changed_transform transform : scene.changed()) {
+        changed.push_back(transform.node);
+        EXPECT_EQUAL(transform.world, scene.world(transform.node));
+    }
+    EXPECT_EQUAL(changed.size(), 2u);
+    EXPECT_EQUAL(changed[0], arm);
+    EXPECT_EQUAL(changed[1], hand);
+    EXPECT_TRUE(worlds_match(scene, {root, arm, hand, other}));
+
+    scene.set_local(root, math::translate(0, 0, 1));
+    EXPECT_EQUAL(scene.update(), 4u);
+    EXPECT_TRUE(worlds_match(scene, {root, arm, hand, other}));
+
+    // removal takes the subtree along and recycles ids
+    scene.remove(arm);
+    EXPECT_EQUAL(scene.update(), 0u);
+    EXPECT_EQUAL(scene.size(), 2u);
+    EXPECT_TRUE(!scene.contains(arm) && !scene.contains(hand) && scene.contains(other));
+    const graph::node_id recycled = scene.add(math::translate(1, 1, 1), other);
+    EXPECT_TRUE(recycled == arm || recycled == hand);
+    EXPECT_EQUAL(scene.update(), 1u);
+    EXPECT_TRUE(worlds_match(scene, {root, other, recycled}));
+    EXPECT_EXCEPTION(scene.add(math::mat4f::make_identity(), 1000), math::matrix_error);
+    EXPECT_EXCEPTION(scene.remove(1000), math::matrix_error);
+    const graph::node_id stale = recycled == arm ? hand : arm;
+    EXPECT_EXCEPTION(scene.set_local(stale, math::mat4f::make_identity()), math::matrix_error);
+    EXPECT_EXCEPTION(scene.set_local(1000, math::mat4f::make_identity()), math::matrix_error);
+
+    // larger random hierarchy built out of depth order, mostly static
+    graph forest;
+    std::vector<graph::node_id> nodes;
+    for (size_t i = 0; i < 2000; i++) {
+        const graph::node_id parent = i < 10 ? graph::none : nodes[(i * 7919) % i];
+        nodes.push_back(forest.add(local_transform(i), parent));
+    }
+    EXPECT_EQUAL(forest.update(), 2000u);
+    EXPECT_TRUE(worlds_match(forest, nodes));
+
+    // slots are grouped by depth and parents precede children
+    const std::vector<size_t>& levels = forest.levels();
+    EXPECT_EQUAL(levels.front(), 0u);
+    EXPECT_EQUAL(levels.back(), 2000u);
+    bool ordered = true;
+    for (size_t depth = 0; depth + 1 < levels.size(); depth++) {
+        for (size_t slot = levels[depth]; slot < levels[depth + 1]; slot++) {
+            const graph::node_id node = forest.node_at(slot);
+            ordered &= depth ? forest.parent(node) != graph::none && forest.world(node) == forest.world_transforms()[slot]
+                             : forest.parent(node) == graph::none;
+        }
+    }
+    EXPECT_TRUE(ordered);
+
+    size_t recomputed = 0;
+    for (size_t frame = 0; frame < 10; frame++) {
+        for (size_t i = frame; i < nodes.size(); i += 100) {
+            forest.set_local(nodes[i], local_transform(i + frame));
+        }
+        recomputed += forest.update();
+        if (frame == 5) {
+            forest.remove(nodes[500]);
+        }
+    }
+    EXPECT_TRUE(recomputed < 10 * 2000 / 4);
+    EXPECT_TRUE(worlds_match(forest, nodes));
+END_TEST()
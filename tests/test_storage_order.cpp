@@ -0,0 +1,105 @@
+#include <deps/testing.h/testing.h>
+#include <common/matrix.hpp>
+#include <cmath>
+
+using cmat2f = math::column_major_matrix<2, float>;
+using cmat4f = math::column_major_mat4f;
+using cmat5d = math::column_major_matrix<5, double>;
+using mat5d = math::matrix<5, double>;
+
+// same elements, transposed storage
+constexpr cmat2f constant_cm2 = {
+    1, 2,
+    3, 4
+};
+static_assert(constant_cm2.container().raw()[1] == 3, "column-major storage");
+static_assert(constant_cm2 * constant_cm2 == cmat2f{7, 10, 15, 22}, "constexpr column-major product");
+static_assert(constant_cm2 * vector::vec2({1, 1}) == vector::vec2({3, 7}), "constexpr column-major vector product");
+
+template <size_t dimensions, typename value_type, math::storage_order order>
+bool nearly_equal(const math::matrix<dimensions, value_type, order>& a, const math::matrix<dimensions, value_type>& b, const double epsilon = 1e-5) {
+    for (size_t row = 0; row < dimensions; row++) {
+        for (size_t col = 0; col < dimensions; col++) {
+            if (std::fabs(a.container().at({row, col}) - b.container().at({row, col})) > epsilon) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+BEGIN_TEST()
+    const math::mat4f a = math::rotate_z(.4f) * math::translate(1, 2, 3) * math::scale(2, 1, .5f);
+    const math::mat4f b = {
+        2, 0, 1, 0,
+        0, 3, 0, 1,
+        1, 0, 4, 0,
+        5, 1, 0, 2
+    };
+    const math::mat4f c = math::rotate_x(-1.1f) * math::translate(-4, 0, 1);
+    const cmat4f ca(a), cb(b), cc(c);
+
+    // indexing sees the same elements, storage differs
+    EXPECT_EQUAL(ca.container().at({3, 0}), a.container().at({3, 0}));
+    EXPECT_EQUAL(ca.container().raw()[3], a.container().raw()[12]);
+    EXPECT_EQUAL(math::mat4f(ca), a);
+
+    // products, including fused chains
+    EXPECT_EQUAL(math::mat4f(cmat4f(ca * cb)), a * b);
+    // chains associate the other way around in column-major storage
+    EXPECT_TRUE(nearly_equal(cmat4f(ca * cb * cc), (a * b * c).evaluate()));
+    EXPECT_TRUE(nearly_equal(cmat4f(cc * (ca * cb)), (c * (a * b)).evaluate()));
+    const vector::vec4 v({1, -2, 3, 1});
+    EXPECT_EQUAL(ca * v, a * v);
+    EXPECT_EQUAL(v * ca, v * a);
+    EXPECT_EQUAL(math::mat4f(ca * 3.f), a * 3.f);
+
+    // derived quantities
+    EXPECT_EQUAL(math::mat4f(ca.transpose()), a.transpose());
+    EXPECT_EQUAL(math::mat3f(ca.submatrix(1, 2)), a.submatrix(1, 2));
+    EXPECT_TRUE(std::fabs(cb.determinant() - b.determinant()) < 1e-4f);
+    EXPECT_TRUE(nearly_equal(cb.invert(), b.invert()));
+    EXPECT_TRUE(nearly_equal(cb.adjugate(), b.adjugate(), 1e-4));
+    // affine shortcuts follow the convention of the order: column-major
+    // transforms keep their translation in the last column
+    const cmat4f column_a(a.transpose());
+    const cmat4f column_c(c.transpose());
+    EXPECT_TRUE(column_a.is_affine() && !ca.is_affine() && !cb.is_affine());
+    EXPECT_TRUE(nearly_equal(column_a.invert_affine(), a.invert_affine().transpose()));
+    EXPECT_TRUE(nearly_equal(column_c.invert_rigid(), c.invert_rigid().transpose()));
+    EXPECT_TRUE(nearly_equal(cb.invert_affine(), b.invert()));
+    const vector::vec4 solution = cb.solve(v);
+    const vector::vec4 expected = b.solve(v);
+    for (size_t i = 0; i < 4; i++) {
+        EXPECT_TRUE(std::fabs(solution[i] - expected[i]) < 1e-5f);
+    }
+
+    // generic sizes go through LU
+    const mat5d m5 = {
+        2, 1, 0, 0, 3,
+        1, 4, 1, 0, 0,
+        0, 1, 5, 2, 0,
+        0, 0, 2, 6, 1,
+        1, 0, 0, 1, 7
+    };
+    const cmat5d cm5(m5);
+    EXPECT_TRUE(std::fabs(cm5.determinant() - m5.determinant()) < 1e-9);
+    EXPECT_TRUE(nearly_equal(cm5.invert(), m5.invert(), 1e-12));
+    EXPECT_EQUAL(mat5d(cmat5d(cm5 * cm5)), m5 * m5);
+
+    // a column vector convention transform in column-major storage has the
+    // storage of the row vector convention one: both upload without transposing
+    const cmat4f column_translation = {
+        1, 0, 0, 1,
+        0, 1, 0, 2,
+        0, 0, 1, 3,
+        0, 0, 0, 1
+    };
+    const math::mat4f row_translation = math::translate(1, 2, 3);
+    bool same_storage = true;
+    for (size_t i = 0; i < 16; i++) {
+        same_storage &= column_translation.container().raw()[i] == row_translation.container().raw()[i];
+    }
+    EXPECT_TRUE(same_storage);
+    EXPECT_EQUAL(column_translation * vector::vec4({0, 0, 0, 1}), vector::vec4({1, 2, 3, 1}));
+END_TEST()
@@ -0,0 +1,70 @@
+#include <deps/testing.h/testing.h>
+#include <common/transform.hpp>
+#include <cmath>
+
+bool nearly_equal(const math::mat4f& a, const math::mat4f& b, const float epsilon = 1e-5f) {
+    for (size_t i = 0; i < 16; i++) {
+        if (std::fabs(a.container().at(i) - b.container().at(i)) > epsilon) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool nearly_equal(const vector::vec3& a, const vector::vec3& b, const float epsilon = 1e-5f) {
+    for (size_t i = 0; i < 3; i++) {
+        if (std::fabs(a.data()[i] - b.data()[i]) > epsilon) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BEGIN_TEST()
+    const vector::vec3 translation({1, -2, 3});
+    const vector::vec3 euler({.3f, -.7f, 1.1f});
+    const vector::vec3 scale({2, .5f, 3});
+
+    // euler angles
+    const math::mat4f composed = math::scale(scale) * math::rotate_x(.3f) * math::rotate_y(-.7f)
+                               * math::rotate_z(1.1f) * math::translate(translation);
+    EXPECT_TRUE(nearly_equal(math::trs(translation, euler, scale), composed));
+
+    // axis-angle around the coordinate axes matches rotate_*
+    const vector::vec3 zero({0, 0, 0});
+    const vector::vec3 unit({1, 1, 1});
+    const math::mat4f around_x = math::trs(zero, math::axis_angle{vector::vec3({1, 0, 0}), .4f}, unit);
+    const math::mat4f around_y = math::trs(zero, math::axis_angle{vector::vec3({0, 1, 0}), .4f}, unit);
+    const math::mat4f around_z = math::trs(zero, math::axis_angle{vector::vec3({0, 0, 1}), .4f}, unit);
+    EXPECT_TRUE(nearly_equal(around_x, math::rotate_x(.4f)));
+    EXPECT_TRUE(nearly_equal(around_y, math::rotate_y(.4f)));
+    EXPECT_TRUE(nearly_equal(around_z, math::rotate_z(.4f)));
+
+    // decomposition round trip
+    auto components = math::decompose(composed);
+    EXPECT_TRUE(nearly_equal(components.translation(), translation));
+    EXPECT_TRUE(nearly_equal(components.rotation(), euler));
+    EXPECT_TRUE(nearly_equal(components.scale(), scale));
+    EXPECT_TRUE(nearly_equal(components.matrix(), composed));
+
+    const vector::vec3 mirrored_scale({-2, .5f, 3});
+    const math::mat4f mirrored = math::trs(translation, euler, mirrored_scale);
+    EXPECT_TRUE(nearly_equal(math::decompose(mirrored).matrix(), mirrored));
+
+    // gimbal lock
+    const vector::vec3 locked({.4f, 1.5707964f, 0});
+    const math::mat4f gimbal = math::trs(translation, locked, scale);
+    EXPECT_TRUE(nearly_equal(math::decompose(gimbal).matrix(), gimbal, 1e-4f));
+
+    // incremental updates match a full rebuild
+    const vector::vec3 moved({5, 6, 7});
+    components.set_translation(moved);
+    EXPECT_TRUE(nearly_equal(components.matrix(), math::trs(moved, euler, scale)));
+
+    const vector::vec3 turned({.3f, .2f, 1.1f});
+    components.set_rotation(turned);
+    EXPECT_TRUE(nearly_equal(components.matrix(), math::trs(moved, turned, scale)));
+
+    components.set_scale(unit);
+    EXPECT_TRUE(nearly_equal(components.matrix(), math::trs(moved, turned, unit)));
+END_TEST()
@@ -0,0 +1,115 @@
+#include <deps/testing.h/testing.h>
+#include <common/vector.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using vector::vec2;
+using vector::vec3;
+using vector::vec4;
+
+static_assert(sizeof(vec3) == 16 && alignof(vec3) == 16, "padded vec3");
+static_assert(sizeof(vec4) == 16 && alignof(vec4) == 16, "aligned vec4");
+static_assert(vec3::dimensions == 3 && vec3::storage_size == 4, "vec3 storage");
+static_assert(vec2({1, 2}) + vec2({3, 4}) == vec2({4, 6}), "constexpr sum");
+static_assert(vector::dot(vec3({1, 2, 3}), vec3({4, 5, 6})) == 32, "constexpr dot");
+static_assert(vector::cross(vec3({1, 0, 0}), vec3({0, 1, 0})) == vec3({0, 0, 1}), "constexpr cross");
+
+template <typename vector_type>
+bool nearly_equal(const vector_type& a, const vector_type& b, const float epsilon = 1e-5f) {
+    for (size_t i = 0; i < vector_type::dimensions; i++) {
+        if (std::fabs(a[i] - b[i]) > epsilon) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename vector_type>
+std::vector<vector_type> random_vectors(std::mt19937& generator, const size_t count) {
+    std::uniform_real_distribution<float> distribution(-10.f, 10.f);
+    std::vector<vector_type> result(count);
+    for (auto& value : result) {
+        for (size_t i = 0; i < vector_type::dimensions; i++) {
+            value[i] = distribution(generator);
+        }
+    }
+    return result;
+}
+
+BEGIN_TEST()
+    const vec3 a({1, 2, 3});
+    const vec3 b({-4, 5, .5f});
+
+    // element-wise arithmetic, the padding lane stays zero
+    EXPECT_EQUAL(a + b, vec3({-3, 7, 3.5f}));
+    EXPECT_EQUAL(a - b, vec3({5, -3, 2.5f}));
+    EXPECT_EQUAL(-a, vec3({-1, -2, -3}));
+    EXPECT_EQUAL(a * b, vec3({-4, 10, 1.5f}));
+    EXPECT_EQUAL(a * 2.f, vec3({2, 4, 6}));
+    EXPECT_EQUAL(2.f * a, vec3({2, 4, 6}));
+    EXPECT_EQUAL(a / 2.f, vec3({.5f, 1, 1.5f}));
+    EXPECT_EQUAL((a * 2.f).data()[3], 0.f);
+    vec3 accumulated = a;
+    accumulated += b;
+    accumulated *= 2.f;
+    accumulated -= a;
+    EXPECT_EQUAL(accumulated, vec3({-7, 12, 4}));
+    EXPECT_EQUAL(vector::min(a, b), vec3({-4, 2, .5f}));
+    EXPECT_EQUAL(vector::max(a, b), vec3({1, 5, 3}));
+    EXPECT_EQUAL(vector::lerp(a, b, .5f), vec3({-1.5f, 3.5f, 1.75f}));
+
+    // products and lengths
+    EXPECT_EQUAL(vector::dot(a, b), 7.5f);
+    EXPECT_EQUAL(vector::dot(vec4({1, 2, 3, 4}), vec4({5, 6, 7, 8})), 70.f);
+    EXPECT_EQUAL(vector::cross(a, b), vec3({-14, -12.5f, 13}));
+    EXPECT_EQUAL(vector::dot(vector::cross(a, b), a), 0.f);
+    EXPECT_EQUAL(vector::length(vec3({3, 4, 12})), 13.f);
+    EXPECT_EQUAL(vector::length_squared(vec2({3, 4})), 25.f);
+    EXPECT_EQUAL(vector::distance(vec4({1, 1, 1, 1}), vec4({2, 2, 2, 2})), 2.f);
+    EXPECT_EQUAL(vector::normalize(vec3({0, 3, 4})), vec3({0, .6f, .8f}));
+    EXPECT_EQUAL(vector::normalize(vec3{}), vec3{});
+
+    // span functions agree with the single vector versions, including the tail
+    std::mt19937 generator(7);
+    const size_t count = 103;
+    const std::vector<vec3> lhs = random_vectors<vec3>(generator, count);
+    const std::vector<vec3> rhs = random_vectors<vec3>(generator, count);
+    const std::vector<vec4> wide = random_vectors<vec4>(generator, count);
+
+    std::vector<float> dots(count);
+    vector::dot(lhs.data(), rhs.data(), dots.data(), count);
+    std::vector<float> lengths(count);
+    vector::length(wide.data(), lengths.data(), count);
+    std::vector<vec3> normalized(count);
+    vector::normalize(lhs.data(), normalized.data(), count);
+    std::vector<vec3> sums(count);
+    vector::add(lhs.data(), rhs.data(), sums.data(), count);
+
+    bool spans_match = true;
+    for (size_t i = 0; i < count; i++) {
+        spans_match &= std::fabs(dots[i] - vector::dot(lhs[i], rhs[i])) <= 1e-4f;
+        spans_match &= std::fabs(lengths[i] - vector::length(wide[i])) <= 1e-5f;
+        spans_match &= nearly_equal(normalized[i], vector::normalize(lhs[i]));
+        spans_match &= sums[i] == lhs[i] + rhs[i];
+    }
+    EXPECT_TRUE(spans_match);
+
+    // zero vectors pass through the batched normalize unchanged
+    std::vector<vec4> zeros(5);
+    vector::normalize(zeros.data(), zeros.data(), zeros.size());
+    EXPECT_EQUAL(zeros[0], vec4{});
+    EXPECT_EQUAL(zeros[4], vec4{});
+
+    std::vector<vec3> moved = lhs;
+    vector::multiply_add(rhs.data(), .5f, moved.data(), count);
+    EXPECT_TRUE(nearly_equal(moved[50], lhs[50] + rhs[50] * .5f));
+
+    vec3 lower, upper;
+    vector::bounds(lhs.data(), count, lower, upper);
+    bool inside = true;
+    for (const auto& point : lhs) {
+        inside &= vector::min(lower, point) == lower && vector::max(upper, point) == upper;
+    }
+    EXPECT_TRUE(inside);
+END_TEST()
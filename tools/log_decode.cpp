@@ -0,0 +1,30 @@
+#include <common/log_format.hpp>
+#include <fstream>
+#include <iostream>
+
+// renders a binary log written with logger::output_format::binary as text, to
+// the given file or to stdout
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: log_decode <binary log> [text log]\n";
+        return 2;
+    }
+    std::ifstream in(argv[1], std::ios::in | std::ios::binary);
+    if (!in) {
+        std::cerr << "could not open '" << argv[1] << "'\n";
+        return 1;
+    }
+    std::ofstream file;
+    if (argc == 3) {
+        file.open(argv[2]);
+        if (!file) {
+            std::cerr << "could not open '" << argv[2] << "'\n";
+            return 1;
+        }
+    }
+    if (!common::binary_log::decode(in, argc == 3 ? file : std::cout)) {
+        std::cerr << "'" << argv[1] << "' is not a binary log or is cut short\n";
+        return 1;
+    }
+    return 0;
+}